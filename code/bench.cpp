@@ -0,0 +1,1272 @@
+/* Micro benchmarks of the platform side code, run with: linux_main --bench <name>
+ * NOTE: Included by linux_main.cpp after the queue and the software renderer, headless only
+ */
+
+struct BenchRandom {
+	u32 state;
+};
+
+inline
+u32 BenchNextRandom(BenchRandom& random) {
+	// NOTE: xorshift32, reproducible across runs and platforms
+	u32 x = random.state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	random.state = x;
+	return x;
+}
+
+inline
+f32 BenchRandomUnilateral(BenchRandom& random) {
+	return f4(BenchNextRandom(random) >> 8) / f4(1 << 24);
+}
+
+internal
+void* BenchPushRenderEntry(RenderCommandBuffer* commands, RenderCallType type, u32 size, f32 sortKey) {
+	// NOTE: Same layout as PushRenderEntry_() on the engine side
+	size += sizeof(RenderCallHeader);
+	Assert(commands->pushBufferSize + size <= commands->sortBufferAt - sizeof(SortElement));
+	commands->sortBufferAt -= sizeof(SortElement);
+	SortElement* sortElement = ptrcast(SortElement, commands->pushBuffer + commands->sortBufferAt);
+	sortElement->key = (u64(RenderSortLayer_World) << RENDER_SORT_LAYER_SHIFT) |
+		(u64(GetRenderSortDepthBand(sortKey)) << RENDER_SORT_DEPTH_SHIFT) | u64(type);
+	sortElement->offset = commands->pushBufferSize;
+
+	RenderCallHeader* header = ptrcast(RenderCallHeader, commands->pushBuffer + commands->pushBufferSize);
+	header->type = type;
+	commands->pushBufferSize += size;
+	commands->pushBufferCount++;
+	return header + 1;
+}
+
+internal
+LoadedBitmap BenchMakeBitmap(u32 width, u32 height) {
+	LoadedBitmap result = {};
+	result.width = width;
+	result.height = height;
+	result.pitch = AlignUp8(width) * BITMAP_BYTES_PER_PIXEL;
+	result.widthOverHeight = f4(width) / f4(height);
+	result.align = V2{ 0.5f, 0.5f };
+	result.data = ptrcast(u32, LinuxAllocateMemory(u64(result.pitch) * height));
+	return result;
+}
+
+internal
+void BenchTiledRenderer(PlatformQueue* queue) {
+	constexpr u32 iterationCount = 10;
+	u32 bitmapCounts[] = { 10000, 50000, 100000 };
+	LoadedBitmap dstBuffer = BenchMakeBitmap(globalLinuxState.displayWidth, globalLinuxState.displayHeight);
+	LoadedBitmap texture = BenchMakeBitmap(32, 32);
+	for (u32 pixelIndex = 0; pixelIndex < u4(texture.width * texture.height); pixelIndex++) {
+		// NOTE: Premultiplied, half transparent so every bitmap goes through blending
+		texture.data[pixelIndex] = 0x80402010;
+	}
+
+	RenderCommandBuffer commands = {};
+	commands.maxPushBufferSize = MB(16);
+	commands.pushBuffer = ptrcast(u8, LinuxAllocateMemory(u64(commands.maxPushBufferSize)));
+	u32 maxCommandCount = bitmapCounts[ArrayCount(bitmapCounts) - 1] + 1;
+	commands.sortBufferCount = maxCommandCount;
+	commands.sortTempBuffer = ptrcast(SortElement, LinuxAllocateMemory(u64(sizeof(SortElement) * maxCommandCount)));
+
+	printf("tiled renderer, %ux%u, %u threads, %u iterations\n", dstBuffer.width, dstBuffer.height, QueueThreadCount(queue), iterationCount);
+	for (u32 countIndex = 0; countIndex < ArrayCount(bitmapCounts); countIndex++) {
+		u32 bitmapCount = bitmapCounts[countIndex];
+		BenchRandom random = { 0x12345678 };
+		ResetRenderCommands(&commands);
+		RenderCallClear* clear = ptrcast(RenderCallClear,
+			BenchPushRenderEntry(&commands, RenderCallType_RenderCallClear, sizeof(RenderCallClear), -999999.f));
+		clear->color = V4{ 0.f, 0.f, 0.f, 1.f };
+		for (u32 bitmapIndex = 0; bitmapIndex < bitmapCount; bitmapIndex++) {
+			RenderCallBitmap* call = ptrcast(RenderCallBitmap,
+				BenchPushRenderEntry(&commands, RenderCallType_RenderCallBitmap, sizeof(RenderCallBitmap), BenchRandomUnilateral(random)));
+			f32 size = 8.f + 40.f * BenchRandomUnilateral(random);
+			call->bitmap = &texture;
+			call->center = V2{ BenchRandomUnilateral(random) * dstBuffer.width, BenchRandomUnilateral(random) * dstBuffer.height };
+			call->offset = V2{ 0.f, 0.f };
+			call->size = V2{ size, size };
+			call->color = V4{ 1.f, 1.f, 1.f, 1.f };
+		}
+		SortRenderCommands(&commands);
+
+		f32 milliseconds[2] = {};
+		u64 checksums[2] = {};
+		for (u32 binned = 0; binned < 2; binned++) {
+			u64 startTime = LinuxGetCurrentTimestamp();
+			for (u32 iteration = 0; iteration < iterationCount; iteration++) {
+				TiledRenderGroupToBuffer(&commands, dstBuffer, queue, binned ? 0 : TiledRender_SkipBinning);
+				MARKUP_FRAME_END;
+			}
+			milliseconds[binned] = 1000.f * LinuxCalculateTimeElapsed(startTime, LinuxGetCurrentTimestamp()) / iterationCount;
+			for (u32 pixelIndex = 0; pixelIndex < u4(dstBuffer.width * dstBuffer.height); pixelIndex++) {
+				checksums[binned] = checksums[binned] * 31 + dstBuffer.data[pixelIndex];
+			}
+		}
+		printf("  %6u bitmaps: all commands per tile %8.3fms, binned %8.3fms (%.2fx)%s\n",
+			bitmapCount, milliseconds[0], milliseconds[1], milliseconds[0] / milliseconds[1],
+			checksums[0] == checksums[1] ? "" : " OUTPUT MISMATCH");
+	}
+}
+
+internal
+void BenchOverdraw(PlatformQueue* queue) {
+	// NOTE: Layers of opaque ground tiles under opaque and translucent sprites, drawn back to front vs
+	// front to back with the coverage of opaque packs. Both have to produce the same pixels
+	constexpr u32 iterationCount = 10;
+	constexpr u32 groundLayerCount = 4;
+	constexpr u32 spriteCount = 4000;
+	LoadedBitmap dstBuffer = BenchMakeBitmap(globalLinuxState.displayWidth, globalLinuxState.displayHeight);
+	LoadedBitmap reference = BenchMakeBitmap(globalLinuxState.displayWidth, globalLinuxState.displayHeight);
+	LoadedBitmap opaqueTexture = BenchMakeBitmap(32, 32);
+	LoadedBitmap translucentTexture = BenchMakeBitmap(32, 32);
+	BenchRandom random = { 0x3C6EF372 };
+	for (u32 pixelIndex = 0; pixelIndex < u4(opaqueTexture.pitch / BITMAP_BYTES_PER_PIXEL * opaqueTexture.height); pixelIndex++) {
+		opaqueTexture.data[pixelIndex] = 0xFF000000 | (BenchNextRandom(random) & 0x00FFFFFF);
+		translucentTexture.data[pixelIndex] = 0x80402010;
+	}
+	opaqueTexture.flags = LoadedBitmap_Opaque | LoadedBitmap_AlphaTested;
+
+	RenderCommandBuffer commands = {};
+	commands.maxPushBufferSize = MB(4);
+	commands.pushBuffer = ptrcast(u8, LinuxAllocateMemory(u64(commands.maxPushBufferSize)));
+	u32 groundSize = 64;
+	u32 groundCountX = (dstBuffer.width + groundSize - 1) / groundSize + 1;
+	u32 groundCountY = (dstBuffer.height + groundSize - 1) / groundSize + 1;
+	u32 maxCommandCount = 1 + groundLayerCount * groundCountX * groundCountY + spriteCount;
+	commands.sortBufferCount = maxCommandCount;
+	commands.sortTempBuffer = ptrcast(SortElement, LinuxAllocateMemory(u64(sizeof(SortElement) * maxCommandCount)));
+	ResetRenderCommands(&commands);
+
+	RenderCallClear* clear = ptrcast(RenderCallClear,
+		BenchPushRenderEntry(&commands, RenderCallType_RenderCallClear, sizeof(RenderCallClear), -999999.f));
+	clear->color = V4{ 0.f, 0.f, 0.f, 1.f };
+	for (u32 layer = 0; layer < groundLayerCount; layer++) {
+		// NOTE: Every layer is shifted, so tile edges of one layer land inside of the tiles of the next one
+		f32 shift = f4(layer) * 13.5f;
+		for (u32 groundY = 0; groundY < groundCountY; groundY++) {
+			for (u32 groundX = 0; groundX < groundCountX; groundX++) {
+				RenderCallBitmap* call = ptrcast(RenderCallBitmap,
+					BenchPushRenderEntry(&commands, RenderCallType_RenderCallBitmap, sizeof(RenderCallBitmap), f4(layer)));
+				call->bitmap = &opaqueTexture;
+				call->center = V2{ f4(groundX * groundSize) - shift, f4(groundY * groundSize) - shift };
+				call->offset = V2{ 0.f, 0.f };
+				call->size = V2{ f4(groundSize), f4(groundSize) };
+				call->color = V4{ 1.f, 1.f, 1.f, 1.f };
+			}
+		}
+	}
+	for (u32 spriteIndex = 0; spriteIndex < spriteCount; spriteIndex++) {
+		RenderCallBitmap* call = ptrcast(RenderCallBitmap,
+			BenchPushRenderEntry(&commands, RenderCallType_RenderCallBitmap, sizeof(RenderCallBitmap),
+				f4(groundLayerCount) + BenchRandomUnilateral(random)));
+		f32 size = 16.f + 48.f * BenchRandomUnilateral(random);
+		call->bitmap = (spriteIndex & 1) ? &opaqueTexture : &translucentTexture;
+		call->center = V2{ BenchRandomUnilateral(random) * dstBuffer.width, BenchRandomUnilateral(random) * dstBuffer.height };
+		call->offset = V2{ 0.f, 0.f };
+		call->size = V2{ size, size };
+		call->color = V4{ 1.f, 1.f, 1.f, 1.f };
+	}
+	SortRenderCommands(&commands);
+
+	static TiledRenderJob job;
+	const char* modeNames[] = { "back to front", "front to back" };
+	f32 milliseconds[2] = {};
+	printf("overdraw, %ux%u, %u commands, %u threads, best of %u iterations\n",
+		dstBuffer.width, dstBuffer.height, commands.pushBufferCount, QueueThreadCount(queue), iterationCount);
+	for (u32 mode = 0; mode < 2; mode++) {
+		milliseconds[mode] = F32_MAX;
+		for (u32 iteration = 0; iteration < iterationCount; iteration++) {
+			u64 startTime = LinuxGetCurrentTimestamp();
+			job = {};
+			BeginTiledRenderGroupToBuffer(&job, &commands, dstBuffer, queue, mode ? 0 : TiledRender_SkipOcclusion);
+			QueueWaitForCounter(queue, &job.tilesCounter);
+			milliseconds[mode] = Minimum(milliseconds[mode], 1000.f * LinuxCalculateTimeElapsed(startTime, LinuxGetCurrentTimestamp()));
+			MARKUP_FRAME_END;
+		}
+		if (mode == 0) {
+			for (u32 pixelIndex = 0; pixelIndex < u4(dstBuffer.pitch / BITMAP_BYTES_PER_PIXEL * dstBuffer.height); pixelIndex++) {
+				reference.data[pixelIndex] = dstBuffer.data[pixelIndex];
+			}
+		}
+	}
+
+	u32 mismatchCount = 0;
+	for (i32 Y = 0; Y < dstBuffer.height; Y++) {
+		for (i32 X = 0; X < dstBuffer.width; X++) {
+			u32 pixelIndex = Y * dstBuffer.pitch / BITMAP_BYTES_PER_PIXEL + X;
+			mismatchCount += dstBuffer.data[pixelIndex] != reference.data[pixelIndex];
+		}
+	}
+	u32 tileCount = job.tileCountX * job.tileCountY;
+	u32 shadedPacks = 0;
+	u32 occludedPacks = 0;
+	f32 worstTileOverdraw = 0.f;
+	for (u32 tileIndex = 0; tileIndex < tileCount; tileIndex++) {
+		Rect2i clipRect = GetTileClipRect(&job, tileIndex);
+		u32 tilePacks = u4((clipRect.maxX - clipRect.minX + 7) / 8 * (clipRect.maxY - clipRect.minY));
+		shadedPacks += job.tileStats[tileIndex].shadedPacks;
+		occludedPacks += job.tileStats[tileIndex].occludedPacks;
+		worstTileOverdraw = Maximum(worstTileOverdraw, f4(job.tileStats[tileIndex].shadedPacks) / f4(tilePacks));
+	}
+	u32 screenPacks = job.coveragePitch * dstBuffer.height;
+	for (u32 mode = 0; mode < 2; mode++) {
+		printf("  %-14s %8.3fms\n", modeNames[mode], milliseconds[mode]);
+	}
+	printf("  %u tiles, overdraw %.2f (worst tile %.2f), %u packs shaded, %u occluded, %u mismatched pixels%s\n",
+		tileCount, f4(shadedPacks) / f4(screenPacks), worstTileOverdraw, shadedPacks, occludedPacks,
+		mismatchCount, mismatchCount ? " OUTPUT MISMATCH" : "");
+}
+
+internal
+void BenchKernels() {
+	// NOTE: Single threaded, every kernel variant the cpu supports draws the same commands, throughput
+	// is counted in pixels covered by command bounds per TSC cycle (best iteration)
+	constexpr u32 iterationCount = 20;
+	constexpr u32 commandCount = 2000;
+	LoadedBitmap dstBuffer = BenchMakeBitmap(globalLinuxState.displayWidth, globalLinuxState.displayHeight);
+	LoadedBitmap texture = BenchMakeBitmap(32, 32);
+	BenchRandom random = { 0x9E3779B9 };
+	for (u32 pixelIndex = 0; pixelIndex < u4(texture.pitch / BITMAP_BYTES_PER_PIXEL * texture.height); pixelIndex++) {
+		// NOTE: Premultiplied alpha, every channel <= alpha
+		u32 alpha = 64 + (BenchNextRandom(random) & 0xBF);
+		u32 red = BenchNextRandom(random) % (alpha + 1);
+		u32 green = BenchNextRandom(random) % (alpha + 1);
+		u32 blue = BenchNextRandom(random) % (alpha + 1);
+		texture.data[pixelIndex] = (alpha << 24) | (red << 16) | (green << 8) | blue;
+	}
+
+	RenderCommandBuffer commands = {};
+	commands.maxPushBufferSize = MB(1);
+	commands.pushBuffer = ptrcast(u8, LinuxAllocateMemory(u64(commands.maxPushBufferSize)));
+	Rect2i clipRect = { 0, 0, dstBuffer.width, dstBuffer.height };
+	CpuSimdLevel cpuLevel = GetCpuSimdLevel();
+
+	printf("software renderer kernels, %ux%u, %u commands, best of %u iterations, cpu: %s\n",
+		dstBuffer.width, dstBuffer.height, commandCount, iterationCount, GetCpuSimdLevelName(cpuLevel));
+	RenderCallType types[] = { RenderCallType_RenderCallRectangle, RenderCallType_RenderCallBitmap };
+	const char* typeNames[] = { "rectangle", "bitmap" };
+	for (u32 typeIndex = 0; typeIndex < ArrayCount(types); typeIndex++) {
+		ResetRenderCommands(&commands);
+		u64 pixelCount = 0;
+		for (u32 commandIndex = 0; commandIndex < commandCount; commandIndex++) {
+			V2 center = V2{ BenchRandomUnilateral(random) * dstBuffer.width, BenchRandomUnilateral(random) * dstBuffer.height };
+			V2 size = V2{ 8.f + 64.f * BenchRandomUnilateral(random), 8.f + 64.f * BenchRandomUnilateral(random) };
+			V4 color = V4{ 1.f, BenchRandomUnilateral(random), BenchRandomUnilateral(random), 0.5f + 0.5f * BenchRandomUnilateral(random) };
+			RenderCallHeader* header = 0;
+			if (types[typeIndex] == RenderCallType_RenderCallRectangle) {
+				RenderCallRectangle* call = ptrcast(RenderCallRectangle,
+					BenchPushRenderEntry(&commands, types[typeIndex], sizeof(RenderCallRectangle), f4(commandIndex)));
+				call->center = center;
+				call->size = size;
+				call->offset = V2{ 0.f, 0.f };
+				call->color = color;
+				header = ptrcast(RenderCallHeader, call) - 1;
+			}
+			else {
+				RenderCallBitmap* call = ptrcast(RenderCallBitmap,
+					BenchPushRenderEntry(&commands, types[typeIndex], sizeof(RenderCallBitmap), f4(commandIndex)));
+				call->bitmap = &texture;
+				call->center = center;
+				call->offset = V2{ 0.f, 0.f };
+				call->size = size;
+				call->color = color;
+				header = ptrcast(RenderCallHeader, call) - 1;
+			}
+			Rect2i bounds = Intersection(GetRenderCommandBounds(header, dstBuffer), clipRect);
+			if (HasArea(bounds)) {
+				pixelCount += u64(bounds.maxX - bounds.minX) * u64(bounds.maxY - bounds.minY);
+			}
+		}
+
+		f64 baselinePixelsPerCycle = 0.0;
+		u64 baselineChecksum = 0;
+		for (u32 level = 0; level <= u4(cpuLevel); level++) {
+			InitializeSoftwareRenderer(CpuSimdLevel(level));
+			u64 bestCycles = U64_MAX;
+			for (u32 iteration = 0; iteration < iterationCount; iteration++) {
+				memset(dstBuffer.data, 0x40, u64(dstBuffer.pitch) * dstBuffer.height);
+				u64 startCycles = __rdtsc();
+				SoftwareRenderCommandsToBuffer(&commands, dstBuffer, clipRect);
+				u64 cycles = __rdtsc() - startCycles;
+				bestCycles = Minimum(bestCycles, cycles);
+				MARKUP_FRAME_END;
+			}
+			u64 checksum = 0;
+			for (i32 Y = 0; Y < dstBuffer.height; Y++) {
+				u32* row = ptrcast(u32, ptrcast(u8, dstBuffer.data) + Y * dstBuffer.pitch);
+				for (i32 X = 0; X < dstBuffer.width; X++) {
+					checksum = checksum * 31 + row[X];
+				}
+			}
+			f64 pixelsPerCycle = f64(pixelCount) / f64(bestCycles);
+			if (level == 0) {
+				baselinePixelsPerCycle = pixelsPerCycle;
+				baselineChecksum = checksum;
+			}
+			printf("  %-9s %-7s %8.4f pixels/cycle (%.2fx)%s\n", typeNames[typeIndex], GetCpuSimdLevelName(CpuSimdLevel(level)),
+				pixelsPerCycle, pixelsPerCycle / baselinePixelsPerCycle, checksum == baselineChecksum ? "" : " OUTPUT MISMATCH");
+		}
+	}
+	InitializeSoftwareRenderer(cpuLevel);
+}
+
+internal
+void BenchBlit() {
+	// NOTE: Unscaled white bitmaps, copied by the blit path vs blended by the general kernel
+	constexpr u32 iterationCount = 20;
+	constexpr u32 commandCount = 2000;
+	LoadedBitmap dstBuffer = BenchMakeBitmap(globalLinuxState.displayWidth, globalLinuxState.displayHeight);
+	LoadedBitmap texture = BenchMakeBitmap(32, 32);
+	RenderCommandBuffer commands = {};
+	commands.maxPushBufferSize = MB(1);
+	commands.pushBuffer = ptrcast(u8, LinuxAllocateMemory(u64(commands.maxPushBufferSize)));
+	Rect2i clipRect = { 0, 0, dstBuffer.width, dstBuffer.height };
+	ResetRenderCommands(&commands);
+
+	BenchRandom random = { 0x2545F491 };
+	for (u32 commandIndex = 0; commandIndex < commandCount; commandIndex++) {
+		RenderCallBitmap* call = ptrcast(RenderCallBitmap,
+			BenchPushRenderEntry(&commands, RenderCallType_RenderCallBitmap, sizeof(RenderCallBitmap), f4(commandIndex)));
+		call->bitmap = &texture;
+		call->center = V2{ BenchRandomUnilateral(random) * dstBuffer.width, BenchRandomUnilateral(random) * dstBuffer.height };
+		call->offset = V2{ 0.f, 0.f };
+		call->size = V2{ f4(texture.width), f4(texture.height) };
+		call->color = V4{ 1.f, 1.f, 1.f, 1.f };
+	}
+
+	printf("bitmap blit, %ux%u, %u unscaled %ux%u bitmaps, best of %u iterations, kernels: %s\n",
+		dstBuffer.width, dstBuffer.height, commandCount, texture.width, texture.height, iterationCount,
+		GetCpuSimdLevelName(globalSoftwareRendererKernels.level));
+	const char* modeNames[] = { "opaque", "alpha tested" };
+	for (u32 mode = 0; mode < ArrayCount(modeNames); mode++) {
+		for (u32 pixelIndex = 0; pixelIndex < u4(texture.pitch / BITMAP_BYTES_PER_PIXEL * texture.height); pixelIndex++) {
+			u32 color = BenchNextRandom(random) & 0x00FFFFFF;
+			bool transparent = mode == 1 && (BenchNextRandom(random) & 1);
+			texture.data[pixelIndex] = transparent ? 0 : 0xFF000000 | color;
+		}
+		u32 alphaFlags = mode == 0 ? LoadedBitmap_Opaque | LoadedBitmap_AlphaTested : LoadedBitmap_AlphaTested;
+		u64 cycles[2] = {};
+		for (u32 blit = 0; blit < 2; blit++) {
+			texture.flags = blit ? alphaFlags : 0;
+			cycles[blit] = U64_MAX;
+			for (u32 iteration = 0; iteration < iterationCount; iteration++) {
+				memset(dstBuffer.data, 0x40, u64(dstBuffer.pitch) * dstBuffer.height);
+				u64 startCycles = __rdtsc();
+				SoftwareRenderCommandsToBuffer(&commands, dstBuffer, clipRect);
+				cycles[blit] = Minimum(cycles[blit], __rdtsc() - startCycles);
+				MARKUP_FRAME_END;
+			}
+		}
+		printf("  %-12s blend kernel %10" PRIu64 " cycles, blit %10" PRIu64 " cycles (%.2fx)\n", modeNames[mode],
+			cycles[0], cycles[1], f64(cycles[0]) / f64(cycles[1]));
+	}
+	texture.flags = 0;
+}
+
+internal
+void BenchSRGB() {
+	// NOTE: Scalar blend of a translucent color over random pixels, square and sqrt vs the tables
+	constexpr u32 iterationCount = 20;
+	constexpr u32 pixelCount = 1 << 18;
+	u32* pixels = ptrcast(u32, LinuxAllocateMemory(u64(pixelCount) * sizeof(u32)));
+	u32* mathOutput = ptrcast(u32, LinuxAllocateMemory(u64(pixelCount) * sizeof(u32)));
+	u32* tableOutput = ptrcast(u32, LinuxAllocateMemory(u64(pixelCount) * sizeof(u32)));
+	BenchRandom random = { 0x51ED270B };
+	for (u32 pixelIndex = 0; pixelIndex < pixelCount; pixelIndex++) {
+		pixels[pixelIndex] = BenchNextRandom(random);
+	}
+	V4 color = V4{ 0.2f, 0.4f, 0.1f, 0.5f };
+	f32 inv255 = 1.f / 255.f;
+
+	u64 cycles[2] = { U64_MAX, U64_MAX };
+	for (u32 iteration = 0; iteration < iterationCount; iteration++) {
+		u64 startCycles = __rdtsc();
+		for (u32 pixelIndex = 0; pixelIndex < pixelCount; pixelIndex++) {
+			u32 pixel = pixels[pixelIndex];
+			V4 dest = {
+				Squared(inv255 * f4((pixel >> 16) & 0xFF)),
+				Squared(inv255 * f4((pixel >> 8) & 0xFF)),
+				Squared(inv255 * f4((pixel >> 0) & 0xFF)),
+				inv255 * f4((pixel >> 24) & 0xFF)
+			};
+			V4 output = color + (1.f - color.A) * dest;
+			mathOutput[pixelIndex] = (u4(255.f * output.A + 0.5f) << 24) |
+				(u4(255.f * SquareRoot(output.R) + 0.5f) << 16) |
+				(u4(255.f * SquareRoot(output.G) + 0.5f) << 8) |
+				(u4(255.f * SquareRoot(output.B) + 0.5f) << 0);
+		}
+		cycles[0] = Minimum(cycles[0], __rdtsc() - startCycles);
+
+		startCycles = __rdtsc();
+		for (u32 pixelIndex = 0; pixelIndex < pixelCount; pixelIndex++) {
+			V4 dest = UnpackSRGB8ToLinear1(pixels[pixelIndex]);
+			V4 output = color + (1.f - color.A) * dest;
+			tableOutput[pixelIndex] = PackLinear1ToSRGB8(output);
+		}
+		cycles[1] = Minimum(cycles[1], __rdtsc() - startCycles);
+	}
+
+	u32 offByOne = 0;
+	u32 worse = 0;
+	for (u32 pixelIndex = 0; pixelIndex < pixelCount; pixelIndex++) {
+		for (u32 shift = 0; shift < 32; shift += 8) {
+			i32 difference = Abs(i4((mathOutput[pixelIndex] >> shift) & 0xFF) - i4((tableOutput[pixelIndex] >> shift) & 0xFF));
+			offByOne += difference == 1;
+			worse += difference > 1;
+		}
+	}
+	printf("srgb blend, %u pixels, best of %u iterations\n", pixelCount, iterationCount);
+	printf("  square/sqrt %6.2f cycles/pixel\n", f64(cycles[0]) / pixelCount);
+	printf("  tables      %6.2f cycles/pixel (%.2fx), %u channels off by one, %u worse%s\n", f64(cycles[1]) / pixelCount,
+		f64(cycles[0]) / f64(cycles[1]), offByOne, worse, worse ? " OUTPUT MISMATCH" : "");
+	LinuxFreeMemory(pixels);
+	LinuxFreeMemory(mathOutput);
+	LinuxFreeMemory(tableOutput);
+}
+
+internal
+void BenchMips() {
+	// NOTE: Large texture drawn far away (zoomed out camera), level 0 vs the mip picked by the renderer
+	constexpr u32 iterationCount = 20;
+	constexpr u32 commandCount = 2000;
+	LoadedBitmap dstBuffer = BenchMakeBitmap(globalLinuxState.displayWidth, globalLinuxState.displayHeight);
+	LoadedBitmap texture = BenchMakeBitmap(1024, 1024);
+	BenchRandom random = { 0x6A09E667 };
+	for (u32 pixelIndex = 0; pixelIndex < u4(texture.pitch / BITMAP_BYTES_PER_PIXEL * texture.height); pixelIndex++) {
+		u32 alpha = 64 + (BenchNextRandom(random) & 0xBF);
+		texture.data[pixelIndex] = (alpha << 24) | (BenchNextRandom(random) & 0x00FFFFFF & (alpha * 0x010101));
+	}
+	LoadedBitmap mips[BITMAP_MAX_MIP_COUNT];
+	u32 mipCount = GetBitmapMipCount(texture.width, texture.height);
+	for (u32 level = 1; level <= mipCount; level++) {
+		LoadedBitmap* prevLevel = level == 1 ? &texture : mips + level - 2;
+		mips[level - 1] = BenchMakeBitmap(prevLevel->width / 2, prevLevel->height / 2);
+		DownsampleBitmap(*prevLevel, mips[level - 1]);
+	}
+	texture.mips = mips;
+
+	RenderCommandBuffer commands = {};
+	commands.maxPushBufferSize = MB(1);
+	commands.pushBuffer = ptrcast(u8, LinuxAllocateMemory(u64(commands.maxPushBufferSize)));
+	Rect2i clipRect = { 0, 0, dstBuffer.width, dstBuffer.height };
+	ResetRenderCommands(&commands);
+	for (u32 commandIndex = 0; commandIndex < commandCount; commandIndex++) {
+		RenderCallBitmap* call = ptrcast(RenderCallBitmap,
+			BenchPushRenderEntry(&commands, RenderCallType_RenderCallBitmap, sizeof(RenderCallBitmap), f4(commandIndex)));
+		f32 size = 16.f + 48.f * BenchRandomUnilateral(random);
+		call->bitmap = &texture;
+		call->center = V2{ BenchRandomUnilateral(random) * dstBuffer.width, BenchRandomUnilateral(random) * dstBuffer.height };
+		call->offset = V2{ 0.f, 0.f };
+		call->size = V2{ size, size };
+		call->color = V4{ 1.f, 1.f, 1.f, 1.f };
+	}
+
+	printf("mipmapped bitmaps, %ux%u, %u %ux%u bitmaps drawn at 16-64px, best of %u iterations, kernels: %s\n",
+		dstBuffer.width, dstBuffer.height, commandCount, texture.width, texture.height, iterationCount,
+		GetCpuSimdLevelName(globalSoftwareRendererKernels.level));
+	u64 cycles[2] = {};
+	for (u32 mipmapped = 0; mipmapped < 2; mipmapped++) {
+		texture.mipCount = mipmapped ? mipCount : 0;
+		cycles[mipmapped] = U64_MAX;
+		for (u32 iteration = 0; iteration < iterationCount; iteration++) {
+			memset(dstBuffer.data, 0x40, u64(dstBuffer.pitch) * dstBuffer.height);
+			u64 startCycles = __rdtsc();
+			SoftwareRenderCommandsToBuffer(&commands, dstBuffer, clipRect);
+			cycles[mipmapped] = Minimum(cycles[mipmapped], __rdtsc() - startCycles);
+			MARKUP_FRAME_END;
+		}
+	}
+	printf("  level 0 %10" PRIu64 " cycles, %u mips %10" PRIu64 " cycles (%.2fx)\n",
+		cycles[0], mipCount, cycles[1], f64(cycles[0]) / f64(cycles[1]));
+}
+
+internal
+void BenchTiledTextures() {
+	// NOTE: Rotated sprites sampled from a row-major and from a 4x4 tiled copy of the same texture,
+	// both layouts have to produce the same pixels
+	constexpr u32 iterationCount = 10;
+	constexpr u32 spriteCount = 400;
+	LoadedBitmap dstBuffer = BenchMakeBitmap(globalLinuxState.displayWidth, globalLinuxState.displayHeight);
+	LoadedBitmap textures[2];
+	textures[0] = BenchMakeBitmap(1024, 1024);
+	textures[1] = textures[0];
+	textures[1].pitch = AlignUp4(textures[0].width) * BITMAP_BYTES_PER_PIXEL;
+	textures[1].flags = LoadedBitmap_Tiled;
+	textures[1].data = ptrcast(u32, LinuxAllocateMemory(GetTiledBitmapSize(textures[0].width, textures[0].height)));
+	BenchRandom random = { 0xBB67AE85 };
+	for (i32 Y = 0; Y < textures[0].height; Y++) {
+		for (i32 X = 0; X < textures[0].width; X++) {
+			u32 alpha = 64 + (BenchNextRandom(random) & 0xBF);
+			u32 texel = (alpha << 24) | (BenchNextRandom(random) & 0x00FFFFFF & (alpha * 0x010101));
+			*ptrcast(u32, ptrcast(u8, textures[0].data) + GetTexelOffset(textures[0], X, Y)) = texel;
+			*ptrcast(u32, ptrcast(u8, textures[1].data) + GetTexelOffset(textures[1], X, Y)) = texel;
+		}
+	}
+
+	struct BenchSprite {
+		V2 origin;
+		V2 xAxis;
+		V2 yAxis;
+	};
+	BenchSprite* sprites = ptrcast(BenchSprite, LinuxAllocateMemory(spriteCount * sizeof(BenchSprite)));
+	Rect2i clipRect = { 0, 0, dstBuffer.width, dstBuffer.height };
+	u64 pixelCount = 0;
+	for (u32 spriteIndex = 0; spriteIndex < spriteCount; spriteIndex++) {
+		BenchSprite* sprite = sprites + spriteIndex;
+		f32 angle = TAU * BenchRandomUnilateral(random);
+		f32 size = 128.f + 192.f * BenchRandomUnilateral(random);
+		sprite->xAxis = size * V2{ Cos(angle), Sin(angle) };
+		sprite->yAxis = V2{ -sprite->xAxis.Y, sprite->xAxis.X };
+		sprite->origin = V2{ BenchRandomUnilateral(random) * dstBuffer.width, BenchRandomUnilateral(random) * dstBuffer.height } -
+			0.5f * (sprite->xAxis + sprite->yAxis);
+		Rect2i bounds = GetRectangleFillRect(sprite->origin, sprite->xAxis, sprite->yAxis, clipRect);
+		if (HasArea(bounds)) {
+			pixelCount += u64(bounds.maxX - bounds.minX) * u64(bounds.maxY - bounds.minY);
+		}
+	}
+
+	CpuSimdLevel cpuLevel = GetCpuSimdLevel();
+	printf("rotated sprites, %ux%u, %u sprites of 128-320px from %ux%u texture, best of %u iterations\n",
+		dstBuffer.width, dstBuffer.height, spriteCount, textures[0].width, textures[0].height, iterationCount);
+	V4 color = V4{ 1.f, 1.f, 1.f, 1.f };
+	for (u32 level = 0; level <= u4(cpuLevel); level++) {
+		InitializeSoftwareRenderer(CpuSimdLevel(level));
+		f64 pixelsPerCycle[2] = {};
+		u64 checksums[2] = {};
+		for (u32 layout = 0; layout < 2; layout++) {
+			u64 bestCycles = U64_MAX;
+			for (u32 iteration = 0; iteration < iterationCount; iteration++) {
+				memset(dstBuffer.data, 0x40, u64(dstBuffer.pitch) * dstBuffer.height);
+				u64 startCycles = __rdtsc();
+				for (u32 spriteIndex = 0; spriteIndex < spriteCount; spriteIndex++) {
+					BenchSprite* sprite = sprites + spriteIndex;
+					globalSoftwareRendererKernels.RenderRectangle(dstBuffer, sprite->origin, sprite->xAxis, sprite->yAxis,
+						color, textures[layout], clipRect);
+				}
+				bestCycles = Minimum(bestCycles, __rdtsc() - startCycles);
+				MARKUP_FRAME_END;
+			}
+			for (i32 Y = 0; Y < dstBuffer.height; Y++) {
+				u32* row = ptrcast(u32, ptrcast(u8, dstBuffer.data) + Y * dstBuffer.pitch);
+				for (i32 X = 0; X < dstBuffer.width; X++) {
+					checksums[layout] = checksums[layout] * 31 + row[X];
+				}
+			}
+			pixelsPerCycle[layout] = f64(pixelCount) / f64(bestCycles);
+		}
+		printf("  %-7s row-major %8.4f pixels/cycle, tiled %8.4f pixels/cycle (%.2fx)%s\n",
+			GetCpuSimdLevelName(CpuSimdLevel(level)), pixelsPerCycle[0], pixelsPerCycle[1],
+			pixelsPerCycle[1] / pixelsPerCycle[0], checksums[0] == checksums[1] ? "" : " OUTPUT MISMATCH");
+	}
+	InitializeSoftwareRenderer(cpuLevel);
+}
+
+internal
+void BenchSort(PlatformQueue* queue) {
+	// NOTE: Render command keys with random depth and texture, sorted by every implementation from the same input
+	const u32 elementCounts[] = { 10000, 100000, 1000000 };
+	const u32 iterationCount = 10;
+	const char* sortNames[] = { "merge", "radix", "radix 1 thread", "radix parallel" };
+	u32 maxCount = elementCounts[ArrayCount(elementCounts) - 1];
+	SortElement* input = ptrcast(SortElement, LinuxAllocateMemory(u64(sizeof(SortElement) * maxCount)));
+	SortElement* array = ptrcast(SortElement, LinuxAllocateMemory(u64(sizeof(SortElement) * maxCount)));
+	SortElement* tempBuffer = ptrcast(SortElement, LinuxAllocateMemory(u64(sizeof(SortElement) * maxCount)));
+	SortElement* reference = ptrcast(SortElement, LinuxAllocateMemory(u64(sizeof(SortElement) * maxCount)));
+	RadixSortJob* job = ptrcast(RadixSortJob, LinuxAllocateMemory(u64(sizeof(RadixSortJob))));
+	BenchRandom random = { 1234 };
+	for (u32 elementIndex = 0; elementIndex < maxCount; elementIndex++) {
+		f32 depth = f4(BenchNextRandom(random) % 16) * 100.f + BenchRandomUnilateral(random) * 50.f - 800.f;
+		input[elementIndex].key = (u64(RenderSortLayer_World) << RENDER_SORT_LAYER_SHIFT) |
+			(u64(GetRenderSortDepthBand(depth)) << RENDER_SORT_DEPTH_SHIFT) |
+			(u64(BenchNextRandom(random) % 64) << RENDER_SORT_TEXTURE_SHIFT) | RenderCallType_RenderCallBitmap;
+		input[elementIndex].offset = elementIndex;
+	}
+
+	printf("render command sort, %u threads, best of %u iterations\n", QueueThreadCount(queue), iterationCount);
+	for (u32 countIndex = 0; countIndex < ArrayCount(elementCounts); countIndex++) {
+		u32 count = elementCounts[countIndex];
+		f32 milliseconds[ArrayCount(sortNames)];
+		bool matches[ArrayCount(sortNames)];
+		for (u32 sortIndex = 0; sortIndex < ArrayCount(sortNames); sortIndex++) {
+			milliseconds[sortIndex] = F32_MAX;
+			for (u32 iteration = 0; iteration < iterationCount; iteration++) {
+				for (u32 elementIndex = 0; elementIndex < count; elementIndex++) {
+					array[elementIndex] = input[elementIndex];
+				}
+				u64 startTime = LinuxGetCurrentTimestamp();
+				switch (sortIndex) {
+				case 0: {
+					MergeSort(array, count, tempBuffer);
+				} break;
+				case 1: {
+					RadixSort(array, count, tempBuffer);
+				} break;
+				case 2: {
+					ParallelRadixSort(job, array, count, tempBuffer, 0);
+				} break;
+				case 3: {
+					ParallelRadixSort(job, array, count, tempBuffer, queue);
+				} break;
+				}
+				milliseconds[sortIndex] = Minimum(milliseconds[sortIndex],
+					1000.f * LinuxCalculateTimeElapsed(startTime, LinuxGetCurrentTimestamp()));
+			}
+			// NOTE: Radix sorts are stable, merge sort only has to be ordered
+			if (sortIndex == 1) {
+				for (u32 elementIndex = 0; elementIndex < count; elementIndex++) {
+					reference[elementIndex] = array[elementIndex];
+				}
+			}
+			matches[sortIndex] = true;
+			for (u32 elementIndex = 0; elementIndex + 1 < count; elementIndex++) {
+				matches[sortIndex] &= array[elementIndex].key <= array[elementIndex + 1].key;
+			}
+			for (u32 elementIndex = 0; sortIndex > 1 && elementIndex < count; elementIndex++) {
+				matches[sortIndex] &= array[elementIndex].offset == reference[elementIndex].offset;
+			}
+		}
+		printf("  %7u elements:", count);
+		for (u32 sortIndex = 0; sortIndex < ArrayCount(sortNames); sortIndex++) {
+			printf(" %s %7.3fms%s", sortNames[sortIndex], milliseconds[sortIndex], matches[sortIndex] ? "" : " OUTPUT MISMATCH");
+			printf(sortIndex + 1 < ArrayCount(sortNames) ? "," : "\n");
+		}
+	}
+	LinuxFreeMemory(input);
+	LinuxFreeMemory(array);
+	LinuxFreeMemory(tempBuffer);
+	LinuxFreeMemory(reference);
+	LinuxFreeMemory(job);
+}
+
+internal
+void BenchBatching() {
+	// NOTE: Texture switches of a ground buffer fill, 9 chunks of decals with few textures spread over the
+	// whole depth range, sorted by exact depth and by depth bands
+	const u32 decalCount = 900;
+	const u32 textureCount = 4;
+	const f32 fillHeight = 3 * 5.6f;
+	const char* keyNames[] = { "exact depth", "depth bands" };
+	SortElement* array = ptrcast(SortElement, LinuxAllocateMemory(u64(sizeof(SortElement) * decalCount)));
+	SortElement* tempBuffer = ptrcast(SortElement, LinuxAllocateMemory(u64(sizeof(SortElement) * decalCount)));
+	u64 textureMask = u64(RENDER_SORT_TEXTURE_MASK) << RENDER_SORT_TEXTURE_SHIFT;
+
+	printf("render command batching, %u decals, %u textures, %u bands per meter\n",
+		decalCount, textureCount, RENDER_SORT_DEPTH_BANDS_PER_METER);
+	for (u32 keyIndex = 0; keyIndex < ArrayCount(keyNames); keyIndex++) {
+		BenchRandom random = { 0x9E3779B9 };
+		for (u32 decalIndex = 0; decalIndex < decalCount; decalIndex++) {
+			f32 depth = -(BenchRandomUnilateral(random) - 0.5f) * fillHeight;
+			u32 depthBits = keyIndex ? GetRenderSortDepthBand(depth) : FloatToRadixValue(depth);
+			array[decalIndex].key = (u64(RenderSortLayer_World) << RENDER_SORT_LAYER_SHIFT) |
+				(u64(depthBits) << RENDER_SORT_DEPTH_SHIFT) |
+				(u64(1 + BenchNextRandom(random) % textureCount) << RENDER_SORT_TEXTURE_SHIFT) | RenderCallType_RenderCallBitmap;
+			array[decalIndex].offset = decalIndex;
+		}
+		RadixSort(array, decalCount, tempBuffer);
+		u32 switches = CountRenderStateSwitches(array, decalCount, textureMask);
+		printf("  %-12s %4u texture switches, %6.2f commands per bind\n", keyNames[keyIndex], switches, f4(decalCount) / f4(switches + 1));
+	}
+	LinuxFreeMemory(array);
+	LinuxFreeMemory(tempBuffer);
+}
+
+internal
+TransientState* BenchBeginAssets(PlatformQueue* queue, u64 arenaSize) {
+	// NOTE: Only the part of the engine's transient state the asset system uses, queue workers take
+	// both the table merges and the loads
+	TransientState* result = ptrcast(TransientState, LinuxAllocateMemory(u64(sizeof(TransientState)) + arenaSize));
+	InitializeArena(result->arena, result + 1, arenaSize);
+	result->highPriorityQueue = queue;
+	result->lowPriorityQueue = queue;
+	return result;
+}
+
+internal
+bool BenchAllocateAssets(TransientState* tranState, const char* directory, AssetMemoryConfig config) {
+	// NOTE: Loader opens every pack in the working directory, like the game does next to its executable
+	char workingDirectory[MY_MAX_PATH];
+	if (!getcwd(workingDirectory, sizeof(workingDirectory)) || chdir(directory) != 0) {
+		return false;
+	}
+	AllocateAssets(tranState, config);
+	return chdir(workingDirectory) == 0;
+}
+
+internal
+void BenchEndAssets(TransientState* tranState) {
+	Platform->FileCloseAllInGroup(tranState->assets.sources);
+	LinuxFreeMemory(tranState);
+}
+
+inline
+f32 BenchThreadCpuMilliseconds() {
+	timespec time = {};
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+	return f4(time.tv_sec) * 1000.f + f4(time.tv_nsec) / 1000000.f;
+}
+
+internal
+void BenchAssetToc(PlatformQueue* queue) {
+	// NOTE: Startup reads of pack tables, separate reads of every group's slices like the loader used to do
+	// against the engine's ReadAssetFileTocPrefix, which queues one read per pack and sleeps in the poll.
+	// Warm runs hit page cache, cold runs drop the packs from it first, so the main thread waits on the
+	// disk and its cpu time shows whether it sleeps. AllocateAssets is the whole startup with merges
+	const u32 assetsPerGroup = 64;
+	const u32 packCounts[] = { 1, 16, 64, 256 };
+	const u32 iterationCount = 8;
+	u32 packAssetCount = 1 + (Asset_Count - 1) * assetsPerGroup;
+	AssetFileHeader header;
+	header.assetsCount = packAssetCount;
+	header.featuresOffset = sizeof(AssetFileHeader);
+	header.assetGroupsOffset = header.featuresOffset + sizeof(AssetFeatures) * packAssetCount;
+	header.assetMetadatasOffset = header.assetGroupsOffset + sizeof(AssetGroup) * Asset_Count;
+	header.assetsOffset = header.assetMetadatasOffset + sizeof(AssetMetadata) * packAssetCount;
+	u32 tocSize = u4(header.assetsOffset);
+	u8* toc = ptrcast(u8, LinuxAllocateMemory(u64(tocSize)));
+	*ptrcast(AssetFileHeader, toc) = header;
+	AssetGroup* groups = ptrcast(AssetGroup, toc + header.assetGroupsOffset);
+	for (u32 groupIndex = 1; groupIndex < Asset_Count; groupIndex++) {
+		groups[groupIndex].firstAssetIndex = 1 + (groupIndex - 1) * assetsPerGroup;
+		groups[groupIndex].onePastLastAssetIndex = groups[groupIndex].firstAssetIndex + assetsPerGroup;
+		groups[groupIndex].type = AssetGroup_Bitmap;
+	}
+
+	char directory[] = "/tmp/assf_bench_XXXXXX";
+	if (!mkdtemp(directory)) {
+		printf("asset toc: can't create temporary directory\n");
+		LinuxFreeMemory(toc);
+		return;
+	}
+	u32 maxPackCount = packCounts[ArrayCount(packCounts) - 1];
+	PlatformFileHandle** files = ptrcast(PlatformFileHandle*, LinuxAllocateMemory(u64(sizeof(PlatformFileHandle*) * maxPackCount)));
+	u8** tocs = ptrcast(u8*, LinuxAllocateMemory(u64(sizeof(u8*) * maxPackCount)));
+	AssetFileSource* sources = ptrcast(AssetFileSource, LinuxAllocateMemory(u64(sizeof(AssetFileSource) * maxPackCount)));
+	Assets* prefixAssets = ptrcast(Assets, LinuxAllocateMemory(u64(sizeof(Assets))));
+	u32 writtenPackCount = 0;
+	char path[64];
+
+	printf("asset table of contents, %u assets and %u bytes per pack, best of %u iterations, async reads %s\n",
+		packAssetCount, tocSize, iterationCount, globalAsyncReads.ringFd >= 0 ? "on" : "off");
+	for (u32 countIndex = 0; countIndex < ArrayCount(packCounts); countIndex++) {
+		// NOTE: AllocateAssets opens every pack of the directory, so it only ever holds this row's packs
+		u32 packCount = packCounts[countIndex];
+		for (; writtenPackCount < packCount; writtenPackCount++) {
+			snprintf(path, sizeof(path), "%s/pack%03u.assf", directory, writtenPackCount);
+			i32 fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			write(fd, toc, tocSize);
+			close(fd);
+			files[writtenPackCount] = LinuxFileOpen(path);
+			tocs[writtenPackCount] = ptrcast(u8, LinuxAllocateMemory(u64(tocSize)));
+		}
+		PlatformFileGroup fileGroup = { files, packCount };
+
+		f32 groupReadMilliseconds = F32_MAX;
+		f32 prefixMilliseconds = F32_MAX;
+		f32 coldMilliseconds = F32_MAX;
+		f32 coldCpuMilliseconds = F32_MAX;
+		f32 allocateMilliseconds = F32_MAX;
+		u32 groupReadCount = 0;
+		u32 checksums[3] = {};
+		for (u32 iteration = 0; iteration < iterationCount; iteration++) {
+			// NOTE: Header pass and full pass with three reads per group
+			u32 readCount = 0;
+			u64 startTime = LinuxGetCurrentTimestamp();
+			for (u32 pass = 0; pass < 2; pass++) {
+				for (u32 packIndex = 0; packIndex < packCount; packIndex++) {
+					LinuxFileRead(files[packIndex], 0, sizeof(AssetFileHeader), tocs[packIndex]);
+					readCount++;
+				}
+			}
+			for (u32 groupIndex = 1; groupIndex < Asset_Count; groupIndex++) {
+				for (u32 packIndex = 0; packIndex < packCount; packIndex++) {
+					u8* dst = tocs[packIndex];
+					u64 groupOffset = header.assetGroupsOffset + sizeof(AssetGroup) * groupIndex;
+					LinuxFileRead(files[packIndex], groupOffset, sizeof(AssetGroup), dst + groupOffset);
+					AssetGroup* group = ptrcast(AssetGroup, dst + groupOffset);
+					u32 count = group->onePastLastAssetIndex - group->firstAssetIndex;
+					u64 featuresOffset = header.featuresOffset + sizeof(AssetFeatures) * group->firstAssetIndex;
+					LinuxFileRead(files[packIndex], featuresOffset, sizeof(AssetFeatures) * count, dst + featuresOffset);
+					u64 metadataOffset = header.assetMetadatasOffset + sizeof(AssetMetadata) * group->firstAssetIndex;
+					LinuxFileRead(files[packIndex], metadataOffset, sizeof(AssetMetadata) * count, dst + metadataOffset);
+					readCount += 3;
+				}
+			}
+			groupReadMilliseconds = Minimum(groupReadMilliseconds, 1000.f * LinuxCalculateTimeElapsed(startTime, LinuxGetCurrentTimestamp()));
+			groupReadCount = readCount;
+			checksums[0] = ptrcast(AssetGroup, tocs[packCount - 1] + header.assetGroupsOffset)[Asset_Font].onePastLastAssetIndex;
+
+			for (u32 cold = 0; cold < 2; cold++) {
+				if (cold) {
+					for (u32 packIndex = 0; packIndex < packCount; packIndex++) {
+						posix_fadvise(ptrcast(LinuxFileHandle, files[packIndex])->fd, 0, 0, POSIX_FADV_DONTNEED);
+					}
+				}
+				ZeroSize_(ptrcast(u8, sources), sizeof(AssetFileSource) * packCount);
+				f32 startCpu = BenchThreadCpuMilliseconds();
+				startTime = LinuxGetCurrentTimestamp();
+				ReadAssetFileTocPrefix(*prefixAssets, &fileGroup, sources);
+				f32 milliseconds = 1000.f * LinuxCalculateTimeElapsed(startTime, LinuxGetCurrentTimestamp());
+				f32 cpuMilliseconds = BenchThreadCpuMilliseconds() - startCpu;
+				if (cold) {
+					coldMilliseconds = Minimum(coldMilliseconds, milliseconds);
+					coldCpuMilliseconds = Minimum(coldCpuMilliseconds, cpuMilliseconds);
+				}
+				else {
+					prefixMilliseconds = Minimum(prefixMilliseconds, milliseconds);
+				}
+				checksums[1] = 0;
+				for (u32 packIndex = 0; packIndex < packCount; packIndex++) {
+					AssetFileSource* source = sources + packIndex;
+					if (source->valid && packIndex == packCount - 1) {
+						checksums[1] = ptrcast(AssetGroup, source->toc + header.assetGroupsOffset)[Asset_Font].onePastLastAssetIndex;
+					}
+					if (source->ownsToc) {
+						Platform->MemoryFree(source->toc);
+					}
+				}
+			}
+
+			AssetMemoryConfig config = {};
+			config.initialSize = MB(1);
+			config.maxSize = MB(1);
+			TransientState* tranState = BenchBeginAssets(queue, MB(64));
+			startTime = LinuxGetCurrentTimestamp();
+			bool allocated = BenchAllocateAssets(tranState, directory, config);
+			allocateMilliseconds = Minimum(allocateMilliseconds, 1000.f * LinuxCalculateTimeElapsed(startTime, LinuxGetCurrentTimestamp()));
+			checksums[2] = allocated && tranState->assets.assetCount == 1 + packCount * (packAssetCount - 1) ? checksums[0] : 0;
+			BenchEndAssets(tranState);
+		}
+		printf("  %3u packs: per group reads %8.3fms (%5u reads), ReadAssetFileTocPrefix %8.3fms (%.2fx), "
+			"cold %8.3fms with %7.3fms cpu, AllocateAssets %8.3fms%s\n",
+			packCount, groupReadMilliseconds, groupReadCount, prefixMilliseconds, groupReadMilliseconds / prefixMilliseconds,
+			coldMilliseconds, coldCpuMilliseconds, allocateMilliseconds,
+			checksums[0] == checksums[1] && checksums[0] == checksums[2] ? "" : " OUTPUT MISMATCH");
+	}
+
+	for (u32 packIndex = 0; packIndex < writtenPackCount; packIndex++) {
+		LinuxFileClose(files[packIndex]);
+		LinuxFreeMemory(tocs[packIndex]);
+		snprintf(path, sizeof(path), "%s/pack%03u.assf", directory, packIndex);
+		unlink(path);
+	}
+	rmdir(directory);
+	LinuxFreeMemory(files);
+	LinuxFreeMemory(tocs);
+	LinuxFreeMemory(sources);
+	LinuxFreeMemory(prefixAssets);
+	LinuxFreeMemory(toc);
+}
+
+internal
+bool CheckLZRoundTrip(u8* src, u32 size, u8* compressed, u32 compressedSize, u8* dst) {
+	// NOTE: dst has room for 64 bytes past size, decoding must never touch them
+	const u32 guardSize = 64;
+	memset(dst, 0xCD, size + guardSize);
+	bool result = LZDecompress(compressed, compressedSize, dst, size) && memcmp(src, dst, size) == 0;
+	// NOTE: Cut input and too small output have to be reported instead of read or written past
+	for (u32 cutSize : { compressedSize - 1, compressedSize / 2, 1u }) {
+		result = result && !LZDecompress(compressed, cutSize, dst, size);
+	}
+	result = result && (!size || !LZDecompress(compressed, compressedSize, dst, size - 1));
+	for (u32 guardIndex = 0; guardIndex < guardSize; guardIndex++) {
+		result = result && dst[size + guardIndex] == 0xCD;
+	}
+	return result;
+}
+
+internal
+void BenchLZ() {
+	// NOTE: LZ round trip of every kind of payload, with decode speed. Music chunk is 16 bit samples
+	// stored as floats like the composer writes them, raw and with the byte shuffle filter
+	const u32 iterationCount = 10;
+	const u32 sampleCount = 4 * 48000 + SOUND_CHUNK_SAMPLE_OVERLAP;
+	const u32 size = 2 * sampleCount * sizeof(f32);
+	const char* kindNames[] = { "random words", "all zero", "incompressible", "music", "music shuffled" };
+	u8* src = ptrcast(u8, LinuxAllocateMemory(u64(size)));
+	u8* filtered = ptrcast(u8, LinuxAllocateMemory(u64(size)));
+	u8* compressed = ptrcast(u8, LinuxAllocateMemory(u64(GetLZCompressBound(size))));
+	u8* dst = ptrcast(u8, LinuxAllocateMemory(u64(size) + 64));
+	u32* hashTable = ptrcast(u32, LinuxAllocateMemory(u64(sizeof(u32) * LZ_HASH_TABLE_COUNT)));
+	u32 musicCompressedSize = 0;
+	f32 musicDecodeMilliseconds = 0.f;
+
+	printf("lz round trip, %u bytes per payload, best of %u decodes\n", size, iterationCount);
+	u32 failedCount = 0;
+	for (u32 kind = 0; kind < ArrayCount(kindNames); kind++) {
+		BenchRandom random = { 0x1F2E3D4C };
+		switch (kind) {
+		case 0: {
+			for (u32 at = 0; at < size;) {
+				u32 word = BenchNextRandom(random) & 63;
+				for (u32 letter = 0; letter < 4 + (word & 7) && at < size; letter++) {
+					src[at++] = u8('a' + (word + letter * 7) % 26);
+				}
+			}
+		} break;
+		case 1: {
+			memset(src, 0, size);
+		} break;
+		case 2: {
+			for (u32 at = 0; at < size; at += sizeof(u32)) {
+				*ptrcast(u32, src + at) = BenchNextRandom(random);
+			}
+		} break;
+		case 3:
+		case 4: {
+			f32* samples = ptrcast(f32, src);
+			for (u32 channel = 0; channel < 2; channel++) {
+				for (u32 sampleIndex = 0; sampleIndex < sampleCount; sampleIndex++) {
+					f32 t = f4(sampleIndex) / 48000.f;
+					f32 noise = 0.05f * (2.f * BenchRandomUnilateral(random) - 1.f);
+					f32 value = 0.3f * Sin(TAU * 220.f * t) + 0.2f * Sin(TAU * 330.f * t + f4(channel)) + noise;
+					samples[channel * sampleCount + sampleIndex] = f4(i16(value * f4(I16_MAX))) / f4(I16_MAX);
+				}
+			}
+		} break;
+		}
+		bool shuffled = kind == 4;
+		if (shuffled) {
+			ShuffleLZBytes(src, filtered, size);
+		}
+		u8* input = shuffled ? filtered : src;
+		u32 compressedSize = LZCompress(input, size, compressed, GetLZCompressBound(size), hashTable);
+		bool matches = compressedSize && CheckLZRoundTrip(input, size, compressed, compressedSize, dst);
+		f32 milliseconds = F32_MAX;
+		for (u32 iteration = 0; iteration < iterationCount && matches; iteration++) {
+			u64 startTime = LinuxGetCurrentTimestamp();
+			LZDecompress(compressed, compressedSize, dst, size);
+			if (shuffled) {
+				UnshuffleLZBytes(dst, size);
+			}
+			milliseconds = Minimum(milliseconds, 1000.f * LinuxCalculateTimeElapsed(startTime, LinuxGetCurrentTimestamp()));
+		}
+		matches = matches && memcmp(src, dst, size) == 0;
+		failedCount += !matches;
+		printf("  %-16s %8u bytes (%5.3f)%s, decode %6.3fms (%7.1fMB/s)%s\n", kindNames[kind], compressedSize,
+			f64(compressedSize) / f64(size), compressedSize <= size - size / 8 ? "" : " stored raw",
+			milliseconds, f64(size) / (1024.0 * 1024.0) / (milliseconds / 1000.0), matches ? "" : " OUTPUT MISMATCH");
+		if (shuffled) {
+			musicCompressedSize = compressedSize;
+			musicDecodeMilliseconds = milliseconds;
+		}
+	}
+
+	// NOTE: Load of one music chunk from page cache, raw read against the compressed read and decode
+	char path[] = "/tmp/lz_bench_XXXXXX";
+	i32 fd = mkstemp(path);
+	bool written = fd >= 0 &&
+		pwrite(fd, src, size, 0) == i4(size) &&
+		pwrite(fd, compressed, musicCompressedSize, off_t(size)) == i4(musicCompressedSize);
+	if (fd >= 0) {
+		close(fd);
+	}
+	PlatformFileHandle* file = written ? LinuxFileOpen(path) : 0;
+	if (file) {
+		f32 milliseconds[2] = { F32_MAX, F32_MAX };
+		for (u32 iteration = 0; iteration < iterationCount; iteration++) {
+			u64 startTime = LinuxGetCurrentTimestamp();
+			LinuxFileRead(file, 0, size, dst);
+			milliseconds[0] = Minimum(milliseconds[0], 1000.f * LinuxCalculateTimeElapsed(startTime, LinuxGetCurrentTimestamp()));
+			startTime = LinuxGetCurrentTimestamp();
+			LinuxFileRead(file, size, musicCompressedSize, compressed);
+			LZDecompress(compressed, musicCompressedSize, dst, size);
+			UnshuffleLZBytes(dst, size);
+			milliseconds[1] = Minimum(milliseconds[1], 1000.f * LinuxCalculateTimeElapsed(startTime, LinuxGetCurrentTimestamp()));
+		}
+		failedCount += memcmp(src, dst, size) != 0;
+		printf("  music chunk load from page cache: raw %6.3fms, shuffled lz %6.3fms (decode %6.3fms), %u bytes less to read\n",
+			milliseconds[0], milliseconds[1], musicDecodeMilliseconds, size - musicCompressedSize);
+		LinuxFileClose(file);
+	}
+	unlink(path);
+	printf("  %s\n", failedCount ? "FAILED" : "all round trips match");
+
+	LinuxFreeMemory(src);
+	LinuxFreeMemory(filtered);
+	LinuxFreeMemory(compressed);
+	LinuxFreeMemory(dst);
+	LinuxFreeMemory(hashTable);
+}
+
+struct BenchAssetPack {
+	const char* name;
+	u32 version;
+	i32 bitmapWidth;
+	i32 bitmapHeight;
+	u32 sampleCount;
+	u64 bitmapOffset;
+	u64 soundOffset;
+	u32 bitmapSize;
+	u32 soundSize;
+	u8* texels;
+	u8* samples;
+};
+
+internal
+bool BenchWriteAssetPack(const char* directory, BenchAssetPack& pack, BenchRandom& random) {
+	// NOTE: Null asset, one bitmap and one stereo sound laid out the way the loader reads them, the file
+	// is sparse so only the table and the payloads take disk space
+	const u32 assetCount = 3;
+	u64 metadataSize = pack.version < 2 ? sizeof(AssetMetadataV1) : sizeof(AssetMetadata);
+	pack.bitmapSize = u4(pack.bitmapWidth * pack.bitmapHeight) * BITMAP_BYTES_PER_PIXEL;
+	pack.soundSize = 2 * (pack.sampleCount + SOUND_CHUNK_SAMPLE_OVERLAP) * sizeof(f32);
+	u32 channelSize = pack.soundSize / 2;
+
+	AssetFileHeader header;
+	header.version = pack.version;
+	header.assetsCount = assetCount;
+	header.featuresOffset = sizeof(AssetFileHeader);
+	header.assetGroupsOffset = header.featuresOffset + sizeof(AssetFeatures) * assetCount;
+	header.assetMetadatasOffset = header.assetGroupsOffset + sizeof(AssetGroup) * Asset_Count;
+	header.assetsOffset = header.assetMetadatasOffset + metadataSize * assetCount;
+	u32 tocSize = u4(header.assetsOffset);
+	u8* toc = ptrcast(u8, LinuxAllocateMemory(u64(tocSize)));
+	*ptrcast(AssetFileHeader, toc) = header;
+	AssetGroup* groups = ptrcast(AssetGroup, toc + header.assetGroupsOffset);
+	for (u32 groupIndex = 1; groupIndex < Asset_Count; groupIndex++) {
+		groups[groupIndex] = { assetCount, assetCount, AssetGroup_Bitmap };
+	}
+	groups[Asset_Tree] = { 1, 2, AssetGroup_Bitmap };
+	groups[Asset_Music] = { 2, 3, AssetGroup_Sound };
+	u8* metadatas = toc + header.assetMetadatasOffset;
+	if (pack.version < 2) {
+		AssetFileBitmapInfoV1* bitmapInfo = &ptrcast(AssetMetadataV1, metadatas)[1]._bitmapInfo;
+		bitmapInfo->width = pack.bitmapWidth;
+		bitmapInfo->height = pack.bitmapHeight;
+		bitmapInfo->pitch = pack.bitmapWidth * BITMAP_BYTES_PER_PIXEL;
+		bitmapInfo->alignment = V2{ 0.5f, 0.f };
+		bitmapInfo->dataSizeInBytes = pack.bitmapSize;
+		bitmapInfo->dataOffset = u4(pack.bitmapOffset);
+		AssetFileSoundInfoV1* soundInfo = &ptrcast(AssetMetadataV1, metadatas)[2]._soundInfo;
+		soundInfo->sampleCount = pack.sampleCount;
+		soundInfo->nChannels = 2;
+		soundInfo->dataSizeInBytes = pack.soundSize;
+		soundInfo->samplesOffset[0] = u4(pack.soundOffset);
+		soundInfo->samplesOffset[1] = u4(pack.soundOffset + channelSize);
+	}
+	else {
+		AssetFileBitmapInfo* bitmapInfo = &ptrcast(AssetMetadata, metadatas)[1]._bitmapInfo;
+		bitmapInfo->width = pack.bitmapWidth;
+		bitmapInfo->height = pack.bitmapHeight;
+		bitmapInfo->pitch = pack.bitmapWidth * BITMAP_BYTES_PER_PIXEL;
+		bitmapInfo->alignment = V2{ 0.5f, 0.f };
+		bitmapInfo->dataSizeInBytes = pack.bitmapSize;
+		bitmapInfo->dataOffset = pack.bitmapOffset;
+		AssetFileSoundInfo* soundInfo = &ptrcast(AssetMetadata, metadatas)[2]._soundInfo;
+		soundInfo->sampleCount = pack.sampleCount;
+		soundInfo->nChannels = 2;
+		soundInfo->dataSizeInBytes = pack.soundSize;
+		soundInfo->samplesOffset[0] = pack.soundOffset;
+		soundInfo->samplesOffset[1] = pack.soundOffset + channelSize;
+	}
+
+	pack.texels = ptrcast(u8, LinuxAllocateMemory(u64(pack.bitmapSize)));
+	pack.samples = ptrcast(u8, LinuxAllocateMemory(u64(pack.soundSize)));
+	for (u32 texelIndex = 0; texelIndex < pack.bitmapSize / sizeof(u32); texelIndex++) {
+		ptrcast(u32, pack.texels)[texelIndex] = BenchNextRandom(random);
+	}
+	for (u32 sampleIndex = 0; sampleIndex < pack.soundSize / sizeof(f32); sampleIndex++) {
+		ptrcast(f32, pack.samples)[sampleIndex] = f4(i4(BenchNextRandom(random) & 0xFFFF) - 0x8000) / 32768.f;
+	}
+
+	char path[64];
+	snprintf(path, sizeof(path), "%s/%s.assf", directory, pack.name);
+	i32 fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	u64 fileSize = Maximum(pack.bitmapOffset + pack.bitmapSize, pack.soundOffset + pack.soundSize);
+	bool result = fd >= 0 &&
+		ftruncate(fd, off_t(fileSize)) == 0 &&
+		pwrite(fd, toc, tocSize, 0) == i4(tocSize) &&
+		pwrite(fd, pack.texels, pack.bitmapSize, off_t(pack.bitmapOffset)) == i4(pack.bitmapSize) &&
+		pwrite(fd, pack.samples, pack.soundSize, off_t(pack.soundOffset)) == i4(pack.soundSize);
+	if (fd >= 0) {
+		close(fd);
+	}
+	LinuxFreeMemory(toc);
+	return result;
+}
+
+internal
+u32 BenchCheckAssetPacks(Assets& assets, BenchAssetPack* packs, u32 packCount, const char* mode) {
+	// NOTE: Combined tables are checked against the written offsets, then every asset is prefetched and
+	// the loads are finished the way the frame loop does it. Returns the number of mismatches
+	u32 failedCount = 0;
+	AssetGroup* bitmaps = GetAssetGroup(assets, Asset_Tree);
+	AssetGroup* sounds = GetAssetGroup(assets, Asset_Music);
+	if (bitmaps->onePastLastAssetIndex - bitmaps->firstAssetIndex != packCount ||
+		sounds->onePastLastAssetIndex - sounds->firstAssetIndex != packCount) {
+		printf("  %-6s %-28s OUTPUT MISMATCH\n", mode, "combined tables");
+		return 1;
+	}
+	// NOTE: Pack order in the tables follows the directory listing, packs are told apart by their sizes
+	BenchAssetPack* bitmapPacks[4] = {};
+	BenchAssetPack* soundPacks[4] = {};
+	Assert(packCount <= ArrayCount(bitmapPacks));
+	for (u32 packIndex = 0; packIndex < packCount; packIndex++) {
+		u32 bitmapId = bitmaps->firstAssetIndex + packIndex;
+		u32 soundId = sounds->firstAssetIndex + packIndex;
+		AssetFileBitmapInfo* bitmapInfo = &GetAssetMetadata(assets, GetAsset(assets, bitmapId)->metadataId)->_bitmapInfo;
+		AssetFileSoundInfo* soundInfo = &GetAssetMetadata(assets, GetAsset(assets, soundId)->metadataId)->_soundInfo;
+		for (u32 index = 0; index < packCount; index++) {
+			if (packs[index].bitmapWidth == bitmapInfo->width) {
+				bitmapPacks[packIndex] = packs + index;
+			}
+			if (packs[index].sampleCount == soundInfo->sampleCount) {
+				soundPacks[packIndex] = packs + index;
+			}
+		}
+		bool tableMatches = bitmapPacks[packIndex] && soundPacks[packIndex] &&
+			bitmapInfo->dataOffset == bitmapPacks[packIndex]->bitmapOffset &&
+			bitmapInfo->compressedSize == 0 &&
+			soundInfo->samplesOffset[0] == soundPacks[packIndex]->soundOffset &&
+			soundInfo->samplesOffset[1] == soundPacks[packIndex]->soundOffset + soundPacks[packIndex]->soundSize / 2 &&
+			soundInfo->compressedSize == 0 && soundInfo->payloadFilter == AssetPayloadFilter_None;
+		if (!tableMatches) {
+			printf("  %-6s %-28s OUTPUT MISMATCH\n", mode, "combined tables");
+			return 1;
+		}
+		PrefetchBitmap(assets, BitmapId{ bitmapId }, false);
+		PrefetchSound(assets, SoundId{ soundId }, false);
+	}
+
+	u64 startTime = LinuxGetCurrentTimestamp();
+	bool pending = true;
+	while (pending && LinuxCalculateTimeElapsed(startTime, LinuxGetCurrentTimestamp()) < 10.f) {
+		UpdateAssetLoads(assets);
+		pending = false;
+		for (u32 packIndex = 0; packIndex < packCount; packIndex++) {
+			pending |= GetAsset(assets, bitmaps->firstAssetIndex + packIndex)->state == AssetState_Pending;
+			pending |= GetAsset(assets, sounds->firstAssetIndex + packIndex)->state == AssetState_Pending;
+		}
+	}
+	for (u32 packIndex = 0; packIndex < packCount; packIndex++) {
+		Asset* bitmap = GetAsset(assets, bitmaps->firstAssetIndex + packIndex);
+		Asset* sound = GetAsset(assets, sounds->firstAssetIndex + packIndex);
+		bool bitmapMatches = bitmap->state == AssetState_Ready &&
+			memcmp(bitmap->memory->bitmap.data, bitmapPacks[packIndex]->texels, bitmapPacks[packIndex]->bitmapSize) == 0;
+		bool soundMatches = sound->state == AssetState_Ready &&
+			memcmp(sound->memory->sound.samples[0], soundPacks[packIndex]->samples, soundPacks[packIndex]->soundSize) == 0;
+		printf("  %-6s version %u bitmap at %#11" PRIx64 " %s\n", mode, bitmapPacks[packIndex]->version,
+			bitmapPacks[packIndex]->bitmapOffset, bitmapMatches ? "ok" : "OUTPUT MISMATCH");
+		printf("  %-6s version %u sound at  %#11" PRIx64 " %s\n", mode, soundPacks[packIndex]->version,
+			soundPacks[packIndex]->soundOffset, soundMatches ? "ok" : "OUTPUT MISMATCH");
+		failedCount += !bitmapMatches + !soundMatches;
+	}
+	return failedCount;
+}
+
+internal
+void BenchLargeAssetPack(PlatformQueue* queue) {
+	// NOTE: Packs go through the engine's loader: table reads, validation, merge into the combined tables
+	// and prefetches. Version 4 pack is over 4GB with a bitmap across the 4GB mark and a sound past it,
+	// version 1 pack has 32 bit offsets high enough to break if they were widened as signed
+	BenchAssetPack packs[2] = {};
+	packs[0].name = "large";
+	packs[0].version = EAF_VERSION;
+	packs[0].bitmapWidth = 256;
+	packs[0].bitmapHeight = 64;
+	packs[0].sampleCount = 4096;
+	packs[0].bitmapOffset = (u64(1) << 32) - 256 * 64 * BITMAP_BYTES_PER_PIXEL / 2;
+	packs[0].soundOffset = (u64(1) << 32) + MB(512) + 4;
+	packs[1].name = "legacy";
+	packs[1].version = 1;
+	packs[1].bitmapWidth = 128;
+	packs[1].bitmapHeight = 32;
+	packs[1].sampleCount = 2048;
+	packs[1].bitmapOffset = u64(0xC0000000);
+	packs[1].soundOffset = u64(0xF0000000) + 4;
+
+	char directory[] = "/tmp/assf_large_XXXXXX";
+	if (!mkdtemp(directory)) {
+		printf("large asset pack: can't create temporary directory\n");
+		return;
+	}
+	BenchRandom random = { 0x4B1D5EED };
+	bool written = true;
+	for (u32 packIndex = 0; packIndex < ArrayCount(packs); packIndex++) {
+		written = BenchWriteAssetPack(directory, packs[packIndex], random) && written;
+	}
+	printf("large asset pack, sparse version %u pack of %.2fGB and version 1 pack of %.2fGB\n", packs[0].version,
+		f64(packs[0].soundOffset + packs[0].soundSize) / f64(GB(1)), f64(packs[1].soundOffset + packs[1].soundSize) / f64(GB(1)));
+
+	u32 failedCount = 0;
+	const char* modeNames[] = { "reads", "mapped" };
+	for (u32 mode = 0; written && mode < ArrayCount(modeNames); mode++) {
+		AssetMemoryConfig config = {};
+		config.initialSize = MB(2);
+		config.maxSize = MB(2);
+		config.mapFiles = mode == 1;
+		TransientState* tranState = BenchBeginAssets(queue, MB(4));
+		if (BenchAllocateAssets(tranState, directory, config)) {
+			failedCount += BenchCheckAssetPacks(tranState->assets, packs, ArrayCount(packs), modeNames[mode]);
+		}
+		else {
+			failedCount++;
+		}
+		BenchEndAssets(tranState);
+	}
+	printf("  %s\n", !written ? "can't write the packs" : failedCount ? "FAILED" : "all payloads match");
+
+	char path[64];
+	for (u32 packIndex = 0; packIndex < ArrayCount(packs); packIndex++) {
+		snprintf(path, sizeof(path), "%s/%s.assf", directory, packs[packIndex].name);
+		unlink(path);
+		LinuxFreeMemory(packs[packIndex].texels);
+		LinuxFreeMemory(packs[packIndex].samples);
+	}
+	rmdir(directory);
+}
+
+internal
+bool LinuxRunBench(const char* name, PlatformQueue* queue) {
+	if (strcmp(name, "tiles") == 0) {
+		BenchTiledRenderer(queue);
+		return true;
+	}
+	if (strcmp(name, "overdraw") == 0) {
+		BenchOverdraw(queue);
+		return true;
+	}
+	if (strcmp(name, "kernels") == 0) {
+		BenchKernels();
+		return true;
+	}
+	if (strcmp(name, "blit") == 0) {
+		BenchBlit();
+		return true;
+	}
+	if (strcmp(name, "srgb") == 0) {
+		BenchSRGB();
+		return true;
+	}
+	if (strcmp(name, "mips") == 0) {
+		BenchMips();
+		return true;
+	}
+	if (strcmp(name, "tiled") == 0) {
+		BenchTiledTextures();
+		return true;
+	}
+	if (strcmp(name, "assets") == 0) {
+		BenchAssetToc(queue);
+		return true;
+	}
+	if (strcmp(name, "lz") == 0) {
+		BenchLZ();
+		return true;
+	}
+	if (strcmp(name, "largepack") == 0) {
+		BenchLargeAssetPack(queue);
+		return true;
+	}
+	if (strcmp(name, "sort") == 0) {
+		BenchSort(queue);
+		return true;
+	}
+	if (strcmp(name, "batching") == 0) {
+		BenchBatching();
+		return true;
+	}
+	fprintf(stderr, "Unknown bench: %s (available: tiles, overdraw, kernels, blit, srgb, mips, tiled, assets, lz, largepack, sort, batching)\n", name);
+	return false;
+}
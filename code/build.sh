@@ -0,0 +1,25 @@
+#!/bin/bash
+# Headless linux build: engine as shared library + linux platform layer
+# NOTE: code generator and asset composer are windows only, engine_meta.cpp and .assf files are taken from windows build
+set -e
+cd "$(dirname "$0")"
+mkdir -p ../build
+
+CXX=${CXX:-g++}
+# NOTE: -ffp-contract=off keeps every renderer kernel variant bit exact, otherwise FMA is fused only in the wider ones
+CompilerFlags="-std=c++20 -O2 -g -fno-rtti -fno-exceptions -ffp-contract=off"
+CompilerFlags="-DINTERNAL_BUILD=1 -DSLOW_VALIDATION=1 $CompilerFlags"
+# NOTE: Warnings match -W4 -wd4100 -wd4189 -wd4505 of build.bat, which doesn't report MSVC pragmas and unhandled enum cases either
+CompilerFlags="$CompilerFlags -Wall -Wno-unused-parameter -Wno-unused-variable -Wno-unused-but-set-variable -Wno-unused-function"
+CompilerFlags="$CompilerFlags -Wno-unknown-pragmas -Wno-switch"
+# NOTE: Types are punned through pointers like under MSVC
+CompilerFlags="$CompilerFlags -fno-strict-aliasing"
+# NOTE: Sound mixer is AVX2 only, platform layer picks renderer kernels at runtime so it runs on plain x64
+EngineFlags="-mavx2 -mfma"
+
+pushd ../build > /dev/null
+  echo "$(pwd)"
+  # Platform layer + game code
+  $CXX $CompilerFlags $EngineFlags -fPIC -shared ../code/engine.cpp -o engine.so
+  $CXX $CompilerFlags ../code/linux_main.cpp -o linux_main -ldl -lpthread
+popd > /dev/null
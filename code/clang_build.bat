@@ -22,8 +22,10 @@ set WIN_LIB_FLAGS=%WIN_LIB_FLAGS% -L"%VS_SDK_DIR%\Lib\%VS_SDK_VERSION%\ucrt\x64"
 set PATH=%MSVC_TOOLS_PATH%;%PATH%
 
 set ClangExe= D:\Compilers\LLVM\bin\clang++.exe
-REM remove -march=native when macros are introduced to SIMD!!!
-set CompilerFlags= -O3 -march=native -fuse-ld=lld -std=c++23 -g -gcodeview -fms-runtime-lib=static_dbg
+REM Software renderer kernels are picked at runtime, only the engine (AVX2 sound mixer) is built for the host cpu
+REM -ffp-contract=off keeps every kernel variant bit exact, otherwise FMA is fused only in the wider ones
+set CompilerFlags= -O3 -fuse-ld=lld -std=c++23 -g -gcodeview -fms-runtime-lib=static_dbg -ffp-contract=off
+set EngineFlags= -march=native
 set CompilerFlags= -DINTERNAL_BUILD=0 -DSLOW_VALIDATION=0 %CompilerFlags%
 set LinkerFlags= %WIN_LIB_FLAGS% -l user32 -l gdi32 -l ole32 -l winmm
 set DllExports=-Xlinker /export:GameMainLoopFrame -Xlinker /export:GameFillSoundBuffer -Xlinker /export:DebugInit -Xlinker /export:DebugFinishFrame
@@ -31,7 +33,7 @@ pushd ..\build
   echo %cd%
   del *.pdb > NUL 2> NUL
   REM %ClangExe% %CompilerFlags% -S ..\code\engine.cpp -- -S for assembly => for optimization
-  %ClangExe% %CompilerFlags% ..\code\engine_optimized.cpp -c -o engine_optimized.obj -Wunused-command-line-argument
-  %ClangExe% %CompilerFlags% ..\code\engine.cpp engine_optimized.obj -shared -o engine.dll %WIN_LIB_FLAGS% %DllExports% -Xlinker /pdb:engine%random%.pdb 
+  %ClangExe% %CompilerFlags% %EngineFlags% ..\code\engine_optimized.cpp -c -o engine_optimized.obj -Wunused-command-line-argument
+  %ClangExe% %CompilerFlags% %EngineFlags% ..\code\engine.cpp engine_optimized.obj -shared -o engine.dll %WIN_LIB_FLAGS% %DllExports% -Xlinker /pdb:engine%random%.pdb 
   %ClangExe% %CompilerFlags% ..\code\win32_main.cpp -o win32_main.exe -Wl,%LinkerFlags%
 popd
\ No newline at end of file
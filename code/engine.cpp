@@ -5,6 +5,7 @@
 #include "engine_rand.cpp"
 #include "engine_assets.cpp"
 #include "engine_render.cpp"
+#include "renderer_software.cpp"
 
 PlatformAPI* Platform;
 
@@ -177,6 +178,10 @@ void RenderHitPoints(RenderGroup& group, Entity& entity, V3 center, V2 offset, f
 	}
 }
 
+#define GROUND_DECALS_PER_CHUNK 100
+#define GROUND_REFILL_DELAY_FRAMES 30
+#define GROUND_CLEAR_COLOR V4{ 0.2f, 0.2f, 0.2f, 1.f }
+
 struct FillGroundBufferTaskArgs {
 	TaskWithMemory* task;
 	WorldPosition chunkPos;
@@ -185,37 +190,40 @@ struct FillGroundBufferTaskArgs {
 	GroundBuffer* groundBuffer;
 };
 
-#if 0
 internal
 void FillGroundBufferBackgroundTask(void* data) {
 	TIMED_FUNCTION;
 	FillGroundBufferTaskArgs* args = ptrcast(FillGroundBufferTaskArgs, data);
 	TaskWithMemory* task = args->task;
 	LoadedBitmap* buffer = &args->groundBuffer->buffer;
-	RenderGroup group = AllocateRenderGroup(task->arena, args->assets, u4(GetArenaFreeSpaceSize(task->arena) * 0.5f), true);
-	BeginRendering(group);
+
+	// NOTE: Decals of the neighbour chunks are rendered too, so the ones crossing chunk borders are seamless
+	u32 maxCommandCount = 9 * GROUND_DECALS_PER_CHUNK + 1;
+	RenderCommandBuffer commands = {};
+	commands.maxPushBufferSize = maxCommandCount * (sizeof(RenderCallHeader) + sizeof(RenderCallBitmap) + sizeof(SortElement));
+	commands.pushBuffer = PushArray(task->arena, commands.maxPushBufferSize, u8);
+	commands.sortBufferAt = commands.maxPushBufferSize;
+	commands.sortTempBuffer = PushArray(task->arena, maxCommandCount, SortElement);
+
+	RenderGroup group = BeginRendering(&commands, args->assets, true);
 	f32 width = args->chunkSizeInMeters.X;
 	f32 height = args->chunkSizeInMeters.Y;
 	Assert(width == height);
 	f32 metersToPixels = (buffer->width - 2) / width;
 	group.projection = GetOrtographicProjection(buffer->width, buffer->height, metersToPixels);
-	PushClearCall(group, V4{ 1, 0, 1, 1 });
+	PushClearCall(group, GROUND_CLEAR_COLOR);
+	u32 skippedDecalCount = 0;
 	for (i32 chunkOffsetY = -1; chunkOffsetY <= 1; chunkOffsetY++) {
 		for (i32 chunkOffsetX = -1; chunkOffsetX <= 1; chunkOffsetX++) {
 			i32 chunkX = args->chunkPos.chunkX + chunkOffsetX;
 			i32 chunkY = args->chunkPos.chunkY + chunkOffsetY;
 			i32 chunkZ = args->chunkPos.chunkZ;
-#if 0
-			V4 color = V4{ 1, 0, 0, 1 };
-			if (((chunkX % 2) == 1 && (chunkY % 2) == 1) || (((chunkX % 2) == 0) && ((chunkY % 2) == 0))) {
-				color = V4{ 0, 1, 1, 1 };
-			}
-#else
 			V4 color = { 1, 1, 1, 1 };
-#endif
 			u32 seed = 313 * chunkX + 217 * chunkY + 177 * chunkZ;
 			RandomSeries series = RandomSeed(seed);
-			for (u32 bmpIndex = 0; bmpIndex < 100;) {
+			// NOTE: Decal whose bitmap isn't loaded yet is skipped, but the series still advances, so
+			// the refilled chunk and its neighbours see the same decals
+			for (u32 bmpIndex = 0; bmpIndex < GROUND_DECALS_PER_CHUNK; bmpIndex++) {
 				V3 position = V3{
 					RandomBilateral(series) * 0.5f * width,
 					RandomBilateral(series) * 0.5f * height,
@@ -225,41 +233,174 @@ void FillGroundBufferBackgroundTask(void* data) {
 				BitmapId bid = grass ?
 					GetRandomBitmapId(*args->assets, Asset_Grass, series) :
 					GetRandomBitmapId(*args->assets, Asset_Ground, series);
+				if (!IsValid(bid)) {
+					continue;
+				}
 				position.X += chunkOffsetX * width;
 				position.Y += chunkOffsetY * height;
-				bool pushed = PushBitmap(group, ScaledFlatTransform(1.7f), bid, position, color);
-				if (pushed) {
-					bmpIndex++;
+				if (!PushBitmap(group, ScaledFlatTransform(1.7f), bid, position, color)) {
+					skippedDecalCount++;
 				}
 			}
 		}
 	}
-	RenderGroupToBuffer(group, *buffer, args->task->arena);
+	SortRenderCommands(&commands);
+	SoftwareRenderCommandsToBuffer(&commands, *buffer);
 	EndRendering(group);
+	// NOTE: Hardware renderer draws the chunk from its own copy of the texels
+	if (buffer->textureHandle) {
+		Platform->TextureFree(buffer->textureHandle);
+	}
+	u32 textureHandle = Platform->TextureAllocate(buffer->data, buffer->width, buffer->height);
+	AtomicExchangeU32(&buffer->textureHandle, textureHandle);
+	args->groundBuffer->incomplete = skippedDecalCount > 0;
 	WriteCompilatorFence;
 	args->groundBuffer->state = GroundBufferState::Ready;
 	EndBackgroundTask(task);
 }
 
+inline
+u32 GetGroundBufferHashSlot(TransientState* tranState, WorldPosition& chunkPos) {
+	static_assert((ArrayCount(tranState->groundBufferHash) & (ArrayCount(tranState->groundBufferHash) - 1)) == 0 &&
+					"hashValue is ANDed with a mask based with assert that the size of groundBufferHash is power of two");
+	u32 hashValue = 2767 * chunkPos.chunkX + 4517 * chunkPos.chunkY + 5099 * chunkPos.chunkZ;
+	hashValue &= ArrayCount(tranState->groundBufferHash) - 1;
+	return hashValue;
+}
+
+// NOTE: Incomplete chunk stays hashed while it is refilled into another buffer. Newer buffers are
+// nearer the head, so the newest ready buffer is preferred and the newest pending one is the fallback
+internal
+GroundBuffer* FindGroundBuffer(TransientState* tranState, WorldPosition& chunkPos) {
+	GroundBuffer* result = 0;
+	GroundBuffer* groundBuffer = tranState->groundBufferHash[GetGroundBufferHashSlot(tranState, chunkPos)];
+	while (groundBuffer) {
+		if (groundBuffer->pos.chunkX == chunkPos.chunkX &&
+			groundBuffer->pos.chunkY == chunkPos.chunkY &&
+			groundBuffer->pos.chunkZ == chunkPos.chunkZ)
+		{
+			if (!result) {
+				result = groundBuffer;
+			}
+			if (groundBuffer->state == GroundBufferState::Ready) {
+				result = groundBuffer;
+				break;
+			}
+		}
+		groundBuffer = groundBuffer->nextInHash;
+	}
+	return result;
+}
+
+internal
+void RemoveGroundBufferFromHash(TransientState* tranState, GroundBuffer* groundBuffer) {
+	if (!IsValid(groundBuffer->pos)) {
+		return;
+	}
+	GroundBuffer** slot = tranState->groundBufferHash + GetGroundBufferHashSlot(tranState, groundBuffer->pos);
+	while (*slot) {
+		if (*slot == groundBuffer) {
+			*slot = groundBuffer->nextInHash;
+			break;
+		}
+		slot = &(*slot)->nextInHash;
+	}
+	groundBuffer->nextInHash = 0;
+	groundBuffer->pos = NullPosition();
+}
+
+inline
+void TouchGroundBuffer(TransientState* tranState, GroundBuffer* groundBuffer) {
+	DLINKED_LIST_REMOVE(groundBuffer);
+	DLINKED_LIST_ADD(&tranState->groundBufferSentinel, groundBuffer);
+	groundBuffer->lastUsedFrame = tranState->groundFrameIndex;
+}
+
+internal
+GroundBuffer* GetLeastRecentlyUsedGroundBuffer(TransientState* tranState) {
+	// NOTE: Platform might still rasterize previous frame, which could have drawn the buffer
+	GroundBuffer* sentinel = &tranState->groundBufferSentinel;
+	for (GroundBuffer* groundBuffer = sentinel->prev; groundBuffer != sentinel; groundBuffer = groundBuffer->prev) {
+		switch (groundBuffer->state) {
+		case GroundBufferState::NotReady: {
+			return groundBuffer;
+		} break;
+		case GroundBufferState::Ready: {
+			if (tranState->groundFrameIndex - groundBuffer->lastUsedFrame > 1) {
+				return groundBuffer;
+			}
+		} break;
+		}
+	}
+	return 0;
+}
+
 internal
-bool FillGroundBuffer(TransientState* tranState, ProgramState* state, GroundBuffer& dstBuffer, WorldPosition& chunkPos, PlatformQueue* queue) {
+bool FillGroundBuffer(TransientState* tranState, ProgramState* state, WorldPosition& chunkPos, PlatformQueue* queue) {
+	GroundBuffer* dstBuffer = GetLeastRecentlyUsedGroundBuffer(tranState);
+	if (!dstBuffer) {
+		return false;
+	}
 	TaskWithMemory* task = TryBeginBackgroundTask(tranState);
-	if (!task || dstBuffer.state == GroundBufferState::Pending) {
+	if (!task) {
 		return false;
 	}
+	RemoveGroundBufferFromHash(tranState, dstBuffer);
+	dstBuffer->pos = chunkPos;
+	dstBuffer->state = GroundBufferState::Pending;
+	dstBuffer->filledFrame = tranState->groundFrameIndex;
+	dstBuffer->incomplete = false;
+	u32 slot = GetGroundBufferHashSlot(tranState, chunkPos);
+	dstBuffer->nextInHash = tranState->groundBufferHash[slot];
+	tranState->groundBufferHash[slot] = dstBuffer;
+	TouchGroundBuffer(tranState, dstBuffer);
+
 	FillGroundBufferTaskArgs* args = PushStructSize(task->arena, FillGroundBufferTaskArgs);
 	args->chunkPos = chunkPos;
 	args->chunkSizeInMeters = state->world.chunkSizeInMeters.XY;
 	args->assets = &tranState->assets;
-	args->groundBuffer = &dstBuffer;
+	args->groundBuffer = dstBuffer;
 	args->task = task;
-	dstBuffer.pos = chunkPos;
-	dstBuffer.state = GroundBufferState::Pending;
 	WriteCompilatorFence;
-	Platform->QueuePushTask(queue, FillGroundBufferBackgroundTask, args);
+	Platform->QueuePushTask(queue, FillGroundBufferBackgroundTask, args, 0);
 	return true;
 }
-#endif
+
+internal
+void PushGroundChunks(RenderGroup& group, TransientState* tranState, ProgramState* state, Rect2 playerView) {
+	TIMED_FUNCTION;
+	World& world = state->world;
+	tranState->groundFrameIndex++;
+	Rect3 groundChunkBounds = ToRect3(playerView, V2{ 0, 0 });
+	WorldPosition minChunk = OffsetWorldPosition(world, state->cameraPos, GetMinCorner(groundChunkBounds));
+	WorldPosition maxChunk = OffsetWorldPosition(world, state->cameraPos, GetMaxCorner(groundChunkBounds));
+	for (i32 chunkY = minChunk.chunkY; chunkY <= maxChunk.chunkY; chunkY++) {
+		for (i32 chunkX = minChunk.chunkX; chunkX <= maxChunk.chunkX; chunkX++) {
+			i32 chunkZ = state->cameraPos.chunkZ;
+			WorldPosition chunkPos = CenteredWorldPosition(chunkX, chunkY, chunkZ);
+			GroundBuffer* drawBuffer = FindGroundBuffer(tranState, chunkPos);
+			if (!drawBuffer) {
+				// NOTE: Chunk is missing until its task finishes, when all tasks are busy it is retried next frame
+				FillGroundBuffer(tranState, state, chunkPos, tranState->lowPriorityQueue);
+				continue;
+			}
+			TouchGroundBuffer(tranState, drawBuffer);
+			if (drawBuffer->state == GroundBufferState::Ready) {
+				V3 diff = Subtract(world, drawBuffer->pos, state->cameraPos);
+				diff -= ToV3(0.5f * world.chunkSizeInMeters.XY, 0);
+				PushBitmap(group, &drawBuffer->buffer, ScaledFlatTransform(world.chunkSizeInMeters.Y), diff);
+				// NOTE: Incomplete chunk is drawn until its refill is ready. Retries are spaced out,
+				// so a bitmap which can't be loaded doesn't keep a task busy every frame
+				if (drawBuffer->incomplete &&
+					tranState->groundFrameIndex - drawBuffer->filledFrame > GROUND_REFILL_DELAY_FRAMES &&
+					FillGroundBuffer(tranState, state, chunkPos, tranState->lowPriorityQueue))
+				{
+					drawBuffer->incomplete = false;
+				}
+			}
+		}
+	}
+}
 
 inline
 V2 ToBottomUpAlignment(LoadedBitmap& bitmap, V2 topDownAlign) {
@@ -545,6 +686,163 @@ void SetEntityGroundLevel(Entity& entity, f32 newGroundLevel) {
 	entity.pos.Z = newGroundLevel + 0.5f * entity.collision->totalVolume.size.Z;
 }
 
+inline
+f32 GetLayerAlpha(World& world, f32 groundLevelZ) {
+	// NOTE: Entities fade out above the camera floor and a few floors below it
+	f32 fadeUpStartZ = 0.f * world.tileSizeInMeters.Z;
+	f32 fadeUpEndZ = 0.3f * world.tileSizeInMeters.Z;
+	f32 fadeDownStartZ = -3.1f * world.tileSizeInMeters.Z;
+	f32 fadeDownEndZ = -3.4f * world.tileSizeInMeters.Z;
+	f32 layerAlpha = 1.0f;
+	if (groundLevelZ > fadeUpStartZ) {
+		f32 range = fadeUpEndZ - fadeUpStartZ;
+		f32 Z = groundLevelZ - fadeUpStartZ;
+		layerAlpha = 1.0f - Clip01(Z / range);
+	}
+	else if (groundLevelZ < fadeDownStartZ) {
+		f32 range = fadeDownEndZ - fadeDownStartZ;
+		f32 Z = groundLevelZ - fadeDownStartZ;
+		layerAlpha = 1.0f - Clip01(Z / range);
+	}
+	return layerAlpha;
+}
+
+internal
+RetainedRenderCommand* AddRetainedRenderCommand(World& world, WorldChunk* chunk) {
+	RetainedRenderBlock* block = chunk->renderBlocks;
+	if (!block || block->commandCount == ArrayCount(block->commands)) {
+		if (world.freeRenderBlockList) {
+			block = world.freeRenderBlockList;
+			world.freeRenderBlockList = block->next;
+		}
+		else {
+			block = PushStructSize(world.arena, RetainedRenderBlock);
+		}
+		block->commandCount = 0;
+		block->next = chunk->renderBlocks;
+		chunk->renderBlocks = block;
+	}
+	return block->commands + block->commandCount++;
+}
+
+internal
+void RetainRect(World& world, WorldChunk* chunk, Projection& projection, Entity& entity, ObjectTransform transform,
+	V3 center, V2 size, V4 color)
+{
+	RetainedRenderCommand command = {};
+	if (!ProjectRetainedRenderCommand(projection, command, transform, center, size)) {
+		return;
+	}
+	command.type = RenderCallType_RenderCallRectangle;
+	command.translucent = color.A < 1.f;
+	command.entityOffset = entity.worldPos.offset;
+	command.color = color;
+	*AddRetainedRenderCommand(world, chunk) = command;
+}
+
+internal
+void RetainRectBorders(World& world, WorldChunk* chunk, Projection& projection, Entity& entity, ObjectTransform transform,
+	V3 center, V2 size, V4 color, f32 thickness)
+{
+	V3 basePos = center;
+	basePos.X = center.X - 0.5f * size.X;
+	RetainRect(world, chunk, projection, entity, transform, basePos, V2{ thickness, size.Y }, color);
+	basePos.X = center.X + 0.5f * size.X;
+	RetainRect(world, chunk, projection, entity, transform, basePos, V2{ thickness, size.Y }, color);
+	basePos = center;
+	basePos.Y = center.Y - 0.5f * size.Y;
+	RetainRect(world, chunk, projection, entity, transform, basePos, V2{ size.X, thickness }, color);
+	basePos.Y = center.Y + 0.5f * size.Y;
+	RetainRect(world, chunk, projection, entity, transform, basePos, V2{ size.X, thickness }, color);
+}
+
+internal
+void RetainBitmap(World& world, WorldChunk* chunk, Projection& projection, Entity& entity, ObjectTransform transform,
+	BitmapId bid, V3 center, V4 color)
+{
+	RetainedRenderCommand command = {};
+	if (!ProjectRetainedRenderCommand(projection, command, transform, center, V2{ 0.f, transform.scale })) {
+		return;
+	}
+	command.type = RenderCallType_RenderCallBitmap;
+	command.translucent = color.A < 1.f;
+	command.bitmap = bid;
+	command.entityOffset = entity.worldPos.offset;
+	command.color = color;
+	*AddRetainedRenderCommand(world, chunk) = command;
+}
+
+internal
+void BuildChunkRenderBlocks(World& world, Assets& assets, WorldChunk* chunk, Projection& projection, RetainedRenderKey& key) {
+	TIMED_FUNCTION;
+	while (chunk->renderBlocks) {
+		RetainedRenderBlock* block = chunk->renderBlocks;
+		chunk->renderBlocks = block->next;
+		block->next = world.freeRenderBlockList;
+		world.freeRenderBlockList = block;
+	}
+	for (LowEntityBlock* entities = chunk->entities; entities; entities = entities->next) {
+		for (u32 index = 0; index < entities->entityCount; index++) {
+			EntityStorage* storage = GetEntityStorage(world, entities->entityIndexes[index]);
+			Entity& entity = storage->entity;
+			if (!IsStaticEntity(entity)) {
+				continue;
+			}
+			// NOTE: Chunk origin is under the camera, so X, Y are the offset inside of the chunk
+			V3 offset = entity.worldPos.offset;
+			V3 groundLevelPos = V3{ offset.X, offset.Y, key.chunkZ + offset.Z - 0.5f * entity.collision->totalVolume.size.Z };
+			f32 layerAlpha = GetLayerAlpha(world, groundLevelPos.Z);
+			switch (entity.type) {
+			case EntityType_Wall: {
+				const f32 treeHeight = 2.5f * world.tileSizeInMeters.Z;
+				AssetFeatures match = {};
+				AssetFeatures weight = {};
+				match[Feature_Height] = 2.5f;
+				weight[Feature_Height] = 1.f;
+				BitmapId bid = GetBestFitBitmapId(assets, Asset_Tree, match, weight, 10000);
+				RetainBitmap(world, chunk, projection, entity, ScaledUprightTransform(treeHeight), bid, groundLevelPos,
+					V4{ 1, 0.f, 1.f, layerAlpha });
+			} break;
+			case EntityType_Stairs: {
+				V2 size = entity.collision->totalVolume.size.XY;
+				RetainRect(world, chunk, projection, entity, DefaultUprightTransform(), groundLevelPos, size,
+					V4{ 0.1f, 0.1f, 0.1f, layerAlpha });
+				RetainRectBorders(world, chunk, projection, entity, DefaultUprightTransform(),
+					groundLevelPos + V3{ 0, 0, entity.walkableDim.Z }, size, V4{ 0, 0, 0, layerAlpha }, 0.1f);
+			} break;
+			case EntityType_Space: {
+				RetainRectBorders(world, chunk, projection, entity, DefaultUprightTransform(), groundLevelPos,
+					entity.collision->totalVolume.size.XY, V4{ 0, 0, 1, layerAlpha }, 0.2f);
+			} break;
+			InvalidDefaultCase;
+			}
+		}
+	}
+	chunk->renderKey = key;
+	chunk->renderBlocksValid = true;
+}
+
+internal
+void PushStaticEntities(RenderGroup& group, World& world, Assets& assets, SimRegion& simRegion) {
+	// NOTE: Static entities are spliced in from the retained commands of the chunks instead of being
+	// pushed from the sim region, but only the ones which the sim region holds
+	TIMED_FUNCTION;
+	WorldPosition& origin = simRegion.origin;
+	for (u32 chunkIndex = 0; chunkIndex < simRegion.chunkCount; chunkIndex++) {
+		WorldChunk* chunk = simRegion.chunks[chunkIndex];
+		V3 chunkPos = {
+			f4(chunk->chunkX - origin.chunkX) * world.chunkSizeInMeters.X - origin.offset.X,
+			f4(chunk->chunkY - origin.chunkY) * world.chunkSizeInMeters.Y - origin.offset.Y,
+			f4(chunk->chunkZ - origin.chunkZ) * world.chunkSizeInMeters.Z - origin.offset.Z
+		};
+		RetainedRenderKey key = GetRetainedRenderKey(group.projection, chunkPos.Z);
+		if (!chunk->renderBlocksValid || !AreRetainedRenderKeysEqual(chunk->renderKey, key)) {
+			BuildChunkRenderBlocks(world, assets, chunk, group.projection, key);
+		}
+		SpliceRetainedRenderCommands(group, chunk->renderBlocks, chunkPos, simRegion.bounds);
+	}
+}
+
 internal
 void HandleOverlap(World& world, Entity& mover, Entity& obstacle, f32* ground) {
 	if (mover.type == EntityType_Player && obstacle.type == EntityType_Stairs) {
@@ -608,8 +906,8 @@ bool HandleCollision(World& world, Entity& mover, Entity& obstacle) {
 			GetRectFromCenterDim(obstacle.pos, obstacle.walkableDim), 
 			mover.pos
 		);
-		if (normMoverPos.Z < 0.5f && normMoverPos.Y < 0.1f ||
-			normMoverPos.Z >= 0.5f && normMoverPos.Y >= 0.9f) {
+		if ((normMoverPos.Z < 0.5f && normMoverPos.Y < 0.1f) ||
+			(normMoverPos.Z >= 0.5f && normMoverPos.Y >= 0.9f)) {
 			stopOnCollide = false;
 		}
 		else {
@@ -995,6 +1293,8 @@ extern "C" GAME_MAIN_LOOP_FRAME(GameMainLoopFrame) {
 	{DEBUG_DATA_BLOCK("Camera");
 		DEBUG_DATA(DEBUG_Camera_Zoomout);
 		DEBUG_DATA(DEBUG_Camera_ZoomoutValue);}
+	{DEBUG_DATA_BLOCK("Assets");
+		DEBUG_DATA(DEBUG_Assets_TiledBitmaps);}
 	{DEBUG_DATA_BLOCK("Profiler");
 		DEBUG_DATA(DEBUG_Profiler_Memory);
 		DEBUG_DATA(DEBUG_Profiler_Cpu);
@@ -1163,7 +1463,7 @@ extern "C" GAME_MAIN_LOOP_FRAME(GameMainLoopFrame) {
 		tranState->highPriorityQueue = memory.highPriorityQueue;
 		tranState->lowPriorityQueue = memory.lowPriorityQueue;
 
-		AllocateAssets(tranState);
+		AllocateAssets(tranState, memory.assetMemoryConfig);
 		for (u32 taskIndex = 0; taskIndex < ArrayCount(tranState->tasks); taskIndex++) {
 			TaskWithMemory* task = tranState->tasks + taskIndex;
 			SubArena(task->arena, tranState->arena, MB(4));
@@ -1171,19 +1471,31 @@ extern "C" GAME_MAIN_LOOP_FRAME(GameMainLoopFrame) {
 		}
 		PlaySound(state->audio, tranState->assets, GetFirstSoundIdWithType(tranState->assets, Asset_Music), 0);
 
+		// NOTE: Ground buffers are rasterized by the engine itself
+		InitializeSoftwareRenderer(GetCpuSimdLevel());
+		DLINKED_LIST_INIT(&tranState->groundBufferSentinel);
 		for (u32 groundBufferIndex = 0; groundBufferIndex < ArrayCount(tranState->groundBuffers); groundBufferIndex++) {
 			GroundBuffer* groundBuffer = tranState->groundBuffers + groundBufferIndex;
 			groundBuffer->buffer = MakeEmptyBuffer(tranState->arena, 256, 256);
+			// NOTE: Cleared with opaque color, so chunks occlude everything below them
+			groundBuffer->buffer.flags = LoadedBitmap_Opaque | LoadedBitmap_AlphaTested;
 			groundBuffer->pos = NullPosition();
 			groundBuffer->state = GroundBufferState::NotReady;
+			DLINKED_LIST_ADD(&tranState->groundBufferSentinel, groundBuffer);
 		}
 		tranState->isInitialized = true;
 	}
+	ReleaseRenderCommandsGenerations(renderCommands, &tranState->assets);
 
 	if (memory.executableReloaded) {
+		// NOTE: Software renderer globals live in the executable, and chunks are refilled by the new code
+		InitializeSoftwareRenderer(GetCpuSimdLevel());
 		for (u32 groundBufferIndex = 0; groundBufferIndex < ArrayCount(tranState->groundBuffers); groundBufferIndex++) {
 			GroundBuffer* groundBuffer = tranState->groundBuffers + groundBufferIndex;
-			groundBuffer->pos = NullPosition();
+			if (groundBuffer->state != GroundBufferState::Pending) {
+				RemoveGroundBufferFromHash(tranState, groundBuffer);
+				groundBuffer->state = GroundBufferState::NotReady;
+			}
 		}
 	}
 
@@ -1299,56 +1611,7 @@ extern "C" GAME_MAIN_LOOP_FRAME(GameMainLoopFrame) {
 	Rect2 playerView = GetRenderRectangleAtDistance(renderGroup.projection, bitmapWidth, bitmapHeight, originalCameraDistance);
 	PushClearCall(renderGroup, V4{ 0.2f, 0.2f, 0.2f, 1.f });
 
-#if 0
-	Rect3 groundChunkBounds = ToRect3(playerView, V2{0, 0});
-	WorldPosition minChunk = OffsetWorldPosition(world, state->cameraPos, GetMinCorner(groundChunkBounds));
-	WorldPosition maxChunk = OffsetWorldPosition(world, state->cameraPos, GetMaxCorner(groundChunkBounds));
-	for (i32 chunkY = minChunk.chunkY; chunkY <= maxChunk.chunkY; chunkY++) {
-		for (i32 chunkX = minChunk.chunkX; chunkX <= maxChunk.chunkX; chunkX++) {
-			i32 chunkZ = state->cameraPos.chunkZ;
-
-			GroundBuffer* furthestBuffer = 0;
-			f32 furthestDistanceSq = 0;
-			GroundBuffer* drawBuffer = 0;
-			for (u32 groundBufferIndex = 0; groundBufferIndex < ArrayCount(tranState->groundBuffers); groundBufferIndex++) {
-				GroundBuffer* groundBuffer = tranState->groundBuffers + groundBufferIndex;
-				if (groundBuffer->state == GroundBufferState::Pending) {
-					continue;
-				}
-				
-				if (groundBuffer->pos.chunkX == chunkX && 
-					groundBuffer->pos.chunkY == chunkY &&
-					groundBuffer->pos.chunkZ == chunkZ) 
-				{
-					drawBuffer = groundBuffer;
-					break;
-				}
-				else if (IsValid(groundBuffer->pos)) {
-					V3 diff = Subtract(world, groundBuffer->pos, state->cameraPos);
-					f32 distance = LengthSq(diff);
-					if (distance > furthestDistanceSq) {
-						furthestDistanceSq = distance;
-						furthestBuffer = groundBuffer;
-					}
-				}
-				else {
-					furthestDistanceSq = F32_MAX;
-					furthestBuffer = groundBuffer;
-				}
-			}
-			if (!drawBuffer && furthestBuffer) {
-				WorldPosition chunkPos = CenteredWorldPosition(chunkX, chunkY, chunkZ);
-				FillGroundBuffer(tranState, state, *furthestBuffer, chunkPos, tranState->lowPriorityQueue);
-				drawBuffer = furthestBuffer;
-			}
-			if (drawBuffer->state == GroundBufferState::Ready) {
-				V3 diff = Subtract(world, drawBuffer->pos, state->cameraPos);
-				diff -= ToV3(0.5f * state->world.chunkSizeInMeters.XY, 0);
-				PushBitmap(renderGroup, &drawBuffer->buffer, ScaledFlatTransform(1.f * state->world.chunkSizeInMeters.Y), diff);
-			}
-		}
-	}
-#endif
+	PushGroundChunks(renderGroup, tranState, state, playerView);
 	
 #if 0
 	for (i32 chunkY = minChunk.chunkY; chunkY <= maxChunk.chunkY; chunkY++) {
@@ -1365,10 +1628,7 @@ extern "C" GAME_MAIN_LOOP_FRAME(GameMainLoopFrame) {
 	TIMED_BLOCK_BEGIN(UpdateEntities);
 	PushRectBorders(renderGroup, DefaultUprightTransform(), V3{ 0.f, 0.f, 0.f }, GetDim(playerView), V4{ 1, 1, 0, 1 }, 0.4f);
 	PushRectBorders(renderGroup, DefaultUprightTransform(), V3{ 0.f, 0.f, 0.f }, GetDim(simBounds).XY, V4{ 1, 0, 0, 1 }, 0.4f);
-	f32 fadeUpStartZ = 0.f * state->world.tileSizeInMeters.Z;
-	f32 fadeUpEndZ = 0.3f * state->world.tileSizeInMeters.Z;
-	f32 fadeDownStartZ = -3.1f * state->world.tileSizeInMeters.Z;
-	f32 fadeDownEndZ = -3.4f * state->world.tileSizeInMeters.Z;
+	PushStaticEntities(renderGroup, world, tranState->assets, *simRegion);
 	for (u32 entityIndex = 0; entityIndex < simRegion->entityCount; entityIndex++) {
 		Entity* entity = simRegion->entities + entityIndex;
 		if (!entity) {
@@ -1376,17 +1636,7 @@ extern "C" GAME_MAIN_LOOP_FRAME(GameMainLoopFrame) {
 		}
 		V3 acceleration = V3{ 0, 0, 0 };
 		V3 groundLevelPos = GetEntityGroundLevel(*entity);
-		f32 layerAlpha = 1.0f;
-		if (groundLevelPos.Z > fadeUpStartZ) {
-			f32 range = fadeUpEndZ - fadeUpStartZ;
-			f32 Z = groundLevelPos.Z - fadeUpStartZ;
-			layerAlpha = 1.0f - Clip01(Z / range);
-		}
-		else if (groundLevelPos.Z < fadeDownStartZ) {
-			f32 range =  fadeDownEndZ - fadeDownStartZ;
-			f32 Z = groundLevelPos.Z - fadeDownStartZ;
-			layerAlpha = 1.0f - Clip01(Z / range);
-		}
+		f32 layerAlpha = GetLayerAlpha(world, groundLevelPos.Z);
 		switch(entity->type) {
 		case EntityType_Player: {
 			PlayerControls* playerControls = 0;
@@ -1409,22 +1659,10 @@ extern "C" GAME_MAIN_LOOP_FRAME(GameMainLoopFrame) {
 			PushBitmap(renderGroup, ScaledUprightTransform(1.35f), bmp, groundLevelPos);
 			RenderHitPoints(renderGroup, *entity, groundLevelPos, V2{0.f, -0.6f}, 0.1f, 0.2f, V4{ 1, 0, 0, layerAlpha });
 		} break;
-		case EntityType_Wall: {
-			const f32 treeHeight = 2.5f * world.tileSizeInMeters.Z;
-#if 0
-			PushRect(renderGroup, groundLevelPos, entity->collision->totalVolume.size.XY, V2{ 0, 0 }, V4{ 1, 1, 1, layerAlpha });
-#endif
-			AssetFeatures match = {};
-			AssetFeatures weight = {};
-			match[Feature_Height] = 2.5f;
-			weight[Feature_Height] = 1.f;
-			BitmapId bmp = GetBestFitBitmapId(tranState->assets, Asset_Tree, match, weight, 10000);
-			PushBitmap(renderGroup, ScaledUprightTransform(treeHeight), bmp, groundLevelPos, V4{1, 0.f, 1.f, layerAlpha});
-		} break;
-		case EntityType_Stairs: {
-			PushRect(renderGroup, DefaultUprightTransform(), groundLevelPos, entity->collision->totalVolume.size.XY, V4{ 0.1f, 0.1f, 0.1f, layerAlpha });
-			V3 upStairsPos = groundLevelPos + V3{ 0, 0, entity->walkableDim.Z };
-			PushRectBorders(renderGroup, DefaultUprightTransform(), upStairsPos, entity->collision->totalVolume.size.XY, V4{ 0, 0, 0, layerAlpha }, 0.1f);
+		case EntityType_Wall:
+		case EntityType_Stairs:
+		case EntityType_Space: {
+			// NOTE: Drawn by PushStaticEntities()
 		} break;
 #if 1
 		case EntityType_Familiar: {
@@ -1464,9 +1702,6 @@ extern "C" GAME_MAIN_LOOP_FRAME(GameMainLoopFrame) {
 				MakeEntityNonSpatial(state, entity->storageIndex, *entity);
 			}
 		} break;
-		case EntityType_Space: {
-			PushRectBorders(renderGroup, DefaultUprightTransform(), groundLevelPos, entity->collision->totalVolume.size.XY, V4{0, 0, 1, layerAlpha }, 0.2f);
-		} break;
 		default: Assert(!"Function to draw entity not found!");
 #endif
 		}
@@ -1627,6 +1862,9 @@ extern "C" GAME_MAIN_LOOP_FRAME(GameMainLoopFrame) {
 	EndSimulation(*simRegion, world);
 	EndTempMemory(renderMemory);
 	EndTempMemory(simMemory);
+	UpdateAssetLoads(tranState->assets);
+	UpdateAssetMemoryBudget(tranState->assets);
+	ResetBestFitMemo(tranState->assets);
 	CheckArena(tranState->arena);
 	CheckArena(world.arena);
 }
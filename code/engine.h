@@ -68,15 +68,27 @@ enum class GroundBufferState {
 	Ready,
 };
 
+// NOTE: Ground buffers are a cache of rasterized chunks, hashed by chunk position and kept on
+// LRU list, where sentinel's next is the most recently drawn one
 struct GroundBuffer {
 	LoadedBitmap buffer;
 	WorldPosition pos;
 	GroundBufferState state;
+	u32 lastUsedFrame;
+	u32 filledFrame;
+	// NOTE: Set when some decal bitmap wasn't loaded while filling, the chunk gets filled again
+	bool incomplete;
+	GroundBuffer* nextInHash;
+	GroundBuffer* prev;
+	GroundBuffer* next;
 };
 
 struct TransientState {
 	MemoryArena arena;
 	GroundBuffer groundBuffers[256];
+	GroundBuffer* groundBufferHash[512];
+	GroundBuffer groundBufferSentinel;
+	u32 groundFrameIndex;
 	bool isInitialized;
 	PlatformQueue* lowPriorityQueue;
 	PlatformQueue* highPriorityQueue;
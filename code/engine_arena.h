@@ -132,4 +132,4 @@ void CheckArena(MemoryArena& arena) {
 #define InitializeArena(arena, data, capacity) InitializeArena_(arena, data, capacity); \
 	{ RecordMemoryDebugEvent(Event_MemoryArenaInitialize, arena) }
 #define SubArena(subarena, arena, capacity) SubArena_(subarena, arena, capacity); \
-	{ RecordSubArenaDebugEvent(subarena, arena) }
\ No newline at end of file
+	{ RecordSubArenaDebugEvent(subarena, arena) }
@@ -1,4 +1,5 @@
 #include "engine.h"
+#include "engine_compression.h"
 
 #if INTERNAL_BUILD
 u32 debugLruCount = 0;
@@ -16,10 +17,10 @@ void EndAssetMemoryLock(Assets& assets) {
 }
 
 inline
-void AddMemoryHeaderToList(Assets& assets, AssetMemoryHeader* header) {
+void AddMemoryHeaderToList(AssetMemoryHeader* sentinel, AssetMemoryHeader* header) {
 	// NOTE: Needs asset lock
-	header->next = assets.lruSentinel.next;
-	header->prev = &assets.lruSentinel;
+	header->next = sentinel->next;
+	header->prev = sentinel;
 	header->next->prev = header;
 	header->prev->next = header;
 #if INTERNAL_BUILD
@@ -27,13 +28,6 @@ void AddMemoryHeaderToList(Assets& assets, AssetMemoryHeader* header) {
 #endif
 }
 
-inline
-void LockedAddMemoryHeaderToList(Assets& assets, AssetMemoryHeader* header) {
-	BeginAssetMemoryLock(assets);
-	AddMemoryHeaderToList(assets, header);
-	EndAssetMemoryLock(assets);
-}
-
 inline
 void RemoveMemoryHeaderFromList(AssetMemoryHeader* header) {
 	// NOTE: Needs asset lock
@@ -55,7 +49,7 @@ inline
 void LockedMoveMemoryHeaderToFront(Assets& assets, AssetMemoryHeader* header) {
 	BeginAssetMemoryLock(assets);
 	RemoveMemoryHeaderFromList(header);
-	AddMemoryHeaderToList(assets, header);
+	AddMemoryHeaderToList(&assets.recentSentinel, header);
 	EndAssetMemoryLock(assets);
 }
 
@@ -85,18 +79,28 @@ Asset* AcquireAsset(Assets& assets, u32 aid, GenerationId gid) {
 	Assert(gid.id && "Rendering must be started with BeginRendering() which creates generation id for"
 		"specific render group. Or if not using RenderGroup, create one by yourself with NewGenerationId()");
 	Asset* asset = GetAsset(assets, aid);
-	// TODO: Should it be more finegrained lock on per asset basis?
-	BeginAssetMemoryLock(assets);
-	if (asset->state == AssetState_Ready) {
-		if (asset && asset->memory) {
-			if (asset->memory->generationId < gid.id) {
-				asset->memory->generationId = gid.id;
-			}
-			RemoveMemoryHeaderFromList(asset->memory);
-			AddMemoryHeaderToList(assets, asset->memory);
+	if (asset->state != AssetState_Ready) {
+		return 0;
+	}
+	// NOTE: Lock free, eviction flips the state first and reads the generation after, here the
+	// generation is raised first and the state is read after, so at least one side sees the other
+	u32 generationId = asset->generationId;
+	while (generationId < gid.id) {
+		u32 original = AtomicCompareExchange(&asset->generationId, gid.id, generationId);
+		if (original == generationId) {
+			break;
 		}
+		generationId = original;
+	}
+	FullMemoryFence;
+	ReadCompilatorFence;
+	if (asset->state != AssetState_Ready) {
+		return 0;
+	}
+	// NOTE: LRU position is updated lazily by eviction, which gives referenced assets a second chance
+	if (!asset->referenced) {
+		asset->referenced = 1;
 	}
-	EndAssetMemoryLock(assets);
 	return asset;
 }
 
@@ -152,6 +156,18 @@ PlatformFileHandle* GetAssetSource(Assets& assets, u32 index) {
 	return handle;
 }
 
+inline
+u8* GetMappedAssetData(Assets& assets, u32 index, u64 offset, u32 size) {
+	if (!assets.mappedSources || !assets.mappedSources[index]) {
+		return 0;
+	}
+	PlatformFileHandle* handle = GetAssetSource(assets, index);
+	if (offset + size > handle->size) {
+		return 0;
+	}
+	return assets.mappedSources[index] + offset;
+}
+
 inline
 AssetGroup* GetAssetGroup(Assets& assets, AssetTypeID typeId) {
 	AssetGroup* group = &assets.groups[typeId];
@@ -174,13 +190,25 @@ u32 _GetFirstAssetIdWithType(Assets& assets, AssetTypeID typeId) {
 inline
 u32 _GetRandomAssetId(Assets& assets, AssetTypeID typeId, RandomSeries& series) {
 	AssetGroup* group = GetAssetGroup(assets, typeId);
+	if (group->firstAssetIndex == group->onePastLastAssetIndex) {
+		return 0;
+	}
 	u32 id = RandomChoiceBetween(series, group->firstAssetIndex, group->onePastLastAssetIndex);
 	return id;
 }
 
+inline
+f32 GetBestFitFeatureScore(f32 feature, f32 match, f32 weight, f32 halfPeriod) {
+	f32 a1 = feature;
+	f32 a2 = feature - 2 * halfPeriod;
+	f32 d1 = Abs(match - a1);
+	f32 d2 = Abs(match - a2);
+	f32 distance = Minimum(d1, d2);
+	return weight * Abs(distance);
+}
+
 internal
-u32 _GetBestFitAssetId(Assets& assets, AssetTypeID typeId, AssetFeatures match, AssetFeatures weight, f32 halfPeriod) {
-	AssetGroup* group = GetAssetGroup(assets, typeId);
+u32 GetBestFitAssetIdLinear(Assets& assets, AssetGroup* group, AssetFeatures match, AssetFeatures weight, f32 halfPeriod) {
 	u32 best = {};
 	f32 bestScore = F32_MAX;
 	for (u32 assetIndex = group->firstAssetIndex;
@@ -190,12 +218,7 @@ u32 _GetBestFitAssetId(Assets& assets, AssetTypeID typeId, AssetFeatures match,
 		AssetFeatures* features = GetAssetFeatures(assets, assetIndex);
 		f32 score = 0;
 		for (u32 featureIndex = 0; featureIndex < ArrayCount(*features); featureIndex++) {
-			f32 a1 = (*features)[featureIndex];
-			f32 a2 = (*features)[featureIndex] - 2 * halfPeriod;
-			f32 d1 = Abs(match[featureIndex] - a1);
-			f32 d2 = Abs(match[featureIndex] - a2);
-			f32 distance = Minimum(d1, d2);
-			score += weight[featureIndex] * Abs(distance);
+			score += GetBestFitFeatureScore((*features)[featureIndex], match[featureIndex], weight[featureIndex], halfPeriod);
 		}
 		if (score < bestScore) {
 			bestScore = score;
@@ -205,6 +228,131 @@ u32 _GetBestFitAssetId(Assets& assets, AssetTypeID typeId, AssetFeatures match,
 	return best;
 }
 
+inline
+u32 FindFirstFeatureNotBelow(SortElement* elements, u32 count, u64 key) {
+	u32 low = 0;
+	u32 high = count;
+	while (low < high) {
+		u32 middle = low + (high - low) / 2;
+		if (elements[middle].key < key) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+internal
+u32 GetBestFitAssetIdIndexed(Assets& assets, AssetGroup* group, u32 featureIndex, f32 match, f32 weight, f32 halfPeriod) {
+	// NOTE: Score is the distance to match or to match + 2 * halfPeriod, so the best fit is one of the
+	// neighbours of these two values. Equal values keep asset order, first of them wins like in the scan
+	SortElement* elements = assets.featureIndex[featureIndex] + group->firstAssetIndex;
+	u32 count = group->onePastLastAssetIndex - group->firstAssetIndex;
+	f32 targets[2] = { match, match + 2 * halfPeriod };
+	u32 best = {};
+	f32 bestScore = F32_MAX;
+	for (u32 targetIndex = 0; targetIndex < ArrayCount(targets); targetIndex++) {
+		u32 above = FindFirstFeatureNotBelow(elements, count, FloatToRadixValue(targets[targetIndex]));
+		u32 candidates[2] = { above, count };
+		if (above > 0) {
+			candidates[1] = FindFirstFeatureNotBelow(elements, above, elements[above - 1].key);
+		}
+		for (u32 candidateIndex = 0; candidateIndex < ArrayCount(candidates); candidateIndex++) {
+			if (candidates[candidateIndex] >= count) {
+				continue;
+			}
+			SortElement* element = elements + candidates[candidateIndex];
+			f32 feature = assets.features[element->offset][featureIndex];
+			f32 score = GetBestFitFeatureScore(feature, match, weight, halfPeriod);
+			if (score < bestScore || (score == bestScore && element->offset < best)) {
+				bestScore = score;
+				best = element->offset;
+			}
+		}
+	}
+	return best;
+}
+
+inline
+bool AssetFeaturesAreEqual(AssetFeatures first, AssetFeatures second) {
+	for (u32 featureIndex = 0; featureIndex < Feature_Count; featureIndex++) {
+		if (first[featureIndex] != second[featureIndex]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+internal
+u32 _GetBestFitAssetId(Assets& assets, AssetTypeID typeId, AssetFeatures match, AssetFeatures weight, f32 halfPeriod) {
+	AssetGroup* group = GetAssetGroup(assets, typeId);
+	if (group->firstAssetIndex == group->onePastLastAssetIndex) {
+		return 0;
+	}
+	AssertMainThread;
+	u32 hash = u4(typeId) * 31 + *ptrcast(u32, &halfPeriod);
+	for (u32 featureIndex = 0; featureIndex < Feature_Count; featureIndex++) {
+		hash = hash * 31 + *ptrcast(u32, &match[featureIndex]);
+		hash = hash * 31 + *ptrcast(u32, &weight[featureIndex]);
+	}
+	hash ^= hash >> 16;
+	AssetBestFitMemo* freeMemo = 0;
+	for (u32 probeIndex = 0; probeIndex < ASSET_BEST_FIT_MEMO_PROBE_COUNT; probeIndex++) {
+		AssetBestFitMemo* memo = assets.bestFitMemo + ((hash + probeIndex) & (ASSET_BEST_FIT_MEMO_COUNT - 1));
+		if (memo->frameIndex != assets.bestFitFrameIndex) {
+			freeMemo = freeMemo ? freeMemo : memo;
+			continue;
+		}
+		if (memo->typeId == typeId && memo->halfPeriod == halfPeriod &&
+			AssetFeaturesAreEqual(memo->match, match) && AssetFeaturesAreEqual(memo->weight, weight)) {
+			return memo->assetIndex;
+		}
+	}
+
+	// NOTE: Queries weighting a single feature use the sorted index, the others scan the group
+	u32 weightedFeature = Feature_Count;
+	u32 weightedCount = 0;
+	for (u32 featureIndex = 0; featureIndex < Feature_Count; featureIndex++) {
+		if (weight[featureIndex] != 0.f) {
+			weightedFeature = featureIndex;
+			weightedCount++;
+		}
+	}
+	u32 best = {};
+	if (weightedCount == 0) {
+		best = group->firstAssetIndex;
+	}
+	else if (weightedCount == 1 && weight[weightedFeature] > 0.f && assets.featureIndex[weightedFeature]) {
+		best = GetBestFitAssetIdIndexed(assets, group, weightedFeature, match[weightedFeature], weight[weightedFeature], halfPeriod);
+	}
+	else {
+		best = GetBestFitAssetIdLinear(assets, group, match, weight, halfPeriod);
+	}
+
+	if (!freeMemo) {
+		freeMemo = assets.bestFitMemo + (hash & (ASSET_BEST_FIT_MEMO_COUNT - 1));
+	}
+	freeMemo->frameIndex = assets.bestFitFrameIndex;
+	freeMemo->typeId = typeId;
+	freeMemo->halfPeriod = halfPeriod;
+	CopySize(match, freeMemo->match, sizeof(AssetFeatures));
+	CopySize(weight, freeMemo->weight, sizeof(AssetFeatures));
+	freeMemo->assetIndex = best;
+	return best;
+}
+
+internal
+void ResetBestFitMemo(Assets& assets) {
+	// NOTE: Entries of the previous frames don't match the frame index anymore
+	assets.bestFitFrameIndex++;
+	if (assets.bestFitFrameIndex == 0) {
+		ZeroStruct(assets.bestFitMemo);
+		assets.bestFitFrameIndex = 1;
+	}
+}
+
 inline
 SoundId GetFirstSoundIdWithType(Assets& assets, AssetTypeID typeId) {
 	SoundId id = { _GetFirstAssetIdWithType(assets, typeId) };
@@ -266,6 +414,9 @@ GenerationId NewGenerationId(Assets& assets) {
 	Assert(assets.inFlightGenerationCount < ArrayCount(assets.inFlightGenerations));
 	GenerationId result = {};
 	result.id = ++assets.nextGenerationId.id;
+	if (!assets.inFlightGenerationCount) {
+		assets.oldestInFlightGenerationId = result.id;
+	}
 	assets.inFlightGenerations[assets.inFlightGenerationCount++] = result;
 	EndAssetMemoryLock(assets);
 	return result;
@@ -281,18 +432,17 @@ void FinishGeneration(Assets& assets, GenerationId gid) {
 			break;
 		}
 	}
+	assets.oldestInFlightGenerationId = U32_MAX;
+	for (u32 index = 0; index < assets.inFlightGenerationCount; index++) {
+		assets.oldestInFlightGenerationId = Minimum(assets.oldestInFlightGenerationId, assets.inFlightGenerations[index].id);
+	}
 	EndAssetMemoryLock(assets);
 }
 
 internal
 bool GenerationHasCompleted(Assets& assets, Asset* asset) {
 	//NOTE: Must be locked
-	for (u32 index = 0; index < assets.inFlightGenerationCount; index++) {
-		if (assets.inFlightGenerations[index].id <= asset->memory->generationId) {
-			return false;
-		}
-	}
-	return true;
+	return asset->generationId < assets.oldestInFlightGenerationId;
 }
 
 inline
@@ -300,57 +450,291 @@ bool NeedsFetching(Asset& asset) {
 	return asset.state == AssetState_NotReady;
 }
 
-struct LoadAssetTaskArgs {
-	PlatformFileHandle* source;
-	void* buffer;
-	u32 offset;
-	u32 size;
-	TaskWithMemory* task;
-	u32* state;
-	AssetDataType type;
-	LoadedBitmap* bitmap;
-};
+internal
+u32 GetBitmapAlphaFlags(LoadedBitmap* bitmap) {
+	// NOTE: Lets the software renderer copy texels instead of blending them
+	bool alphaTested = true;
+	bool opaque = true;
+	u8* row = ptrcast(u8, bitmap->data);
+	for (i32 Y = 0; Y < bitmap->height && alphaTested; Y++) {
+		u32* texel = ptrcast(u32, row);
+		for (i32 X = 0; X < bitmap->width; X++) {
+			u32 alpha = texel[X] >> 24;
+			opaque &= alpha == 0xFF;
+			alphaTested &= alpha == 0xFF || alpha == 0;
+		}
+		row += bitmap->pitch;
+	}
+	u32 flags = 0;
+	if (alphaTested) {
+		flags |= LoadedBitmap_AlphaTested;
+	}
+	if (alphaTested && opaque) {
+		flags |= LoadedBitmap_Opaque;
+	}
+	return flags;
+}
+
+internal
+void TileBitmap(LoadedBitmap* bitmap, u8* dst) {
+	// NOTE: dst may overlap the texels as long as it doesn't start before them. Tiled rows of blocks
+	// are never shorter than the rows they come from, so going from the last one only overwrites
+	// rows which are already moved
+	Assert(dst >= ptrcast(u8, bitmap->data));
+	Assert(bitmap->width <= BITMAP_MAX_TILED_WIDTH);
+	u32 rows[BITMAP_TILE_SIZE][BITMAP_MAX_TILED_WIDTH];
+	i32 alignedWidth = AlignUp4(bitmap->width);
+	i32 tiledPitch = alignedWidth * sizeof(u32);
+	for (i32 blockY = AlignUp4(bitmap->height) - BITMAP_TILE_SIZE; blockY >= 0; blockY -= BITMAP_TILE_SIZE) {
+		for (i32 rowIndex = 0; rowIndex < BITMAP_TILE_SIZE; rowIndex++) {
+			i32 Y = blockY + rowIndex;
+			u32* srcRow = ptrcast(u32, ptrcast(u8, bitmap->data) + Y * bitmap->pitch);
+			for (i32 X = 0; X < alignedWidth; X++) {
+				rows[rowIndex][X] = (Y < bitmap->height && X < bitmap->width) ? srcRow[X] : 0;
+			}
+		}
+		u32* dstTexel = ptrcast(u32, dst + blockY * tiledPitch);
+		for (i32 blockX = 0; blockX < alignedWidth; blockX += BITMAP_TILE_SIZE) {
+			for (i32 rowIndex = 0; rowIndex < BITMAP_TILE_SIZE; rowIndex++) {
+				for (i32 X = blockX; X < blockX + BITMAP_TILE_SIZE; X++) {
+					*dstTexel++ = rows[rowIndex][X];
+				}
+			}
+		}
+	}
+	bitmap->data = ptrcast(u32, dst);
+	bitmap->pitch = tiledPitch;
+	bitmap->flags |= LoadedBitmap_Tiled;
+}
+
+internal
+void TileBitmapWithMips(LoadedBitmap* bitmap) {
+	// NOTE: Every tiled level starts at or after its row-major position, the last one is moved first
+	u8* tiledLevels[BITMAP_MAX_MIP_COUNT + 1];
+	u8* at = ptrcast(u8, bitmap->data);
+	for (u32 level = 0; level <= bitmap->mipCount; level++) {
+		LoadedBitmap* levelBitmap = level ? bitmap->mips + level - 1 : bitmap;
+		tiledLevels[level] = at;
+		at += GetTiledBitmapSize(levelBitmap->width, levelBitmap->height);
+	}
+	for (i32 level = i4(bitmap->mipCount); level >= 0; level--) {
+		LoadedBitmap* levelBitmap = level ? bitmap->mips + level - 1 : bitmap;
+		TileBitmap(levelBitmap, tiledLevels[level]);
+	}
+}
+
+inline
+LoadAssetTaskArgs* TryBeginAssetLoad(Assets& assets) {
+	AssertMainThread;
+	LoadAssetTaskArgs* result = 0;
+	for (u32 loadIndex = 0; loadIndex < ArrayCount(assets.loads); loadIndex++) {
+		LoadAssetTaskArgs* load = assets.loads + loadIndex;
+		if (AtomicCompareExchange(&load->done, 0, 1)) {
+			result = load;
+			break;
+		}
+	}
+	return result;
+}
+
+inline
+void EndAssetLoad(LoadAssetTaskArgs* load) {
+	WriteCompilatorFence;
+	load->done = true;
+}
+
+internal void ReleaseAssetStaging(Assets& assets, void* staging, u32 size);
+internal void ReleaseFailedAssetLoad(LoadAssetTaskArgs* args);
+
+inline
+void* GetAssetLoadReadBuffer(LoadAssetTaskArgs* args) {
+	return args->compressed ? args->compressed : args->buffer;
+}
+
+inline
+u32 GetAssetLoadReadSize(LoadAssetTaskArgs* args) {
+	return args->compressed ? args->compressedSize : args->size;
+}
+
+inline
+bool NeedsAssetLoadRead(LoadAssetTaskArgs* args) {
+	return !args->mapped && (!args->compressed || args->stagingBlock);
+}
 
 internal
 void LoadAssetBackgroundTask(void* data) {
 	LoadAssetTaskArgs* args = ptrcast(LoadAssetTaskArgs, data);
-	Platform->FileRead(args->source, args->offset, args->size, args->buffer);
-	if (!Platform->FileErrors(args->source)) {
+	bool succeeded = true;
+	if (args->readDone) {
+		succeeded = !args->readFailed;
+	}
+	else if (args->mapped) {
+		// NOTE: Pages are faulted in here, so the renderer and the mixer don't stall on them
+		Platform->MemoryAdvise(args->buffer, args->size, PlatformMemoryAdvice_WillNeed);
+		volatile u8 sink = 0;
+		for (u32 offset = 0; offset < args->size; offset += 4096) {
+			sink = sink + ptrcast(u8, args->buffer)[offset];
+		}
+	}
+	else if (NeedsAssetLoadRead(args)) {
+		Platform->FileRead(args->source, args->offset, GetAssetLoadReadSize(args), GetAssetLoadReadBuffer(args));
+		succeeded = !Platform->FileErrors(args->source);
+	}
+	if (args->compressed) {
+		// NOTE: Decompressed straight into the asset block, staging isn't needed afterwards
+		succeeded = succeeded && LZDecompress(args->compressed, args->compressedSize, ptrcast(u8, args->buffer), args->size);
+		if (succeeded && args->shuffled) {
+			UnshuffleLZBytes(ptrcast(u8, args->buffer), args->size);
+		}
+		if (args->stagingBlock) {
+			ReleaseAssetStaging(*args->assets, args->compressed, args->compressedSize);
+		}
+	}
+	if (succeeded) {
 		if (args->type == AssetData_Bitmap) {
+			args->bitmap->flags = GetBitmapAlphaFlags(args->bitmap);
 			Assert(args->bitmap->textureHandle == 0);
 			u32 textureHandle = Platform->TextureAllocate(
 				args->bitmap->data, args->bitmap->width, args->bitmap->height
 			);
 			AtomicExchangeU32(&args->bitmap->textureHandle, textureHandle);
+			// NOTE: Texture upload copies the texels, so they can be rearranged for the software renderer
+			if (args->tileBitmap) {
+				TileBitmapWithMips(args->bitmap);
+			}
 		}
 		WriteCompilatorFence;
 		*args->state = AssetState_Ready;
 	}
 	else {
-		WriteCompilatorFence;
 		Assert(!"Something bad happened with our file during the program, it shouldn't happen!");
+		ReleaseFailedAssetLoad(args);
+		WriteCompilatorFence;
 		*args->state = AssetState_NotReady;
 	}
-	if (args->task) {
-		EndBackgroundTask(args->task);
+	if (args->ownsSlot) {
+		EndAssetLoad(args);
+	}
+}
+
+internal
+void SubmitAssetLoad(Assets& assets, LoadAssetTaskArgs* args) {
+	AssertMainThread;
+	args->readDone = false;
+	args->readFailed = false;
+	args->ownsSlot = true;
+	WriteCompilatorFence;
+	// NOTE: Payloads already in memory and reads the platform can't queue are done on the worker
+	if (!NeedsAssetLoadRead(args) || !Platform->FileReadAsync(args->source, args->offset,
+		GetAssetLoadReadSize(args), GetAssetLoadReadBuffer(args), args)) {
+		Platform->QueuePushTask(assets.tranState->lowPriorityQueue, LoadAssetBackgroundTask, args, 0);
+	}
+}
+
+internal
+void UpdateAssetLoads(Assets& assets) {
+	TIMED_FUNCTION;
+	AssertMainThread;
+	PlatformFileReadCompletion completions[ASSET_MAX_LOADS_IN_FLIGHT];
+	u32 completionCount = Platform->FileReadAsyncPoll(completions, ArrayCount(completions), false);
+	for (u32 completionIndex = 0; completionIndex < completionCount; completionIndex++) {
+		PlatformFileReadCompletion* completion = completions + completionIndex;
+		LoadAssetTaskArgs* args = ptrcast(LoadAssetTaskArgs, completion->userData);
+		args->readDone = true;
+		args->readFailed = completion->failed || completion->readBytes != GetAssetLoadReadSize(args);
+		if (args->type == AssetData_Bitmap || args->compressed) {
+			// NOTE: Decompression, alpha flags, texture upload and tiling are too heavy for the main thread,
+			// workers do them for several assets at once
+			WriteCompilatorFence;
+			Platform->QueuePushTask(assets.tranState->lowPriorityQueue, LoadAssetBackgroundTask, args, 0);
+		}
+		else {
+			LoadAssetBackgroundTask(args);
+		}
+	}
+}
+
+struct AssetMemoryBinIndex {
+	u32 firstLevel;
+	u32 secondLevel;
+};
+
+inline
+AssetMemoryBinIndex GetAssetMemoryBinIndex(u32 size) {
+	AssetMemoryBinIndex result = {};
+	if (size < ASSET_MEMORY_SL_COUNT) {
+		result.secondLevel = size;
+	}
+	else {
+		u32 log2 = MostSignificantHighBit(size).index;
+		result.firstLevel = log2 - ASSET_MEMORY_SL_SHIFT + 1;
+		result.secondLevel = (size >> (log2 - ASSET_MEMORY_SL_SHIFT)) - ASSET_MEMORY_SL_COUNT;
+	}
+	return result;
+}
+
+inline
+void InsertFreeMemoryBlock(Assets& assets, AssetMemoryBlock* block) {
+	// NOTE: Must be locked
+	AssetMemoryBinIndex bin = GetAssetMemoryBinIndex(block->totalSize);
+	AssetMemoryBlock** head = &assets.freeBlocks[bin.firstLevel][bin.secondLevel];
+	block->prevFree = 0;
+	block->nextFree = *head;
+	if (*head) {
+		(*head)->prevFree = block;
 	}
+	*head = block;
+	assets.freeFirstLevelMask |= 1 << bin.firstLevel;
+	assets.freeSecondLevelMasks[bin.firstLevel] |= 1 << bin.secondLevel;
+	assets.memoryStats.freeSize += block->totalSize;
+	assets.memoryStats.freeBlockCount++;
 }
 
 inline
-AssetMemoryBlock* TryMergeMemoryBlocks(AssetMemoryBlock* prev, AssetMemoryBlock* block) {
+void RemoveFreeMemoryBlock(Assets& assets, AssetMemoryBlock* block) {
+	// NOTE: Must be locked
+	AssetMemoryBinIndex bin = GetAssetMemoryBinIndex(block->totalSize);
+	AssetMemoryBlock** head = &assets.freeBlocks[bin.firstLevel][bin.secondLevel];
+	if (block->prevFree) {
+		block->prevFree->nextFree = block->nextFree;
+	}
+	else {
+		Assert(*head == block);
+		*head = block->nextFree;
+	}
+	if (block->nextFree) {
+		block->nextFree->prevFree = block->prevFree;
+	}
+	if (!*head) {
+		assets.freeSecondLevelMasks[bin.firstLevel] &= ~(1 << bin.secondLevel);
+		if (!assets.freeSecondLevelMasks[bin.firstLevel]) {
+			assets.freeFirstLevelMask &= ~(1 << bin.firstLevel);
+		}
+	}
+	Assert(assets.memoryStats.freeBlockCount > 0);
+	assets.memoryStats.freeSize -= block->totalSize;
+	assets.memoryStats.freeBlockCount--;
+}
+
+inline
+AssetMemoryBlock* TryMergeMemoryBlocks(Assets& assets, AssetMemoryBlock* prev, AssetMemoryBlock* block) {
 	// NOTE: Must be locked
 	if ((prev->flags & AssetMemory_BlockUsed) ||
-		(block->flags & AssetMemory_BlockUsed)
+		(block->flags & AssetMemory_BlockUsed) ||
+		(block->flags & AssetMemory_RegionStart)
 		) {
 		return block;
 	}
 	Assert(prev->remainingSize == prev->totalSize);
 	Assert(block->remainingSize == block->totalSize);	
+	RemoveFreeMemoryBlock(assets, prev);
+	RemoveFreeMemoryBlock(assets, block);
 	prev->totalSize += block->totalSize + sizeof(AssetMemoryBlock);
 	prev->remainingSize = prev->totalSize;
 	prev->flags |= block->flags;
 	block->prev->next = block->next;
 	block->next->prev = block->prev;
+	InsertFreeMemoryBlock(assets, prev);
 #if INTERNAL_BUILD
 	debugMemBlockCount--;
 #endif
@@ -369,10 +753,10 @@ inline bool CheckMemoryBlockBeforeRelease(Assets& assets, AssetMemoryBlock* bloc
 	uptr prevBlockTotalSize = block->prev->totalSize;
 
 	// Assert that next and prev blocks are determined by the sizes of the blocks
-	if (block->next != &assets.memorySentinel) {
+	if (block->next != &assets.memorySentinel && !(block->next->flags & AssetMemory_RegionStart)) {
 		Assert((blockMemoryStart + totalAfterRelease) == nextBlockStart);
 	}
-	if (block->prev != &assets.memorySentinel) {
+	if (block->prev != &assets.memorySentinel && !(block->flags & AssetMemory_RegionStart)) {
 		Assert((prevBlockMemoryStart + prevBlockTotalSize) == blockStart);
 	}
 	return true;
@@ -385,38 +769,67 @@ AssetMemoryBlock* ReleaseAssetMemory(Assets& assets, void* memory, u32 size) {
 	Assert(CheckMemoryBlockBeforeRelease(assets, block, size));
 	block->flags &= ~AssetMemory_BlockUsed;
 	block->remainingSize += size;
+	assets.memoryStats.usedSize -= size;
+	assets.memoryStats.usedBlockCount--;
+	InsertFreeMemoryBlock(assets, block);
 
 	if (block->prev != &assets.memorySentinel) {
-		block = TryMergeMemoryBlocks(block->prev, block);
+		block = TryMergeMemoryBlocks(assets, block->prev, block);
 	}
 	if (block->next != &assets.memorySentinel) {
-		TryMergeMemoryBlocks(block, block->next);
+		TryMergeMemoryBlocks(assets, block, block->next);
 	}
 	return block;
 }
 
+internal
+void ReleaseAssetStaging(Assets& assets, void* staging, u32 size) {
+	BeginAssetMemoryLock(assets);
+	ReleaseAssetMemory(assets, staging, size);
+	EndAssetMemoryLock(assets);
+}
+
 inline
 AssetMemoryBlock* FindMemoryBlockWithSize(Assets& assets, u32 size) {
 	// NOTE: Must be locked
-	// TODO: This is exteremely unefficient for huge amount of assets loaded in memory
-	// Every time we allocate new asset we need to traverse through thousands of links
-	// to find a block. The search system should be created on top of that memory system.
-	for (AssetMemoryBlock* block = assets.memorySentinel.next;
-		block != &assets.memorySentinel;
-		block = block->next
-		) {
-		if ((block->flags & AssetMemory_BlockUsed) ||
-			(block->remainingSize < size)) 
-		{
-			continue;
+	// NOTE: Size is rounded up to the next class, so every block from the found bin fits without
+	// walking the list. Blocks from the size's own class might fit too, they are the last resort
+	u32 searchSize = size;
+	if (size >= ASSET_MEMORY_SL_COUNT) {
+		u32 log2 = MostSignificantHighBit(size).index;
+		Assert(log2 < 31);
+		searchSize += (1 << (log2 - ASSET_MEMORY_SL_SHIFT)) - 1;
+	}
+	AssetMemoryBinIndex bin = GetAssetMemoryBinIndex(searchSize);
+	u32 secondLevelMask = assets.freeSecondLevelMasks[bin.firstLevel] & (U32_MAX << bin.secondLevel);
+	if (!secondLevelMask) {
+		u32 firstLevelMask = assets.freeFirstLevelMask & (U32_MAX << (bin.firstLevel + 1));
+		if (firstLevelMask) {
+			bin.firstLevel = LeastSignificantHighBit(firstLevelMask).index;
+			secondLevelMask = assets.freeSecondLevelMasks[bin.firstLevel];
 		}
+	}
+	if (secondLevelMask) {
+		bin.secondLevel = LeastSignificantHighBit(secondLevelMask).index;
+		AssetMemoryBlock* block = assets.freeBlocks[bin.firstLevel][bin.secondLevel];
+		Assert(block && block->totalSize >= size);
 		return block;
 	}
+
+	bin = GetAssetMemoryBinIndex(size);
+	for (AssetMemoryBlock* block = assets.freeBlocks[bin.firstLevel][bin.secondLevel];
+		block;
+		block = block->nextFree
+		) {
+		if (block->totalSize >= size) {
+			return block;
+		}
+	}
 	return 0;
 }
 
 inline
-void InsertNewMemoryBlock(AssetMemoryBlock* prev, void* memory, u32 size) {
+void InsertNewMemoryBlock(Assets& assets, AssetMemoryBlock* prev, void* memory, u32 size) {
 	// NOTE: Must be locked
 	AssetMemoryBlock* block = ptrcast(AssetMemoryBlock, memory);
 	block->flags = 0;
@@ -426,11 +839,241 @@ void InsertNewMemoryBlock(AssetMemoryBlock* prev, void* memory, u32 size) {
 	block->next = prev->next;
 	block->prev->next = block;
 	block->next->prev = block;
+	InsertFreeMemoryBlock(assets, block);
 #if INTERNAL_BUILD
 	debugMemBlockCount++;
 #endif
 }
 
+inline
+u32 GetAssetMemoryOccupiedSize(Assets& assets) {
+	// NOTE: Must be locked
+	return assets.memoryStats.totalSize - assets.memoryStats.freeSize;
+}
+
+internal
+bool GrowAssetMemory(Assets& assets) {
+	// NOTE: Must be locked
+	u32 regionSize = assets.memoryConfig.regionSize;
+	if (!assets.reservedMemory || assets.committedSize + regionSize > assets.reservedSize) {
+		return false;
+	}
+	u8* region = assets.reservedMemory + assets.committedSize;
+	if (!Platform->MemoryCommit(region, regionSize)) {
+		return false;
+	}
+	assets.committedSize += regionSize;
+	assets.memoryStats.totalSize += regionSize;
+	assets.memoryStats.regionCount++;
+
+	// NOTE: Regions committed one after another are contiguous, so they merge into one block
+	AssetMemoryBlock* last = assets.memorySentinel.prev;
+	bool adjacent = last != &assets.memorySentinel && ptrcast(u8, last + 1) + last->totalSize == region;
+	InsertNewMemoryBlock(assets, last, region, regionSize);
+	AssetMemoryBlock* block = last->next;
+	if (adjacent) {
+		TryMergeMemoryBlocks(assets, last, block);
+	}
+	else {
+		block->flags |= AssetMemory_RegionStart;
+	}
+	return true;
+}
+
+inline
+void PushAssetGhost(Assets& assets, AssetGhostList& list, AssetMemoryHeader* header, AssetResidency residency) {
+	// NOTE: Must be locked
+	Asset* asset = GetAsset(assets, header->assetIndex);
+	asset->residency = residency;
+	asset->ghostSize = header->totalSize;
+	asset->ghostPrev = 0;
+	asset->ghostNext = list.first;
+	if (list.first) {
+		GetAsset(assets, list.first)->ghostPrev = header->assetIndex;
+	}
+	else {
+		list.last = header->assetIndex;
+	}
+	list.first = header->assetIndex;
+	list.size += asset->ghostSize;
+}
+
+inline
+void RemoveAssetGhost(Assets& assets, AssetGhostList& list, u32 assetIndex) {
+	// NOTE: Must be locked
+	Asset* asset = GetAsset(assets, assetIndex);
+	if (asset->ghostPrev) {
+		GetAsset(assets, asset->ghostPrev)->ghostNext = asset->ghostNext;
+	}
+	else {
+		list.first = asset->ghostNext;
+	}
+	if (asset->ghostNext) {
+		GetAsset(assets, asset->ghostNext)->ghostPrev = asset->ghostPrev;
+	}
+	else {
+		list.last = asset->ghostPrev;
+	}
+	list.size -= asset->ghostSize;
+	asset->residency = AssetResidency_None;
+	asset->ghostSize = 0;
+	asset->ghostNext = 0;
+	asset->ghostPrev = 0;
+}
+
+inline
+void AddResidentAsset(Assets& assets, AssetMemoryHeader* header, AssetResidency residency) {
+	// NOTE: Must be locked
+	Asset* asset = GetAsset(assets, header->assetIndex);
+	asset->residency = residency;
+	if (residency == AssetResidency_Frequent) {
+		AddMemoryHeaderToList(&assets.frequentSentinel, header);
+		assets.memoryStats.frequentSize += header->totalSize;
+	}
+	else {
+		Assert(residency == AssetResidency_Recent);
+		AddMemoryHeaderToList(&assets.recentSentinel, header);
+		assets.memoryStats.recentSize += header->totalSize;
+	}
+}
+
+inline
+void RemoveResidentAsset(Assets& assets, AssetMemoryHeader* header) {
+	// NOTE: Must be locked
+	Asset* asset = GetAsset(assets, header->assetIndex);
+	RemoveMemoryHeaderFromList(header);
+	if (asset->residency == AssetResidency_Frequent) {
+		assets.memoryStats.frequentSize -= header->totalSize;
+	}
+	else {
+		Assert(asset->residency == AssetResidency_Recent);
+		assets.memoryStats.recentSize -= header->totalSize;
+	}
+	asset->residency = AssetResidency_None;
+}
+
+internal
+void InsertResidentAsset(Assets& assets, AssetMemoryHeader* header) {
+	BeginAssetMemoryLock(assets);
+	Asset* asset = GetAsset(assets, header->assetIndex);
+	Assert(asset->residency != AssetResidency_Recent && asset->residency != AssetResidency_Frequent);
+	asset->referenced = 0;
+	asset->recentReferenceCount = 0;
+	if (assets.memoryConfig.replacementPolicy == AssetReplacement_Clock) {
+		AddResidentAsset(assets, header, AssetResidency_Recent);
+	}
+	else {
+		u32 capacity = assets.memoryStats.totalSize;
+		f32 size = f4(header->totalSize);
+		if (asset->residency == AssetResidency_RecentGhost) {
+			// NOTE: Recent list was evicted too early, it gets more of the memory
+			f32 ratio = Maximum(1.f, f4(assets.frequentGhosts.size) / f4(Maximum(assets.recentGhosts.size, 1u)));
+			assets.recentTargetSize = u4(Minimum(f4(assets.recentTargetSize) + ratio * size, f4(capacity)));
+			RemoveAssetGhost(assets, assets.recentGhosts, header->assetIndex);
+			AddResidentAsset(assets, header, AssetResidency_Frequent);
+		}
+		else if (asset->residency == AssetResidency_FrequentGhost) {
+			f32 ratio = Maximum(1.f, f4(assets.recentGhosts.size) / f4(Maximum(assets.frequentGhosts.size, 1u)));
+			assets.recentTargetSize = u4(Maximum(f4(assets.recentTargetSize) - ratio * size, 0.f));
+			RemoveAssetGhost(assets, assets.frequentGhosts, header->assetIndex);
+			AddResidentAsset(assets, header, AssetResidency_Frequent);
+		}
+		else {
+			// NOTE: History is bounded like in ARC, recent list with its ghosts fits the capacity
+			// and everything together fits twice the capacity
+			while (assets.recentGhosts.last &&
+				assets.memoryStats.recentSize + assets.recentGhosts.size > capacity) {
+				RemoveAssetGhost(assets, assets.recentGhosts, assets.recentGhosts.last);
+			}
+			while (assets.frequentGhosts.last &&
+				u64(assets.memoryStats.recentSize) + assets.memoryStats.frequentSize +
+				assets.recentGhosts.size + assets.frequentGhosts.size > 2 * u64(capacity)) {
+				RemoveAssetGhost(assets, assets.frequentGhosts, assets.frequentGhosts.last);
+			}
+			AddResidentAsset(assets, header, AssetResidency_Recent);
+		}
+	}
+	EndAssetMemoryLock(assets);
+}
+
+internal
+void ReleaseFailedAssetLoad(LoadAssetTaskArgs* args) {
+	// NOTE: Block goes back to the budget right away, the asset is fetched again on the next request
+	Assets& assets = *args->assets;
+	AssetMemoryHeader* header = args->memory;
+	BeginAssetMemoryLock(assets);
+	Asset* asset = GetAsset(assets, header->assetIndex);
+	Assert(asset->memory == header);
+	RemoveResidentAsset(assets, header);
+	ReleaseAssetMemory(assets, header, header->totalSize);
+	asset->memory = 0;
+	EndAssetMemoryLock(assets);
+}
+
+internal
+AssetMemoryBlock* EvictAsset(Assets& assets) {
+	// NOTE: Must be locked
+	AssetMemoryBlock* result = 0;
+	bool adaptive = assets.memoryConfig.replacementPolicy == AssetReplacement_Adaptive;
+	// NOTE: Referenced assets lose the bit when they are looked at, so every resident asset is seen
+	// a few times at most before the walk gives up on assets that are pinned by generations in flight
+	u32 stepCount = 3 * assets.memoryStats.usedBlockCount + 1;
+	for (u32 step = 0; step < stepCount; step++) {
+		bool recentEmpty = assets.recentSentinel.prev == &assets.recentSentinel;
+		bool frequentEmpty = assets.frequentSentinel.prev == &assets.frequentSentinel;
+		if (recentEmpty && frequentEmpty) {
+			break;
+		}
+		bool fromRecent = !adaptive || frequentEmpty ||
+			(!recentEmpty && assets.memoryStats.recentSize >= Maximum(1u, assets.recentTargetSize));
+		AssetMemoryHeader* header = fromRecent ? assets.recentSentinel.prev : assets.frequentSentinel.prev;
+		Assert(header->assetIndex);
+		Asset* asset = GetAsset(assets, header->assetIndex);
+		AssetResidency residency = AssetResidency(asset->residency);
+		if (asset->referenced) {
+			// NOTE: Assets referenced again after the second chance in the recent list are the frequent ones,
+			// the first hit after load usually comes from the very request that loaded it
+			asset->referenced = 0;
+			if (adaptive && residency == AssetResidency_Recent && ++asset->recentReferenceCount > 1) {
+				residency = AssetResidency_Frequent;
+			}
+			RemoveResidentAsset(assets, header);
+			AddResidentAsset(assets, header, residency);
+			continue;
+		}
+		if (AtomicCompareExchange(&asset->state, AssetState_Evicting, AssetState_Ready) == AssetState_Ready) {
+			if (GenerationHasCompleted(assets, asset)) {
+				Assert(asset->memory == header);
+				RemoveResidentAsset(assets, header);
+				if (adaptive) {
+					if (residency == AssetResidency_Recent) {
+						PushAssetGhost(assets, assets.recentGhosts, header, AssetResidency_RecentGhost);
+					}
+					else {
+						PushAssetGhost(assets, assets.frequentGhosts, header, AssetResidency_FrequentGhost);
+					}
+				}
+				if (header->type == AssetData_Bitmap) {
+					Platform->TextureFree(header->bitmap.textureHandle);
+				}
+				if (header->mappedSize) {
+					Platform->MemoryAdvise(header->mappedData, header->mappedSize, PlatformMemoryAdvice_DontNeed);
+				}
+				result = ReleaseAssetMemory(assets, header, header->totalSize);
+				asset->memory = 0;
+				WriteCompilatorFence;
+				asset->state = AssetState_NotReady;
+				break;
+			}
+			asset->state = AssetState_Ready;
+		}
+		// NOTE: Still loading or used by a generation in flight
+		RemoveResidentAsset(assets, header);
+		AddResidentAsset(assets, header, residency);
+	}
+	return result;
+}
+
 internal
 void* AcquireAssetMemory(Assets& assets, u32 size) {
 	void* result = 0;
@@ -438,7 +1081,7 @@ void* AcquireAssetMemory(Assets& assets, u32 size) {
 	AssetMemoryBlock* block = FindMemoryBlockWithSize(assets, size);
 	for (;;) {
 		if (block && size <= block->remainingSize) {
-
+			RemoveFreeMemoryBlock(assets, block);
 			result = ptrcast(u8, block + 1);
 			block->flags |= AssetMemory_BlockUsed;
 			u32 newRemainingSize = block->remainingSize - size;
@@ -447,40 +1090,80 @@ void* AcquireAssetMemory(Assets& assets, u32 size) {
 				block->totalSize = size;
 				block->remainingSize = 0;
 				
-				InsertNewMemoryBlock(block, ptrcast(u8, result) + size, newRemainingSize);
+				InsertNewMemoryBlock(assets, block, ptrcast(u8, result) + size, newRemainingSize);
 			}
 			else {
 				block->remainingSize = newRemainingSize;
 			}
+			assets.memoryStats.usedSize += size;
+			assets.memoryStats.usedBlockCount++;
 			break;
 		}
 
+		// NOTE: Above the hard watermark the budget grows before anything gets evicted
+		u32 hardLimit = u4(assets.memoryConfig.hardWatermark * f4(assets.memoryStats.totalSize));
+		if (GetAssetMemoryOccupiedSize(assets) + size > hardLimit && GrowAssetMemory(assets)) {
+			block = FindMemoryBlockWithSize(assets, size);
+			continue;
+		}
+
 		// NOTE: We don't have enough space for allocation. Evict lru asset
-		AssetMemoryHeader* leastUsed = assets.lruSentinel.prev;
-		bool evicted = false;
-		while (leastUsed != &assets.lruSentinel) {
-			Assert(leastUsed->assetIndex);
-			Asset* asset = GetAsset(assets, leastUsed->assetIndex);
-			if (GenerationHasCompleted(assets, asset) &&
-				AtomicCompareExchange(&asset->state, AssetState_NotReady, AssetState_Ready) == AssetState_Ready
-				) {
-				Assert(asset->memory == leastUsed);
-				RemoveMemoryHeaderFromList(leastUsed);
-				if (asset->memory->type == AssetData_Bitmap) {
-					Platform->TextureFree(asset->memory->bitmap.textureHandle);
-				}
-				// NOTE: When we don't find any block and we evicted one asset, only the block
-				// from evicted asset can be used to check whether more assets needs to be evicted
-				// or allocation can take place
-				block = ReleaseAssetMemory(assets, leastUsed, leastUsed->totalSize);
-				asset->memory = 0;
-				evicted = true;
+		// When we don't find any block and we evicted one asset, only the block
+		// from evicted asset can be used to check whether more assets needs to be evicted
+		// or allocation can take place
+		block = EvictAsset(assets);
+		if (!block && GrowAssetMemory(assets)) {
+			// NOTE: Everything resident is still in use, the budget has to grow regardless of the watermark
+			block = FindMemoryBlockWithSize(assets, size);
+			continue;
+		}
+		break;
+	}
+	EndAssetMemoryLock(assets);
+	return result;
+}
+
+inline
+u8* AcquireCompressedPayload(Assets& assets, u8* mappedPayload, u32 compressedSize) {
+	// NOTE: Compressed payload is decompressed from the mapped file, or read into a staging block first
+	u8* result = 0;
+	if (compressedSize) {
+		result = mappedPayload ? mappedPayload : ptrcast(u8, AcquireAssetMemory(assets, compressedSize));
+	}
+	return result;
+}
+
+internal
+void UpdateAssetMemoryBudget(Assets& assets) {
+	// NOTE: Runs at the end of the frame, so the budget is made before prefetches have to stall on eviction
+	AssertMainThread;
+	BeginAssetMemoryLock(assets);
+	u32 softLimit = u4(assets.memoryConfig.softWatermark * f4(assets.memoryStats.totalSize));
+	if (GetAssetMemoryOccupiedSize(assets) > softLimit && !GrowAssetMemory(assets)) {
+		for (u32 evictionIndex = 0;
+			evictionIndex < ASSET_MEMORY_MAX_EVICTIONS_PER_FRAME && GetAssetMemoryOccupiedSize(assets) > softLimit;
+			evictionIndex++
+			) {
+			if (!EvictAsset(assets)) {
 				break;
 			}
-			leastUsed = leastUsed->prev;
 		}
-		Assert(evicted && "Holy crap, we ran out of memory and we cannot evict more assets!");
-		break;
+	}
+	EndAssetMemoryLock(assets);
+}
+
+internal
+AssetMemoryStats GetAssetMemoryStats(Assets& assets) {
+	BeginAssetMemoryLock(assets);
+	AssetMemoryStats result = assets.memoryStats;
+	result.recentTargetSize = assets.recentTargetSize;
+	if (assets.freeFirstLevelMask) {
+		// NOTE: Largest block sits in the highest non empty bin, only that bin has to be walked
+		u32 firstLevel = MostSignificantHighBit(assets.freeFirstLevelMask).index;
+		u32 secondLevel = MostSignificantHighBit(assets.freeSecondLevelMasks[firstLevel]).index;
+		for (AssetMemoryBlock* block = assets.freeBlocks[firstLevel][secondLevel]; block; block = block->nextFree) {
+			result.largestFreeBlockSize = Maximum(result.largestFreeBlockSize, block->totalSize);
+		}
 	}
 	EndAssetMemoryLock(assets);
 	return result;
@@ -492,18 +1175,17 @@ bool PrefetchBitmap(Assets& assets, BitmapId bid, bool immediate) {
 	if (!IsValid(bid) || !NeedsFetching(asset)) {
 		return false;
 	}
-	TaskWithMemory* task = 0;
+	LoadAssetTaskArgs* load = 0;
 	if (!immediate) {
-		AssertMainThread;
-		task = TryBeginBackgroundTask(assets.tranState);
-		if (!task) {
+		load = TryBeginAssetLoad(assets);
+		if (!load) {
 			return false;
 		}
 	}
 #if 1
 	if (AtomicCompareExchange(&asset.state, AssetState_Pending, AssetState_NotReady) != AssetState_NotReady) {
-		if (task) {
-			EndBackgroundTask(task);
+		if (load) {
+			EndAssetLoad(load);
 		}
 		return false;
 	}
@@ -511,14 +1193,41 @@ bool PrefetchBitmap(Assets& assets, BitmapId bid, bool immediate) {
 	asset.state = AssetState_Pending;
 	WriteCompilatorFence;
 	AssetFileBitmapInfo* metadata = &GetAssetMetadata(assets, asset.metadataId)->_bitmapInfo;
-	u32 assetSize = metadata->pitch * metadata->height;
-	u32 allocSize = assetSize + sizeof(AssetMemoryHeader);
+	// NOTE: Whole mip chain comes with the bitmap in one read, it is a third of level 0 at most
+	u32 mipsSize = metadata->mipCount * sizeof(LoadedBitmap);
+	u32 assetSize = metadata->pitch * metadata->height +
+		GetBitmapMipChainSize(metadata->width, metadata->height, metadata->mipCount);
+	u8* mappedPayload = GetMappedAssetData(assets, asset.fileSourceIndex, metadata->dataOffset,
+		metadata->compressedSize ? metadata->compressedSize : assetSize);
+	u8* mappedData = metadata->compressedSize ? 0 : mappedPayload;
+	u8* compressed = AcquireCompressedPayload(assets, mappedPayload, metadata->compressedSize);
+	if (metadata->compressedSize && !compressed) {
+		if (load) {
+			EndAssetLoad(load);
+		}
+		WriteCompilatorFence;
+		asset.state = AssetState_NotReady;
+		return false;
+	}
+	// NOTE: Tiled layout is built in place after the read, it needs the padded size
+	bool tileBitmap = !mappedData && DEBUG_Assets_TiledBitmaps && metadata->width <= BITMAP_MAX_TILED_WIDTH;
+	u32 memorySize = mappedData ? 0 : assetSize;
+	if (tileBitmap) {
+		memorySize = 0;
+		for (u32 level = 0; level <= metadata->mipCount; level++) {
+			memorySize += GetTiledBitmapSize(metadata->width >> level, metadata->height >> level);
+		}
+	}
+	u32 allocSize = memorySize + mipsSize + sizeof(AssetMemoryHeader);
 	asset.memory = ptrcast(AssetMemoryHeader, AcquireAssetMemory(assets, allocSize));
 	if (!asset.memory) {
 		// Note AcquireAssetMemory might fail, in such case we need to gracefully fallback 
 		// in callee code
-		if (task) {
-			EndBackgroundTask(task);
+		if (compressed && !mappedPayload) {
+			ReleaseAssetStaging(assets, compressed, metadata->compressedSize);
+		}
+		if (load) {
+			EndAssetLoad(load);
 		}
 		WriteCompilatorFence;
 		asset.state = AssetState_NotReady;
@@ -529,14 +1238,30 @@ bool PrefetchBitmap(Assets& assets, BitmapId bid, bool immediate) {
 	asset.memory->bitmap.width = metadata->width;
 	asset.memory->bitmap.pitch = metadata->pitch;
 	asset.memory->bitmap.widthOverHeight = f4(metadata->width) / f4(metadata->height);
-	asset.memory->bitmap.data = ptrcast(u32, asset.memory + 1);
+	asset.memory->bitmap.mipCount = metadata->mipCount;
+	asset.memory->bitmap.mips = ptrcast(LoadedBitmap, asset.memory + 1);
+	asset.memory->bitmap.data = mappedData ? ptrcast(u32, mappedData) : ptrcast(u32, asset.memory->bitmap.mips + metadata->mipCount);
 	asset.memory->bitmap.textureHandle = 0;
+	asset.memory->bitmap.flags = 0;
+	u8* mipData = ptrcast(u8, asset.memory->bitmap.data) + metadata->pitch * metadata->height;
+	for (u32 level = 1; level <= metadata->mipCount; level++) {
+		LoadedBitmap* mip = asset.memory->bitmap.mips + level - 1;
+		*mip = {};
+		mip->width = metadata->width >> level;
+		mip->height = metadata->height >> level;
+		mip->pitch = mip->width * BITMAP_BYTES_PER_PIXEL;
+		mip->widthOverHeight = asset.memory->bitmap.widthOverHeight;
+		mip->align = metadata->alignment;
+		mip->data = ptrcast(u32, mipData);
+		mipData += mip->pitch * mip->height;
+	}
 	asset.memory->type = AssetData_Bitmap;
 	asset.memory->assetIndex = bid.id;
 	asset.memory->totalSize = allocSize;
-	asset.memory->generationId = 0;
+	asset.memory->mappedData = mappedData;
+	asset.memory->mappedSize = mappedData ? assetSize : 0;
 	
-	LockedAddMemoryHeaderToList(assets, asset.memory);
+	InsertResidentAsset(assets, asset.memory);
 
 	LoadAssetTaskArgs stackDeclaration;
 	LoadAssetTaskArgs* args = 0;
@@ -545,25 +1270,29 @@ bool PrefetchBitmap(Assets& assets, BitmapId bid, bool immediate) {
 		args = &stackDeclaration;
 	}
 	else {
-		AssertMainThread;
-		args = PushStructSize(task->arena, LoadAssetTaskArgs);
+		args = load;
 	}
 	args->source = GetAssetSource(assets, asset.fileSourceIndex);
 	args->offset = metadata->dataOffset;
 	args->size = assetSize;
 	args->buffer = asset.memory->bitmap.data;
-	args->task = task;
+	args->memory = asset.memory;
 	args->state = &asset.state;
 	args->type = AssetData_Bitmap;
 	args->bitmap = &asset.memory->bitmap;
+	args->tileBitmap = tileBitmap;
+	args->mapped = mappedData != 0;
+	args->compressed = compressed;
+	args->compressedSize = metadata->compressedSize;
+	args->stagingBlock = compressed && !mappedPayload;
+	args->shuffled = false;
+	args->assets = &assets;
 
 	if (immediate) {
 		LoadAssetBackgroundTask(args);
 	}
 	else {
-		WriteCompilatorFence;
-		AssertMainThread;
-		Platform->QueuePushTask(assets.tranState->lowPriorityQueue, LoadAssetBackgroundTask, args);
+		SubmitAssetLoad(assets, args);
 	}
 	return true;
 }
@@ -574,17 +1303,17 @@ bool PrefetchSound(Assets& assets, SoundId sid, bool immediate) {
 	if (!IsValid(sid) || !NeedsFetching(asset)) {
 		return false;
 	}
-	TaskWithMemory* task = 0;
+	LoadAssetTaskArgs* load = 0;
 	if (!immediate) {
-		task = TryBeginBackgroundTask(assets.tranState);
-		if (!task) {
+		load = TryBeginAssetLoad(assets);
+		if (!load) {
 			return false;
 		}
 	}
 #if 1
 	if (AtomicCompareExchange(&asset.state, AssetState_Pending, AssetState_NotReady) != AssetState_NotReady) {
-		if (task) {
-			EndBackgroundTask(task);
+		if (load) {
+			EndAssetLoad(load);
 		}
 		return false;
 	}
@@ -594,13 +1323,28 @@ bool PrefetchSound(Assets& assets, SoundId sid, bool immediate) {
 	AssetFileSoundInfo* metadata = &GetAssetMetadata(assets, asset.metadataId)->_soundInfo;
 	u32 assetSize = (metadata->sampleCount + SOUND_CHUNK_SAMPLE_OVERLAP) * 
 		metadata->nChannels * sizeof(f32);
-	u32 allocSize = assetSize + sizeof(AssetMemoryHeader);
+	u8* mappedPayload = GetMappedAssetData(assets, asset.fileSourceIndex, metadata->samplesOffset[0],
+		metadata->compressedSize ? metadata->compressedSize : assetSize);
+	u8* mappedData = metadata->compressedSize ? 0 : mappedPayload;
+	u8* compressed = AcquireCompressedPayload(assets, mappedPayload, metadata->compressedSize);
+	if (metadata->compressedSize && !compressed) {
+		if (load) {
+			EndAssetLoad(load);
+		}
+		WriteCompilatorFence;
+		asset.state = AssetState_NotReady;
+		return false;
+	}
+	u32 allocSize = (mappedData ? 0 : assetSize) + sizeof(AssetMemoryHeader);
 	asset.memory = ptrcast(AssetMemoryHeader, AcquireAssetMemory(assets, allocSize));
 	if (!asset.memory) {
 		// Note AcquireAssetMemory might fail, in such case we need to gracefully fallback 
 		// in callee code
-		if (task) {
-			EndBackgroundTask(task);
+		if (compressed && !mappedPayload) {
+			ReleaseAssetStaging(assets, compressed, metadata->compressedSize);
+		}
+		if (load) {
+			EndAssetLoad(load);
 		}
 		WriteCompilatorFence;
 		asset.state = AssetState_NotReady;
@@ -608,13 +1352,14 @@ bool PrefetchSound(Assets& assets, SoundId sid, bool immediate) {
 	}
 	asset.memory->sound.nChannels = metadata->nChannels;
 	asset.memory->sound.sampleCount = metadata->sampleCount;
-	asset.memory->sound.samples[0] = ptrcast(f32, asset.memory + 1);
+	asset.memory->sound.samples[0] = mappedData ? ptrcast(f32, mappedData) : ptrcast(f32, asset.memory + 1);
 	asset.memory->sound.samples[1] = asset.memory->sound.samples[0] + metadata->sampleCount + SOUND_CHUNK_SAMPLE_OVERLAP;
 	asset.memory->type = AssetData_Sound;
 	asset.memory->assetIndex = sid.id;
 	asset.memory->totalSize = allocSize;
-	asset.memory->generationId = 0;
-	LockedAddMemoryHeaderToList(assets, asset.memory);
+	asset.memory->mappedData = mappedData;
+	asset.memory->mappedSize = mappedData ? assetSize : 0;
+	InsertResidentAsset(assets, asset.memory);
 
 	LoadAssetTaskArgs stackDeclaration;
 	LoadAssetTaskArgs* args = 0;
@@ -623,23 +1368,28 @@ bool PrefetchSound(Assets& assets, SoundId sid, bool immediate) {
 		args = &stackDeclaration;
 	}
 	else {
-		args = PushStructSize(task->arena, LoadAssetTaskArgs);
+		args = load;
 	}
 	args->source = GetAssetSource(assets, asset.fileSourceIndex);
 	args->offset = metadata->samplesOffset[0];
 	args->size = assetSize;
 	args->buffer = asset.memory->sound.samples[0];
-	args->task = task;
+	args->memory = asset.memory;
 	args->state = &asset.state;
 	args->type = AssetData_Sound;
 	args->bitmap = 0;
+	args->mapped = mappedData != 0;
+	args->compressed = compressed;
+	args->compressedSize = metadata->compressedSize;
+	args->stagingBlock = compressed && !mappedPayload;
+	args->shuffled = compressed && metadata->payloadFilter == AssetPayloadFilter_Shuffle4;
+	args->assets = &assets;
 
 	if (immediate) {
-		LoadAssetBackgroundTask(&args);
+		LoadAssetBackgroundTask(args);
 	}
 	else {
-		WriteCompilatorFence;
-		Platform->QueuePushTask(assets.tranState->lowPriorityQueue, LoadAssetBackgroundTask, args);
+		SubmitAssetLoad(assets, args);
 	}
 	return true;
 }
@@ -650,18 +1400,17 @@ bool PrefetchFont(Assets& assets, FontId fid, bool immediate) {
 	if (!IsValid(fid) || !NeedsFetching(asset)) {
 		return false;
 	}
-	TaskWithMemory* task = 0;
+	LoadAssetTaskArgs* load = 0;
 	if (!immediate) {
-		AssertMainThread;
-		task = TryBeginBackgroundTask(assets.tranState);
-		if (!task) {
+		load = TryBeginAssetLoad(assets);
+		if (!load) {
 			return false;
 		}
 	}
 #if 1
 	if (AtomicCompareExchange(&asset.state, AssetState_Pending, AssetState_NotReady) != AssetState_NotReady) {
-		if (task) {
-			EndBackgroundTask(task);
+		if (load) {
+			EndAssetLoad(load);
 		}
 		return false;
 	}
@@ -672,13 +1421,26 @@ bool PrefetchFont(Assets& assets, FontId fid, bool immediate) {
 	u32 codePointDataSize = metadata->onePastMaxCodepoint * sizeof(((LoadedFont*)0)->codepointToLogicalIndex[0]);
 	u32 kerningTableSize = metadata->onePastMaxLogicalIndex * metadata->onePastMaxLogicalIndex * sizeof(((LoadedFont*)0)->kerningTable[0]);
 	u32 assetSize = codePointDataSize + kerningTableSize;;
+	u8* mappedPayload = GetMappedAssetData(assets, asset.fileSourceIndex, metadata->dataOffset, metadata->compressedSize);
+	u8* compressed = AcquireCompressedPayload(assets, mappedPayload, metadata->compressedSize);
+	if (metadata->compressedSize && !compressed) {
+		if (load) {
+			EndAssetLoad(load);
+		}
+		WriteCompilatorFence;
+		asset.state = AssetState_NotReady;
+		return false;
+	}
 	u32 allocSize = assetSize + sizeof(AssetMemoryHeader);
 	asset.memory = ptrcast(AssetMemoryHeader, AcquireAssetMemory(assets, allocSize));
 	if (!asset.memory) {
 		// Note AcquireAssetMemory might fail, in such case we need to gracefully fallback 
 		// in callee code
-		if (task) {
-			EndBackgroundTask(task);
+		if (compressed && !mappedPayload) {
+			ReleaseAssetStaging(assets, compressed, metadata->compressedSize);
+		}
+		if (load) {
+			EndAssetLoad(load);
 		}
 		WriteCompilatorFence;
 		asset.state = AssetState_NotReady;
@@ -687,7 +1449,8 @@ bool PrefetchFont(Assets& assets, FontId fid, bool immediate) {
 	asset.memory->type = AssetData_Font;
 	asset.memory->assetIndex = fid.id;
 	asset.memory->totalSize = allocSize;
-	asset.memory->generationId = 0;
+	asset.memory->mappedData = 0;
+	asset.memory->mappedSize = 0;
 	asset.memory->font.codepointToLogicalIndex = ptrcast(u16, asset.memory + 1);
 	asset.memory->font.kerningTable = ptrcast(u8, asset.memory->font.codepointToLogicalIndex + metadata->onePastMaxCodepoint);
 	asset.memory->font.onePastMaxCodepoint = metadata->onePastMaxCodepoint;
@@ -695,7 +1458,7 @@ bool PrefetchFont(Assets& assets, FontId fid, bool immediate) {
 	asset.memory->font.metrics = metadata->metrics;
 	asset.memory->font.logicalIndexBaseForGlyphs = metadata->logicalIndexBaseForGlyphs;
 
-	LockedAddMemoryHeaderToList(assets, asset.memory);
+	InsertResidentAsset(assets, asset.memory);
 
 	LoadAssetTaskArgs stackDeclaration;
 	LoadAssetTaskArgs* args = 0;
@@ -704,54 +1467,313 @@ bool PrefetchFont(Assets& assets, FontId fid, bool immediate) {
 		args = &stackDeclaration;
 	}
 	else {
-		AssertMainThread;
-		args = PushStructSize(task->arena, LoadAssetTaskArgs);
+		args = load;
 	}
 	args->source = GetAssetSource(assets, asset.fileSourceIndex);
 	args->offset = metadata->dataOffset;
 	args->size = assetSize;
 	args->buffer = asset.memory->font.codepointToLogicalIndex;
-	args->task = task;
+	args->memory = asset.memory;
 	args->state = &asset.state;
 	args->type = AssetData_Font;
 	args->bitmap = 0;
+	args->mapped = false;
+	args->compressed = compressed;
+	args->compressedSize = metadata->compressedSize;
+	args->stagingBlock = compressed && !mappedPayload;
+	args->shuffled = false;
+	args->assets = &assets;
 
 	if (immediate) {
 		LoadAssetBackgroundTask(args);
 	}
 	else {
-		WriteCompilatorFence;
-		AssertMainThread;
-		Platform->QueuePushTask(assets.tranState->lowPriorityQueue, LoadAssetBackgroundTask, args);
+		SubmitAssetLoad(assets, args);
 	}
 	return true;
 }
 
+internal
+void WidenAssetMetadata(AssetMetadataV1* src, AssetMetadata* dst, AssetGroupType type) {
+	*dst = {};
+	if (type == AssetGroup_Bitmap) {
+		AssetFileBitmapInfoV1* info = &src->_bitmapInfo;
+		dst->_bitmapInfo.height = info->height;
+		dst->_bitmapInfo.width = info->width;
+		dst->_bitmapInfo.pitch = info->pitch;
+		dst->_bitmapInfo.alignment = info->alignment;
+		dst->_bitmapInfo.dataSizeInBytes = info->dataSizeInBytes;
+		dst->_bitmapInfo.dataOffset = info->dataOffset;
+		dst->_bitmapInfo.mipCount = info->mipCount;
+	}
+	else if (type == AssetGroup_Sound) {
+		AssetFileSoundInfoV1* info = &src->_soundInfo;
+		dst->_soundInfo.sampleCount = info->sampleCount;
+		dst->_soundInfo.nChannels = u16(info->nChannels);
+		dst->_soundInfo.chain = info->chain;
+		dst->_soundInfo.dataSizeInBytes = info->dataSizeInBytes;
+		dst->_soundInfo.samplesOffset[0] = info->samplesOffset[0];
+		dst->_soundInfo.samplesOffset[1] = info->samplesOffset[1];
+	}
+	else if (type == AssetGroup_Font) {
+		AssetFileFontInfoV1* info = &src->_fontInfo;
+		dst->_fontInfo.onePastMaxCodepoint = info->onePastMaxCodepoint;
+		dst->_fontInfo.onePastMaxLogicalIndex = info->onePastMaxLogicalIndex;
+		dst->_fontInfo.logicalIndexBaseForGlyphs = info->logicalIndexBaseForGlyphs;
+		dst->_fontInfo.metrics = info->metrics;
+		dst->_fontInfo.dataOffset = info->dataOffset;
+	}
+}
+
+// NOTE: Table of contents of most packs fits in the first read
+#define ASSET_TOC_PREFETCH_SIZE kB(64)
+
 struct AssetFileSource {
 	AssetFileHeader header;
-	u32 fontGlyphAssetCountOffset;
+	// NOTE: Header, groups, features and metadata of the file, either mapped or read with one request
+	u8* toc;
+	u32 tocSize;
+	bool ownsToc;
+	bool valid;
+	// NOTE: Index of the first asset of every file's group in the combined tables
+	u32 combinedFirstAssetIndex[Asset_Count];
+};
+
+struct MergeAssetTocArgs {
+	Assets* assets;
+	AssetFileSource* source;
+	u32 fileIndex;
 };
 
 internal
-void AllocateAssets(TransientState* tranState) {
-	u32 assetsCount = 0;
-	PlatformFileGroup* fileGroup = Platform->FileOpenAllWithExtension("assf");
-	// NOTE: Read how many assets do we have at all first!
+void ReadAssetFileTocPrefix(Assets& assets, PlatformFileGroup* fileGroup, AssetFileSource* sources) {
+	// NOTE: Prefixes of all files are queued together, so they go to the kernel as one batch
+	u32 pendingCount = 0;
 	for (u32 fileIndex = 0; fileIndex < fileGroup->count; fileIndex++) {
+		AssetFileSource* source = sources + fileIndex;
 		PlatformFileHandle* file = *(fileGroup->files + fileIndex);
-		AssetFileHeader header;
-		Platform->FileRead(file, 0, sizeof(header), &header);
-		if (Platform->FileErrors(file) ||
-			header.magicString != EAF_MAGIC_STRING('a', 's', 's', 'f') ||
-			header.version != 0) {
-			// TODO: Inform user about IO error
+		u8* mapped = assets.mappedSources ? assets.mappedSources[fileIndex] : 0;
+		source->valid = file && file->size >= sizeof(AssetFileHeader);
+		if (!source->valid) {
+			continue;
+		}
+		if (mapped) {
+			source->toc = mapped;
+			source->tocSize = u4(Minimum(file->size, u64(U32_MAX)));
+			source->ownsToc = false;
 			continue;
 		}
-		// NOTE: First asset is null asset, it shouldn't be taken into account
-		assetsCount += header.assetsCount - 1;
+		source->tocSize = u4(Minimum(file->size, u64(ASSET_TOC_PREFETCH_SIZE)));
+		source->toc = ptrcast(u8, Platform->MemoryAllocate(source->tocSize));
+		source->ownsToc = true;
+		if (Platform->FileReadAsync(file, 0, source->tocSize, source->toc, source)) {
+			pendingCount++;
+		}
+		else {
+			Platform->FileRead(file, 0, source->tocSize, source->toc);
+			source->valid = !Platform->FileErrors(file);
+		}
+	}
+	// NOTE: Nothing else reads through the async API before assets are allocated, main thread sleeps
+	// in the poll until every table is in
+	PlatformFileReadCompletion completions[32];
+	while (pendingCount) {
+		u32 completionCount = Platform->FileReadAsyncPoll(completions, ArrayCount(completions), true);
+		for (u32 completionIndex = 0; completionIndex < completionCount; completionIndex++) {
+			PlatformFileReadCompletion* completion = completions + completionIndex;
+			AssetFileSource* source = ptrcast(AssetFileSource, completion->userData);
+			Assert(source >= sources && source < sources + fileGroup->count);
+			source->valid = !completion->failed && completion->readBytes == source->tocSize;
+			pendingCount--;
+		}
+	}
+}
+
+internal
+bool ValidateAssetFileToc(AssetFileSource* source, PlatformFileHandle* file) {
+	AssetFileHeader* header = &source->header;
+	CopySize(source->toc, header, sizeof(AssetFileHeader));
+	if (header->magicString != EAF_MAGIC_STRING('a', 's', 's', 'f') ||
+		header->version > EAF_VERSION ||
+		header->assetsCount == 0) {
+		return false;
+	}
+	u64 metadataSize = header->version < 2 ? sizeof(AssetMetadataV1) : sizeof(AssetMetadata);
+	u64 tocSize = Maximum(header->assetGroupsOffset + sizeof(AssetGroup) * Asset_Count,
+		header->featuresOffset + sizeof(AssetFeatures) * header->assetsCount);
+	tocSize = Maximum(tocSize, header->assetMetadatasOffset + metadataSize * header->assetsCount);
+	if (tocSize > file->size || tocSize > U32_MAX) {
+		return false;
+	}
+	if (tocSize > source->tocSize) {
+		// NOTE: Table didn't fit in the prefix, read the rest of it
+		u8* toc = ptrcast(u8, Platform->MemoryAllocate(u4(tocSize)));
+		CopySize(source->toc, toc, source->tocSize);
+		Platform->FileRead(file, source->tocSize, tocSize - source->tocSize, toc + source->tocSize);
+		Platform->MemoryFree(source->toc);
+		source->toc = toc;
+		source->tocSize = u4(tocSize);
+		if (Platform->FileErrors(file)) {
+			return false;
+		}
+	}
+	AssetGroup* groups = ptrcast(AssetGroup, source->toc + header->assetGroupsOffset);
+	for (u32 groupIndex = 1; groupIndex < Asset_Count; groupIndex++) {
+		AssetGroup* group = groups + groupIndex;
+		if (group->firstAssetIndex > group->onePastLastAssetIndex ||
+			group->onePastLastAssetIndex > header->assetsCount) {
+			return false;
+		}
+	}
+	return true;
+}
+
+internal
+void MergeAssetFileTocTask(void* data) {
+	TIMED_FUNCTION;
+	MergeAssetTocArgs* args = ptrcast(MergeAssetTocArgs, data);
+	Assets& assets = *args->assets;
+	AssetFileSource* source = args->source;
+	AssetFileHeader* header = &source->header;
+	AssetGroup* fileAssetGroups = ptrcast(AssetGroup, source->toc + header->assetGroupsOffset);
+	AssetFeatures* fileFeatures = ptrcast(AssetFeatures, source->toc + header->featuresOffset);
+	u8* fileMetadatas = source->toc + header->assetMetadatasOffset;
+	for (u32 groupIndex = 1; groupIndex < Asset_Count; groupIndex++) {
+		AssetGroup* fileAssetGroup = fileAssetGroups + groupIndex;
+		u32 fileAssetCountInGroup = fileAssetGroup->onePastLastAssetIndex - fileAssetGroup->firstAssetIndex;
+		u32 dstIndex = source->combinedFirstAssetIndex[groupIndex];
+		CopySize(fileFeatures + fileAssetGroup->firstAssetIndex, assets.features + dstIndex,
+			sizeof(AssetFeatures) * fileAssetCountInGroup);
+		if (header->version < 2) {
+			AssetMetadataV1* legacyMetadatas = ptrcast(AssetMetadataV1, fileMetadatas) + fileAssetGroup->firstAssetIndex;
+			for (u32 baseIndex = 0; baseIndex < fileAssetCountInGroup; baseIndex++) {
+				WidenAssetMetadata(legacyMetadatas + baseIndex, assets.metadatas + dstIndex + baseIndex, fileAssetGroup->type);
+			}
+		}
+		else {
+			CopySize(ptrcast(AssetMetadata, fileMetadatas) + fileAssetGroup->firstAssetIndex, assets.metadatas + dstIndex,
+				sizeof(AssetMetadata) * fileAssetCountInGroup);
+		}
+		if (fileAssetGroup->type == AssetGroup_Bitmap && header->version < 1) {
+			for (u32 baseIndex = 0; baseIndex < fileAssetCountInGroup; baseIndex++) {
+				assets.metadatas[dstIndex + baseIndex]._bitmapInfo.mipCount = 0;
+			}
+		}
+		if (header->version < 3) {
+			// NOTE: compressedSize sits in version 2 padding, older files are widened with zero there
+			for (u32 baseIndex = 0; baseIndex < fileAssetCountInGroup; baseIndex++) {
+				AssetMetadata* metadata = assets.metadatas + dstIndex + baseIndex;
+				switch (fileAssetGroup->type) {
+				case AssetGroup_Bitmap: {
+					metadata->_bitmapInfo.compressedSize = 0;
+				} break;
+				case AssetGroup_Sound: {
+					metadata->_soundInfo.compressedSize = 0;
+				} break;
+				case AssetGroup_Font: {
+					metadata->_fontInfo.compressedSize = 0;
+				} break;
+				}
+			}
+		}
+		if (groupIndex == Asset_Font) {
+			// NOTE: Font offsets have to point to the glyph bitmaps of the same file
+			u32 glyphGlobalOffsetForFile = source->combinedFirstAssetIndex[Asset_FontGlyph];
+			Assert(glyphGlobalOffsetForFile != 0);
+			for (u32 baseIndex = 0; baseIndex < fileAssetCountInGroup; baseIndex++) {
+				AssetMetadata* dstMetadata = assets.metadatas + dstIndex + baseIndex;
+				// NOTE: subtract 1, because index 0 is actually reserved for the null glyph which
+				// does not reside in memory
+				dstMetadata->_fontInfo.logicalIndexBaseForGlyphs += glyphGlobalOffsetForFile - 1;
+			}
+		}
+		for (u32 baseIndex = 0; baseIndex < fileAssetCountInGroup; baseIndex++) {
+			Asset* dstAsset = assets.assets + dstIndex + baseIndex;
+			dstAsset->fileSourceIndex = args->fileIndex;
+			dstAsset->metadataId = dstIndex + baseIndex;
+		}
+	}
+}
+
+// NOTE: Software renderer is included after the asset system in the engine build
+internal void RadixSort(SortElement* array, u32 count, SortElement* tempBuffer);
+
+internal
+void BuildAssetFeatureIndex(Assets& assets, SortElement* tempBuffer) {
+	for (u32 featureIndex = 0; featureIndex < Feature_Count; featureIndex++) {
+		SortElement* elements = assets.featureIndex[featureIndex];
+		for (u32 assetIndex = 0; assetIndex < assets.assetCount; assetIndex++) {
+			elements[assetIndex].key = FloatToRadixValue(assets.features[assetIndex][featureIndex]);
+			elements[assetIndex].offset = assetIndex;
+		}
+		// NOTE: Radix sort is stable, so equal values stay in asset order
+		for (u32 groupIndex = 1; groupIndex < Asset_Count; groupIndex++) {
+			AssetGroup* group = assets.groups + groupIndex;
+			u32 count = group->onePastLastAssetIndex - group->firstAssetIndex;
+			if (count > 1) {
+				RadixSort(elements + group->firstAssetIndex, count, tempBuffer);
+			}
+		}
 	}
+}
+
+internal
+void AllocateAssets(TransientState* tranState, AssetMemoryConfig config) {
 	Assets& assets = tranState->assets;
-	u32 memoryForAssetsSize = MB(10);
+	PlatformFileGroup* fileGroup = Platform->FileOpenAllWithExtension("assf");
+	assets.mappedSources = 0;
+	if (config.mapFiles) {
+		// NOTE: File which can't be mapped falls back to reads
+		assets.mappedSources = PushArray(tranState->arena, fileGroup->count, u8*);
+		for (u32 fileIndex = 0; fileIndex < fileGroup->count; fileIndex++) {
+			assets.mappedSources[fileIndex] = ptrcast(u8, Platform->FileMap(*(fileGroup->files + fileIndex)));
+		}
+	}
+
+	// NOTE: Every file's table of contents is read with one request, so the asset count is known
+	// before the tables are allocated and files don't have to be read twice
+	AssetFileSource* sources = ptrcast(AssetFileSource, Platform->MemoryAllocate(
+		Maximum(fileGroup->count, 1u) * sizeof(AssetFileSource)));
+	ZeroSize_(ptrcast(u8, sources), fileGroup->count * sizeof(AssetFileSource));
+	ReadAssetFileTocPrefix(assets, fileGroup, sources);
+	u32 assetsCount = 0;
+	for (u32 fileIndex = 0; fileIndex < fileGroup->count; fileIndex++) {
+		AssetFileSource* source = sources + fileIndex;
+		if (source->valid) {
+			source->valid = ValidateAssetFileToc(source, *(fileGroup->files + fileIndex));
+		}
+		if (!source->valid) {
+			// TODO: Inform user about IO error
+			continue;
+		}
+		// NOTE: Null group and null asset aren't taken into account
+		AssetGroup* groups = ptrcast(AssetGroup, source->toc + source->header.assetGroupsOffset);
+		for (u32 groupIndex = 1; groupIndex < Asset_Count; groupIndex++) {
+			assetsCount += groups[groupIndex].onePastLastAssetIndex - groups[groupIndex].firstAssetIndex;
+		}
+	}
+
+	if (!config.initialSize) {
+		config.initialSize = ASSET_MEMORY_DEFAULT_INITIAL_SIZE;
+	}
+	if (!config.maxSize) {
+		config.maxSize = Maximum(ASSET_MEMORY_DEFAULT_MAX_SIZE, config.initialSize);
+	}
+	if (!config.regionSize) {
+		config.regionSize = ASSET_MEMORY_DEFAULT_REGION_SIZE;
+	}
+	if (config.softWatermark <= 0.f) {
+		config.softWatermark = ASSET_MEMORY_DEFAULT_SOFT_WATERMARK;
+	}
+	if (config.hardWatermark <= 0.f) {
+		config.hardWatermark = ASSET_MEMORY_DEFAULT_HARD_WATERMARK;
+	}
+	// NOTE: Budget never shrinks below the first region, watermarks are fractions and the soft one
+	// can't be above the hard one
+	config.maxSize = Maximum(config.maxSize, config.initialSize);
+	config.hardWatermark = Clamp01(config.hardWatermark);
+	config.softWatermark = Minimum(Clamp01(config.softWatermark), config.hardWatermark);
+	u32 memoryForAssetsSize = config.initialSize;
 	assets.nextGenerationId.id = 0;
 	assets.inFlightGenerationCount = 0;
 	assets.memoryLock = 0;
@@ -759,91 +1781,62 @@ void AllocateAssets(TransientState* tranState) {
 	assets.assetCount = assetsCount + 1;
 	assets.assets = PushArray(tranState->arena, assets.assetCount, Asset);
 	assets.features = PushArray(tranState->arena, assets.assetCount, AssetFeatures);
+	for (u32 featureIndex = 0; featureIndex < Feature_Count; featureIndex++) {
+		assets.featureIndex[featureIndex] = PushArray(tranState->arena, assets.assetCount, SortElement);
+	}
+	ZeroStruct(assets.bestFitMemo);
+	assets.bestFitFrameIndex = 1;
 	assets.metadatas = PushArray(tranState->arena, assets.assetCount, AssetMetadata);
 	assets.sources = fileGroup;
-	assets.lruSentinel.next = &assets.lruSentinel;
-	assets.lruSentinel.prev = &assets.lruSentinel;
+	assets.oldestInFlightGenerationId = U32_MAX;
+	assets.recentSentinel.next = &assets.recentSentinel;
+	assets.recentSentinel.prev = &assets.recentSentinel;
+	assets.frequentSentinel.next = &assets.frequentSentinel;
+	assets.frequentSentinel.prev = &assets.frequentSentinel;
+	ZeroStruct(assets.recentGhosts);
+	ZeroStruct(assets.frequentGhosts);
+	assets.recentTargetSize = 0;
 	assets.memorySentinel.next = &assets.memorySentinel;
 	assets.memorySentinel.prev = &assets.memorySentinel;
 	assets.memorySentinel.remainingSize = 0;
 	assets.memorySentinel.totalSize = 0;
 	assets.memorySentinel.flags = 0;
+	assets.freeFirstLevelMask = 0;
+	ZeroStruct(assets.freeSecondLevelMasks);
+	ZeroStruct(assets.freeBlocks);
+	ZeroStruct(assets.memoryStats);
+	assets.memoryStats.totalSize = memoryForAssetsSize;
+	assets.memoryStats.regionCount = 1;
+	assets.memoryConfig = config;
+	// NOTE: Only address space is reserved here, regions are committed when the budget grows
+	assets.reservedSize = config.maxSize - config.initialSize;
+	assets.reservedMemory = 0;
+	assets.committedSize = 0;
+	if (assets.reservedSize >= config.regionSize) {
+		assets.reservedMemory = ptrcast(u8, Platform->MemoryReserve(assets.reservedSize));
+	}
 
 	void* firstBlock = PushSize(tranState->arena, memoryForAssetsSize);
-	InsertNewMemoryBlock(&assets.memorySentinel, firstBlock, memoryForAssetsSize);
+	InsertNewMemoryBlock(assets, &assets.memorySentinel, firstBlock, memoryForAssetsSize);
 
-	TemporaryMemory scratchMemory = BeginTempMemory(tranState->arena);
-	AssetFileSource* sources = PushArray(tranState->arena, fileGroup->count, AssetFileSource);
-	// NOTE: Read the headers first!
-	for (u32 fileIndex = 0; fileIndex < fileGroup->count; fileIndex++) {
-		AssetFileHeader* header = &(sources + fileIndex)->header;
-		PlatformFileHandle* file = *(fileGroup->files + fileIndex);
-		Platform->FileRead(file, 0, sizeof(AssetFileHeader), header);
-		if (Platform->FileErrors(file) ||
-			header->magicString != EAF_MAGIC_STRING('a', 's', 's', 'f') ||
-			header->version != 0) {
-			// TODO: Inform user about IO error
-			continue;
-		}
+	for (u32 loadIndex = 0; loadIndex < ArrayCount(assets.loads); loadIndex++) {
+		assets.loads[loadIndex].done = 1;
 	}
 
+	TemporaryMemory scratchMemory = BeginTempMemory(tranState->arena);
 	// NOTE: The first asset is NULL asset, so readAssetsCount must start from first NON NULL asset
 	// NOTE: Also, first group in the file is NULL group, so start from NON NULL group
 	u32 readAssetsCount = 1;
 	for (u32 groupIndex = 1; groupIndex < Asset_Count; groupIndex++) {
 		AssetGroup* combinedAssetGroup = assets.groups + groupIndex;
-		AssetGroup* fileAssetGroup = PushStructSize(tranState->arena, AssetGroup);
-
 		for (u32 fileIndex = 0; fileIndex < fileGroup->count; fileIndex++) {
-			PlatformFileHandle* file = *(fileGroup->files + fileIndex);
-			AssetFileHeader* header = &(sources + fileIndex)->header;
-
-			Platform->FileRead(
-				file,
-				u4(header->assetGroupsOffset) + sizeof(AssetGroup) * groupIndex,
-				sizeof(AssetGroup),
-				fileAssetGroup
-			);
-			Assert(fileAssetGroup->firstAssetIndex < header->assetsCount);
-			u32 fileAssetCountInGroup = fileAssetGroup->onePastLastAssetIndex - fileAssetGroup->firstAssetIndex;
-
-			Platform->FileRead(
-				file,
-				u4(header->featuresOffset) + sizeof(AssetFeatures) * fileAssetGroup->firstAssetIndex,
-				sizeof(AssetFeatures) * fileAssetCountInGroup,
-				assets.features + readAssetsCount
-			);
-			Platform->FileRead(
-				file,
-				u4(header->assetMetadatasOffset) + sizeof(AssetMetadata) * fileAssetGroup->firstAssetIndex,
-				sizeof(AssetMetadata) * fileAssetCountInGroup,
-				assets.metadatas + readAssetsCount
-			);
-			if (Platform->FileErrors(file)) {
-				// TODO: Inform user about IO error
+			AssetFileSource* source = sources + fileIndex;
+			if (!source->valid) {
 				continue;
 			}
-			if (groupIndex == Asset_FontGlyph) {
-				static_assert(Asset_FontGlyph < Asset_Font && "When Font are loaded, it needs information"
-					"about its glyphs offset to work properly, so this condition asserts that");
-				// NOTE: That information is important for Font offsets to point to correct bitmaps
-				sources[fileIndex].fontGlyphAssetCountOffset = readAssetsCount;
-			}
-			else if (groupIndex == Asset_Font) {
-				u32 glyphGlobalOffsetForFile = sources[fileIndex].fontGlyphAssetCountOffset;
-				Assert(glyphGlobalOffsetForFile != 0);
-				for (u32 baseIndex = 0; baseIndex < fileAssetCountInGroup; baseIndex++) {
-					AssetMetadata* dstMetadata = assets.metadatas + readAssetsCount + baseIndex;
-					// NOTE: subtract 1, because index 0 is actually reserved for the null glyph which
-					// does not reside in memory
-					dstMetadata->_fontInfo.logicalIndexBaseForGlyphs += glyphGlobalOffsetForFile - 1;
-				}
-			}
-			for (u32 baseIndex = 0; baseIndex < fileAssetCountInGroup; baseIndex++) {
-				Asset* dstAsset = assets.assets + readAssetsCount + baseIndex;
-				dstAsset->fileSourceIndex = fileIndex;
-				dstAsset->metadataId = readAssetsCount + baseIndex;
-			}
+			AssetGroup* fileAssetGroup = ptrcast(AssetGroup, source->toc + source->header.assetGroupsOffset) + groupIndex;
+			u32 fileAssetCountInGroup = fileAssetGroup->onePastLastAssetIndex - fileAssetGroup->firstAssetIndex;
+			source->combinedFirstAssetIndex[groupIndex] = readAssetsCount;
 			u32 combinedAssetGroupCount = combinedAssetGroup->onePastLastAssetIndex - combinedAssetGroup->firstAssetIndex;
 			if (combinedAssetGroupCount == 0) {
 				combinedAssetGroup->firstAssetIndex = readAssetsCount;
@@ -858,12 +1851,36 @@ void AllocateAssets(TransientState* tranState) {
 	}
 	Assert(assets.assetCount == readAssetsCount);
 
+	// NOTE: Placement is known now, every file is copied into its own ranges of the tables
+	PlatformJobCounter mergeCounter = {};
+	MergeAssetTocArgs* mergeArgs = PushArray(tranState->arena, fileGroup->count, MergeAssetTocArgs);
+	for (u32 fileIndex = 0; fileIndex < fileGroup->count; fileIndex++) {
+		if (!sources[fileIndex].valid) {
+			continue;
+		}
+		MergeAssetTocArgs* args = mergeArgs + fileIndex;
+		args->assets = &assets;
+		args->source = sources + fileIndex;
+		args->fileIndex = fileIndex;
+		Platform->QueuePushTask(tranState->highPriorityQueue, MergeAssetFileTocTask, args, &mergeCounter);
+	}
+	Platform->QueueWaitForCounter(tranState->highPriorityQueue, &mergeCounter);
+
+	for (u32 fileIndex = 0; fileIndex < fileGroup->count; fileIndex++) {
+		if (sources[fileIndex].ownsToc) {
+			Platform->MemoryFree(sources[fileIndex].toc);
+		}
+	}
+	Platform->MemoryFree(sources);
+
 	for (u32 groupIndex = 1; groupIndex < Asset_Count; groupIndex++) {
 		AssetGroup* assetGroup = assets.groups + groupIndex;
 		if (assetGroup->firstAssetIndex == assetGroup->onePastLastAssetIndex) {
 			assetGroup->firstAssetIndex = assetGroup->onePastLastAssetIndex = 0;
 		}
 	}
+	SortElement* sortTempBuffer = PushArray(tranState->arena, assets.assetCount, SortElement);
+	BuildAssetFeatureIndex(assets, sortTempBuffer);
 
 	// NOTE: Keep files open!
 	EndTempMemory(scratchMemory);
@@ -2,6 +2,12 @@
 #include "engine_common.h"
 #include "engine_rand.h"
 
+enum LoadedBitmapFlags {
+	LoadedBitmap_AlphaTested = 0x1, // NOTE: Every texel alpha is either 0 or 255
+	LoadedBitmap_Opaque = 0x2, // NOTE: Every texel alpha is 255, implies AlphaTested
+	LoadedBitmap_Tiled = 0x4, // NOTE: Texels are stored in 4x4 blocks, see GetTexelOffset()
+};
+
 struct LoadedBitmap {
 	u32* data;
 	f32 widthOverHeight;
@@ -9,9 +15,54 @@ struct LoadedBitmap {
 	i32 width;
 	i32 pitch;
 	u32 textureHandle;
+	u32 flags;
 	V2 align; // NOTE: bottom-up in pixels
+	u32 mipCount;
+	LoadedBitmap* mips; // NOTE: Level N is mips[N - 1], every level halves both dimensions
 };
 
+// NOTE: 4x4 block of texels is one cache line, so a bilinear footprint of a rotated or minified
+// sprite touches at most four lines instead of two new ones per row. Blocks are stored row by row,
+// a row of blocks is 4 * pitch bytes, pitch and height are padded to full blocks
+#define BITMAP_TILE_SIZE 4
+#define BITMAP_MAX_TILED_WIDTH 2048
+inline
+u32 GetTexelOffset(LoadedBitmap& bitmap, u32 X, u32 Y) {
+	if (bitmap.flags & LoadedBitmap_Tiled) {
+		return (Y & ~3u) * bitmap.pitch + ((Y & 3) << 4) + ((X & ~3u) << 4) + ((X & 3) << 2);
+	}
+	return Y * bitmap.pitch + X * sizeof(u32);
+}
+
+inline
+u32 GetTiledBitmapSize(i32 width, i32 height) {
+	return u4(AlignUp4(width)) * u4(AlignUp4(height)) * sizeof(u32);
+}
+
+// NOTE: Bilinear sampling needs two texels in each direction, so the chain stops before that
+#define BITMAP_MAX_MIP_COUNT 8
+inline
+u32 GetBitmapMipCount(i32 width, i32 height) {
+	u32 mipCount = 0;
+	while (mipCount < BITMAP_MAX_MIP_COUNT &&
+		(width >> (mipCount + 1)) >= 2 &&
+		(height >> (mipCount + 1)) >= 2)
+	{
+		mipCount++;
+	}
+	return mipCount;
+}
+
+inline
+u32 GetBitmapMipChainSize(i32 width, i32 height, u32 mipCount) {
+	// NOTE: Levels 1..mipCount are tightly packed right after level 0
+	u32 result = 0;
+	for (u32 level = 1; level <= mipCount; level++) {
+		result += u4(width >> level) * u4(height >> level) * sizeof(u32);
+	}
+	return result;
+}
+
 #define SOUND_CHUNK_SAMPLE_OVERLAP 8
 struct LoadedSound {
 	u32 sampleCount;
@@ -85,7 +136,9 @@ enum AssetTypeID {
 enum AssetState {
 	AssetState_NotReady,
 	AssetState_Pending,
-	AssetState_Ready
+	AssetState_Ready,
+	// NOTE: Eviction owns the asset while it checks generations, readers treat it as not loaded
+	AssetState_Evicting
 };
 
 enum AssetDataType {
@@ -99,9 +152,15 @@ enum AssetDataType {
 using AssetFeatures = f32[Feature_Count];
 
 #define EAF_MAGIC_STRING(a, b, c, d) ((d << 24) + (c << 16) + (b << 8) + a)
+// NOTE: Version 1 added bitmap mip chains, version 0 files are still readable without them
+// NOTE: Version 2 widened data offsets to 64 bits, older metadata is widened while it is read
+// NOTE: Version 3 added LZ compressed payloads, compressedSize lives in version 2 padding
+// NOTE: Version 4 added payload filters of sounds, the filter is the upper half of the old 32 bit
+// channel count, so it is zero in older files
+#define EAF_VERSION 4
 struct AssetFileHeader {
 	u32 magicString = EAF_MAGIC_STRING('a', 's', 's', 'f');
-	u32 version = 0;
+	u32 version = EAF_VERSION;
 
 	u32 assetsCount;
 	u64 featuresOffset;
@@ -116,7 +175,9 @@ struct AssetFileBitmapInfo {
 	i32 pitch;
 	V2 alignment;
 	u32 dataSizeInBytes;
-	u32 dataOffset;
+	u64 dataOffset;
+	u32 mipCount; // NOTE: Version 0 files have garbage there
+	u32 compressedSize; // NOTE: Zero when the payload is stored raw
 };
 enum class SoundChain {
 	None,
@@ -127,12 +188,21 @@ struct SoundChainInfo {
 	u32 count;
 };
 
+enum AssetPayloadFilter {
+	AssetPayloadFilter_None,
+	// NOTE: Compressed payload is byte shuffled, see ShuffleLZBytes()
+	AssetPayloadFilter_Shuffle4,
+};
+
 struct AssetFileSoundInfo {
 	u32 sampleCount;
-	u32 nChannels;
+	u16 nChannels;
+	u16 payloadFilter;
 	SoundChainInfo chain;
 	u32 dataSizeInBytes;
-	u32 samplesOffset[2];
+	// NOTE: Both channels are compressed together, samplesOffset[1] isn't used then
+	u32 compressedSize;
+	u64 samplesOffset[2];
 };
 
 struct AssetFileFontInfo {
@@ -140,7 +210,8 @@ struct AssetFileFontInfo {
 	u16 onePastMaxLogicalIndex;
 	u32 logicalIndexBaseForGlyphs; // NOTE: BitmapId in Asset system should be logicalIndex + logicalIndexBaseForGlyphs
 	FontMetrics metrics;
-	u32 dataOffset;
+	u32 compressedSize;
+	u64 dataOffset;
 };
 
 #pragma warning(push)
@@ -153,11 +224,46 @@ struct AssetMetadata {
 	};
 };
 
+// NOTE: On-disk metadata of version 0 and 1 files
+struct AssetFileBitmapInfoV1 {
+	i32 height;
+	i32 width;
+	i32 pitch;
+	V2 alignment;
+	u32 dataSizeInBytes;
+	u32 dataOffset;
+	u32 mipCount;
+};
+struct AssetFileSoundInfoV1 {
+	u32 sampleCount;
+	u32 nChannels;
+	SoundChainInfo chain;
+	u32 dataSizeInBytes;
+	u32 samplesOffset[2];
+};
+struct AssetFileFontInfoV1 {
+	u32 onePastMaxCodepoint;
+	u16 onePastMaxLogicalIndex;
+	u32 logicalIndexBaseForGlyphs;
+	FontMetrics metrics;
+	u32 dataOffset;
+};
+struct AssetMetadataV1 {
+	union {
+		AssetFileSoundInfoV1 _soundInfo;
+		AssetFileBitmapInfoV1 _bitmapInfo;
+		AssetFileFontInfoV1 _fontInfo;
+	};
+};
+static_assert(sizeof(AssetMetadataV1) == 32, "Layout of version 1 metadata can't change");
+static_assert(sizeof(AssetMetadata) == 40, "Version 2 files are read with the current layout");
+
 struct AssetMemoryHeader {
 	u32 totalSize;
 	u32 assetIndex;
-	u32 generationId;
 	AssetDataType type;
+	u32 mappedSize;
+	u8* mappedData;
 	union {
 		LoadedBitmap bitmap;
 		LoadedSound sound;
@@ -167,16 +273,113 @@ struct AssetMemoryHeader {
 	AssetMemoryHeader* prev;
 };
 
+// NOTE: Loads don't hold a background task while their read is in flight, so the slots only
+// limit the number of reads queued at once
+#define ASSET_MAX_LOADS_IN_FLIGHT 64
+struct PlatformFileHandle;
+struct Assets;
+struct LoadAssetTaskArgs {
+	PlatformFileHandle* source;
+	void* buffer;
+	u64 offset;
+	u32 size;
+	u32* state;
+	AssetMemoryHeader* memory;
+	AssetDataType type;
+	LoadedBitmap* bitmap;
+	bool tileBitmap;
+	bool mapped;
+	// NOTE: Compressed payload is decompressed into buffer, it is either a staging block from
+	// the asset memory or a part of the mapped file
+	u8* compressed;
+	u32 compressedSize;
+	bool stagingBlock;
+	bool shuffled;
+	Assets* assets;
+	// NOTE: Set once the asynchronous read is finished, the task only finishes the asset then
+	bool readDone;
+	bool readFailed;
+	// NOTE: Immediate loads live on the stack and don't own a slot
+	bool ownsSlot;
+	volatile u32 done;
+};
+
 enum AssetMemoryBlockFlags {
 	AssetMemory_BlockUsed = 0x1,
+	// NOTE: First block of a region which isn't adjacent to the previous one, it is never merged backwards
+	AssetMemory_RegionStart = 0x2,
 };
 
 struct AssetMemoryBlock {
 	u32 remainingSize;
 	u32 totalSize;
 	u32 flags;
+	// NOTE: next/prev link blocks in address order, nextFree/prevFree link free blocks of one size class
 	AssetMemoryBlock* next;
 	AssetMemoryBlock* prev;
+	AssetMemoryBlock* nextFree;
+	AssetMemoryBlock* prevFree;
+};
+
+// NOTE: Free blocks are binned TLSF style, first level is the power of two of the size and second
+// level splits it linearly into ASSET_MEMORY_SL_COUNT classes, sizes below ASSET_MEMORY_SL_COUNT 
+// go to the first level 0
+#define ASSET_MEMORY_SL_SHIFT 4
+#define ASSET_MEMORY_SL_COUNT (1 << ASSET_MEMORY_SL_SHIFT)
+#define ASSET_MEMORY_FL_COUNT (32 - ASSET_MEMORY_SL_SHIFT + 1)
+
+enum AssetReplacementPolicy {
+	// NOTE: CAR (clock with adaptive replacement), ARC on top of reference bits so hits stay lock free.
+	// Assets referenced twice move to the frequent clock and scans only churn the recent one
+	AssetReplacement_Adaptive,
+	// NOTE: Single clock, second chance for referenced assets
+	AssetReplacement_Clock,
+};
+
+// NOTE: Filled by the platform layer, zeroed fields are replaced by the defaults
+struct AssetMemoryConfig {
+	// NOTE: First region is carved from transient memory, the rest is reserved up front and
+	// committed region by region when the budget runs low
+	u32 initialSize;
+	u32 maxSize;
+	u32 regionSize;
+	// NOTE: Fractions of the committed memory, above the soft one the budget grows or LRU assets
+	// are evicted at the end of the frame, above the hard one acquire grows the budget instead of evicting
+	f32 softWatermark;
+	f32 hardWatermark;
+	AssetReplacementPolicy replacementPolicy;
+	// NOTE: Asset files are mapped read only, bitmap texels and sound samples are used in place and only
+	// their headers come from the budget, the OS pages them in and out based on the residency hints
+	bool mapFiles;
+};
+
+#define ASSET_MEMORY_DEFAULT_INITIAL_SIZE MB(10)
+#define ASSET_MEMORY_DEFAULT_MAX_SIZE MB(64)
+#define ASSET_MEMORY_DEFAULT_REGION_SIZE MB(4)
+#define ASSET_MEMORY_DEFAULT_SOFT_WATERMARK 0.85f
+#define ASSET_MEMORY_DEFAULT_HARD_WATERMARK 0.95f
+#define ASSET_MEMORY_MAX_EVICTIONS_PER_FRAME 8
+
+struct AssetMemoryStats {
+	u32 totalSize;
+	u32 regionCount;
+	u32 usedSize;
+	u32 usedBlockCount;
+	u32 freeSize;
+	u32 freeBlockCount;
+	u32 largestFreeBlockSize;
+	u32 recentSize;
+	u32 frequentSize;
+	u32 recentTargetSize;
+};
+
+enum AssetResidency {
+	AssetResidency_None,
+	AssetResidency_Recent,
+	AssetResidency_Frequent,
+	// NOTE: Ghosts are evicted assets whose history is kept by the adaptive policy
+	AssetResidency_RecentGhost,
+	AssetResidency_FrequentGhost,
 };
 
 struct Asset {
@@ -184,6 +387,22 @@ struct Asset {
 	u32 fileSourceIndex;
 	u32 metadataId;
 	u32 state;
+	// NOTE: Both are written by readers without the memory lock, they live here and not in
+	// the memory header because the header can be released while a reader still touches it
+	u32 generationId;
+	u32 referenced;
+	// NOTE: Replacement policy bookkeeping, must be locked
+	u32 residency;
+	u32 recentReferenceCount;
+	u32 ghostSize;
+	u32 ghostNext;
+	u32 ghostPrev;
+};
+
+struct AssetGhostList {
+	u32 first;
+	u32 last;
+	u32 size;
 };
 #pragma warning(pop)
 enum AssetGroupType {
@@ -198,25 +417,58 @@ struct AssetGroup {
 	AssetGroupType type;
 };
 
+// NOTE: Repeated best fit queries within one frame (every wall of the screen asks the same) are answered from here
+#define ASSET_BEST_FIT_MEMO_COUNT 64
+#define ASSET_BEST_FIT_MEMO_PROBE_COUNT 4
+struct AssetBestFitMemo {
+	u32 frameIndex;
+	AssetTypeID typeId;
+	f32 halfPeriod;
+	AssetFeatures match;
+	AssetFeatures weight;
+	u32 assetIndex;
+};
+
 struct TransientState;
 struct PlatformFileGroup;
-struct PlatformFileHandle;
+struct SortElement;
 struct Assets {
 	TransientState* tranState;
 	GenerationId nextGenerationId;
 	u32 inFlightGenerationCount;
 	GenerationId inFlightGenerations[16];
+	// NOTE: Generation ids only grow, so assets used before the oldest in flight one are free to go
+	u32 oldestInFlightGenerationId;
 
 	u32 assetCount;
 	Asset* assets;
 	AssetMetadata* metadatas;
 	AssetFeatures* features;
 	AssetGroup groups[Asset_Count];
+	// NOTE: Per feature (value, asset index) pairs, every group's range is sorted by the value
+	SortElement* featureIndex[Feature_Count];
+	u32 bestFitFrameIndex;
+	AssetBestFitMemo bestFitMemo[ASSET_BEST_FIT_MEMO_COUNT];
 
 	PlatformFileGroup* sources;
-
-	AssetMemoryHeader lruSentinel;
+	u8** mappedSources;
+	LoadAssetTaskArgs loads[ASSET_MAX_LOADS_IN_FLIGHT];
+
+	// NOTE: Clock policy uses only the recent list
+	AssetMemoryHeader recentSentinel;
+	AssetMemoryHeader frequentSentinel;
+	AssetGhostList recentGhosts;
+	AssetGhostList frequentGhosts;
+	u32 recentTargetSize;
 	AssetMemoryBlock memorySentinel;
+	u32 freeFirstLevelMask;
+	u32 freeSecondLevelMasks[ASSET_MEMORY_FL_COUNT];
+	AssetMemoryBlock* freeBlocks[ASSET_MEMORY_FL_COUNT][ASSET_MEMORY_SL_COUNT];
+	AssetMemoryStats memoryStats;
+	AssetMemoryConfig memoryConfig;
+	u8* reservedMemory;
+	u32 reservedSize;
+	u32 committedSize;
 
 	u32 memoryLock;
 };
@@ -231,6 +483,10 @@ inline LoadedBitmap* GetBitmap(Assets& assets, BitmapId bid, GenerationId gid);
 inline LoadedSound* GetSound(Assets& assets, SoundId sid, GenerationId gid);
 inline LoadedFont* GetFont(Assets& assets, FontId fid, GenerationId gid);
 inline AssetMetadata* GetAssetMetadata(Assets& assets, u32 id);
+internal AssetMemoryStats GetAssetMemoryStats(Assets& assets);
+internal void UpdateAssetMemoryBudget(Assets& assets);
+internal void UpdateAssetLoads(Assets& assets);
+internal void ResetBestFitMemo(Assets& assets);
 inline AssetFeatures* GetAssetFeatures(Assets& assets, u32 id);
 inline PlatformFileHandle* GetAssetSource(Assets& assets, u32 index);
 inline SoundId GetFirstSoundIdWithType(Assets& assets, AssetTypeID typeId);
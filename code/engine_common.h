@@ -72,6 +72,7 @@
 #define F32_MAX f4(U32_MAX)
 #define AlignUp32(expr) (((expr) + 31) / 32 * 32)
 #define AlignUp8(expr) (((expr) + 7) / 8 * 8)
+#define AlignUp4(expr) (((expr) + 3) / 4 * 4)
 #define AlignDown32(expr) ((expr) / 32 * 32))
 #define AlignDown8(expr) ((expr) / 8 * 8)
 #if COMPILER_LLVM == 1
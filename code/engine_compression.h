@@ -0,0 +1,214 @@
+#pragma once
+#include "engine_common.h"
+
+// NOTE: LZ4 block format. Sequence is a token (literal length << 4 | match length - 4), extra literal
+// length bytes, literals, 16 bit match offset and extra match length bytes. Last sequence has literals only
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+// NOTE: Format rules, last match starts at least 12 bytes before the end and ends 5 bytes before it
+#define LZ_MATCH_SAFE_DISTANCE 12
+#define LZ_LAST_LITERALS 5
+#define LZ_HASH_BITS 16
+#define LZ_HASH_TABLE_COUNT (1 << LZ_HASH_BITS)
+
+inline
+u32 GetLZCompressBound(u32 size) {
+	return size + size / 255 + 16;
+}
+
+inline
+u32 GetLZHash(u8* at) {
+	u32 sequence = *ptrcast(u32, at);
+	return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+inline
+void CopyLZBytes(u8* dst, u8* src, u32 size) {
+	// NOTE: Copies forward in 8 byte steps, so it also repeats matches which are at least 8 bytes back
+	for (; size >= 8; size -= 8, dst += 8, src += 8) {
+		*ptrcast(u64, dst) = *ptrcast(u64, src);
+	}
+	while (size--) {
+		*dst++ = *src++;
+	}
+}
+
+inline
+u8* WriteLZLength(u8* at, u32 length) {
+	for (; length >= 255; length -= 255) {
+		*at++ = 255;
+	}
+	*at++ = u8(length);
+	return at;
+}
+
+internal
+u32 LZCompress(u8* src, u32 srcSize, u8* dst, u32 dstCapacity, u32* hashTable) {
+	// NOTE: Returns 0 when compressed data doesn't fit into dst, hashTable has LZ_HASH_TABLE_COUNT entries
+	if (dstCapacity < GetLZCompressBound(srcSize)) {
+		return 0;
+	}
+	for (u32 hashIndex = 0; hashIndex < LZ_HASH_TABLE_COUNT; hashIndex++) {
+		hashTable[hashIndex] = U32_MAX;
+	}
+	u8* out = dst;
+	u32 literalStart = 0;
+	u32 at = 0;
+	u32 matchLimit = srcSize > LZ_MATCH_SAFE_DISTANCE ? srcSize - LZ_MATCH_SAFE_DISTANCE : 0;
+	while (at < matchLimit) {
+		u32 hash = GetLZHash(src + at);
+		u32 candidate = hashTable[hash];
+		hashTable[hash] = at;
+		if (candidate == U32_MAX || at - candidate > LZ_MAX_OFFSET ||
+			*ptrcast(u32, src + candidate) != *ptrcast(u32, src + at)) {
+			at++;
+			continue;
+		}
+		u32 matchEnd = at + LZ_MIN_MATCH;
+		u32 matchEndLimit = srcSize - LZ_LAST_LITERALS;
+		while (matchEnd < matchEndLimit && src[matchEnd] == src[candidate + matchEnd - at]) {
+			matchEnd++;
+		}
+		u32 literalLength = at - literalStart;
+		u32 matchLength = matchEnd - at - LZ_MIN_MATCH;
+		u8* token = out++;
+		*token = u8((Minimum(literalLength, 15u) << 4) | Minimum(matchLength, 15u));
+		if (literalLength >= 15) {
+			out = WriteLZLength(out, literalLength - 15);
+		}
+		CopyLZBytes(out, src + literalStart, literalLength);
+		out += literalLength;
+		u32 offset = at - candidate;
+		*out++ = u8(offset);
+		*out++ = u8(offset >> 8);
+		if (matchLength >= 15) {
+			out = WriteLZLength(out, matchLength - 15);
+		}
+		at = matchEnd;
+		literalStart = at;
+	}
+	u32 literalLength = srcSize - literalStart;
+	*out++ = u8(Minimum(literalLength, 15u) << 4);
+	if (literalLength >= 15) {
+		out = WriteLZLength(out, literalLength - 15);
+	}
+	CopyLZBytes(out, src + literalStart, literalLength);
+	out += literalLength;
+	return u4(out - dst);
+}
+
+internal
+bool LZDecompress(u8* src, u32 srcSize, u8* dst, u32 dstSize) {
+	// NOTE: Never reads or writes out of the buffers, returns false for corrupted data
+	u8* in = src;
+	u8* inEnd = src + srcSize;
+	u8* out = dst;
+	u8* outEnd = dst + dstSize;
+	while (in < inEnd) {
+		u32 token = *in++;
+		u32 literalLength = token >> 4;
+		if (literalLength == 15) {
+			u32 extra = 255;
+			while (extra == 255 && in < inEnd) {
+				extra = *in++;
+				literalLength += extra;
+			}
+		}
+		if (literalLength > u4(inEnd - in) || literalLength > u4(outEnd - out)) {
+			return false;
+		}
+		CopyLZBytes(out, in, literalLength);
+		in += literalLength;
+		out += literalLength;
+		if (in == inEnd) {
+			break;
+		}
+		if (inEnd - in < 2) {
+			return false;
+		}
+		u32 offset = in[0] | (u32(in[1]) << 8);
+		in += 2;
+		u32 matchLength = (token & 0xF) + LZ_MIN_MATCH;
+		if ((token & 0xF) == 15) {
+			u32 extra = 255;
+			while (extra == 255 && in < inEnd) {
+				extra = *in++;
+				matchLength += extra;
+			}
+		}
+		if (!offset || offset > u4(out - dst) || matchLength > u4(outEnd - out)) {
+			return false;
+		}
+		u8* match = out - offset;
+		if (offset >= 8) {
+			CopyLZBytes(out, match, matchLength);
+			out += matchLength;
+		}
+		else {
+			// NOTE: Short offset repeats a pattern shorter than one copy step. Pattern can be copied from
+			// any multiple of its length back, so the first bytes go one by one until one of at least
+			// 8 bytes is behind
+			u32 step = offset * ((8 + offset - 1) / offset);
+			u32 headLength = Minimum(step, matchLength);
+			for (u32 index = 0; index < headLength; index++) {
+				*out++ = *match++;
+			}
+			CopyLZBytes(out, out - step, matchLength - headLength);
+			out += matchLength - headLength;
+		}
+	}
+	return out == outEnd;
+}
+
+// NOTE: Byte shuffle filter for arrays of 4 byte values. Within every block the first bytes of all values
+// go first, then the second bytes and so on, so sign/exponent and high mantissa bytes of neighbouring
+// samples end up next to each other where LZ can match them. Blocks keep the inverse in place
+#define LZ_SHUFFLE_BLOCK_SIZE 4096
+
+inline
+void ShuffleLZBytes(u8* src, u8* dst, u32 size) {
+	Assert((size & 3) == 0);
+	for (u32 blockStart = 0; blockStart < size; blockStart += LZ_SHUFFLE_BLOCK_SIZE) {
+		u32 count = Minimum(size - blockStart, u4(LZ_SHUFFLE_BLOCK_SIZE)) / 4;
+		u8* blockSrc = src + blockStart;
+		u8* blockDst = dst + blockStart;
+		for (u32 index = 0; index < count; index++) {
+			for (u32 byteIndex = 0; byteIndex < 4; byteIndex++) {
+				blockDst[byteIndex * count + index] = blockSrc[4 * index + byteIndex];
+			}
+		}
+	}
+}
+
+inline
+void UnshuffleLZBytes(u8* data, u32 size) {
+	Assert((size & 3) == 0);
+	u8 block[LZ_SHUFFLE_BLOCK_SIZE];
+	for (u32 blockStart = 0; blockStart < size; blockStart += LZ_SHUFFLE_BLOCK_SIZE) {
+		u32 count = Minimum(size - blockStart, u4(LZ_SHUFFLE_BLOCK_SIZE)) / 4;
+		u8* blockData = data + blockStart;
+		CopyLZBytes(block, blockData, 4 * count);
+		// NOTE: 16 values at once, bytes of the four planes are interleaved in two unpack steps
+		u32 index = 0;
+		for (; index + 16 <= count; index += 16) {
+			__m128i byte0 = _mm_loadu_si128(ptrcast(__m128i, block + index));
+			__m128i byte1 = _mm_loadu_si128(ptrcast(__m128i, block + count + index));
+			__m128i byte2 = _mm_loadu_si128(ptrcast(__m128i, block + 2 * count + index));
+			__m128i byte3 = _mm_loadu_si128(ptrcast(__m128i, block + 3 * count + index));
+			__m128i low01 = _mm_unpacklo_epi8(byte0, byte1);
+			__m128i high01 = _mm_unpackhi_epi8(byte0, byte1);
+			__m128i low23 = _mm_unpacklo_epi8(byte2, byte3);
+			__m128i high23 = _mm_unpackhi_epi8(byte2, byte3);
+			__m128i* dst = ptrcast(__m128i, blockData + 4 * index);
+			_mm_storeu_si128(dst + 0, _mm_unpacklo_epi16(low01, low23));
+			_mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(low01, low23));
+			_mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(high01, high23));
+			_mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(high01, high23));
+		}
+		for (; index < count; index++) {
+			for (u32 byteIndex = 0; byteIndex < 4; byteIndex++) {
+				blockData[4 * index + byteIndex] = block[byteIndex * count + index];
+			}
+		}
+	}
+}
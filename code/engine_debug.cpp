@@ -1,5 +1,4 @@
 #include "engine.h"
-#include "renderer_software.cpp"
 
 /* TODO:
 * Better profiler 
@@ -27,6 +26,17 @@ DebugGlobalState* debugGlobalState = &debugGlobalState_;
 
 // TODO: Delete stdlib
 #include <stdio.h>
+#if !defined(_WIN32)
+template<u64 size, typename... Args>
+inline i32 sprintf_s(char (&buffer)[size], const char* format, Args... args) {
+	return snprintf(buffer, size, format, args...);
+}
+
+template<typename... Args>
+inline i32 sprintf_s(char* buffer, u64 size, const char* format, Args... args) {
+	return snprintf(buffer, size, format, args...);
+}
+#endif
 
 //NOTE: Intelisense helpers
 inline bool IsPressed(Button& button);
@@ -598,7 +608,7 @@ DebugState* DebugBegin(InputData& input, RenderCommandBuffer* renderCommands, u3
 }
 
 internal
-DebugThreadStack* GetDebugStackForThread(DebugState* state, u16 threadId) {
+DebugThreadStack* GetDebugStackForThread(DebugState* state, u32 threadId) {
 	for (u32 stackIndex = 0; stackIndex < state->threadStacksCount; stackIndex++) {
 		DebugThreadStack* stack = state->threadStacks + stackIndex;
 		if (stack->threadId == threadId) {
@@ -919,6 +929,10 @@ void DebugCollateEvents(DebugState* state) {
 		} break;
 		case Event_Time_BlockEnd: {
 			OpenDebugEvent* block = stack->timeEvents;
+			if (!block) {
+				// NOTE: Block of a render task began before the frame end, its begin is in the previous table
+				break;
+			}
 			OpenDebugEvent* parentBlock = block->next;
 			DebugEvent* openEvent = &block->event;
 			Assert(openEvent);
@@ -1181,7 +1195,7 @@ void DebugRenderCpuProfilerTimings(DebugState* state, Controller& controller, V2
 			Assert(var->eventSentinel->captureFrameIndex == 0);
 			Assert(elementCount < (maxElements - 1));
 			SortElement* sortElement = sortElements + elementCount;
-			sortElement->key = -DurationToMs(var->durationSum) / var->eventCount;
+			sortElement->key = FloatToRadixValue(-DurationToMs(var->durationSum) / var->eventCount);
 			sortElement->offset = elementCount++;
 			*variablesIt++ = var;
 		}
@@ -1196,7 +1210,7 @@ void DebugRenderCpuProfilerTimings(DebugState* state, Controller& controller, V2
 		SortElement* sortElement = sortElements + currentSortIndex;
 		DebugVariable* var = variables[sortElement->offset];
 		Assert(var->eventSentinel->captureFrameIndex == 0);
-		f32 timingMs = -sortElement->key;
+		f32 timingMs = DurationToMs(var->durationSum) / var->eventCount;
 		if (fontContext.leftTopCurrent.Y > view.rect.min.Y) {
 			String8 name = GetName(var->parsedGuid);
 			u32 variableSpan = GetVariableEventSpan(var);
@@ -1417,6 +1431,24 @@ void DebugRenderMemoryProfiler(DebugState* state, Controller& controller, V2 mou
 	V4 backgroundColor = V4{ 0.03f, 0.03f, 0.03f, 0.75f };
 	PushRect(state->renderGroup, DefaultFlatTransform(), view.rect, -1.f, backgroundColor);
 
+	{
+		// NOTE: Asset memory lives in the transient arena, its fragmentation isn't visible on the arena spans
+		TransientState* tranState = ptrcast(TransientState, debugGlobalMemory->transientMemory);
+		AssetMemoryStats stats = GetAssetMemoryStats(tranState->assets);
+		f32 fragmentation = stats.freeSize ? 100.f * (1.f - f4(stats.largestFreeBlockSize) / f4(stats.freeSize)) : 0.f;
+		char buffer[256];
+		sprintf_s(buffer, "assets: used %ukB/%ukB in %u blocks, %u regions, free %ukB in %u blocks, largest %ukB, fragmentation %.1f%%",
+			stats.usedSize / 1024, stats.totalSize / 1024, stats.usedBlockCount, stats.regionCount, stats.freeSize / 1024,
+			stats.freeBlockCount, stats.largestFreeBlockSize / 1024, fragmentation);
+		f32 lineAdvance = state->fontContext.scale * f4(GetFontLineAdvance(state->font));
+		V2 textPos = V2{ view.rect.min.X + 4.f, view.rect.max.Y - lineAdvance };
+		DebugRenderLineWithOutline(state, buffer, textPos, state->fontContext.scale, V4{ 1, 1, 1, 1 }, V4{ 0, 0, 0, 1 }, 1.f);
+		sprintf_s(buffer, "assets: recent %ukB (target %ukB), frequent %ukB",
+			stats.recentSize / 1024, stats.recentTargetSize / 1024, stats.frequentSize / 1024);
+		textPos.Y -= lineAdvance;
+		DebugRenderLineWithOutline(state, buffer, textPos, state->fontContext.scale, V4{ 1, 1, 1, 1 }, V4{ 0, 0, 0, 1 }, 1.f);
+	}
+
 
 	u64 maxSize = debugGlobalMemory->memoryBlockSize;
 	u64 memoryStart = u64(debugGlobalMemory->memoryBlock);
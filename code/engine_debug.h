@@ -3,7 +3,8 @@
 
 // ------------------- EVENT PROFILER --------------------
 #define MAX_DEBUG_EVENTS 900000
-#define MAX_DEBUG_THREADS 64
+// NOTE: Both platform queues at their worker limit, plus main and audio threads
+#define MAX_DEBUG_THREADS 160
 #define DEBUG_CPU_FREQ (2.9f * 1000'000'000)
 #define DEBUG_TARGET_FPS 60.f
 
@@ -64,8 +65,8 @@ struct DebugParsedGUID {
 struct DebugEvent {
 	DebugEventType type;
 	u8 coreId;
-	u16 reserved;
-	u16 threadId;
+	// NOTE: Linux thread ids are addresses of thread control blocks, which repeat in the low 16 bits
+	u32 threadId;
 	u64 cycles;
 	const char* GUID;
 	union {
@@ -127,7 +128,8 @@ struct PermanentDebugVariable {
 };
 
 struct DebugGlobalState {
-	DebugEvent events[2][MAX_DEBUG_EVENTS];
+	// NOTE: Last event of each frame is a sink for events which didn't fit, it is never collated
+	DebugEvent events[2][MAX_DEBUG_EVENTS + 1];
 	DebugEvent swapEvent;
 	u32 eventsCount[2];
 	u64 frameStartCycles[2];
@@ -136,6 +138,8 @@ struct DebugGlobalState {
 	u64 frameEndCyclesDebugFinishFrame[2];
 	u32 currentFrameIndex;
 	volatile u64 frameAndEventIndex;
+	// NOTE: Events fully written into each table, frame end waits until it matches reserved ones
+	volatile u32 writtenEventsCount[2];
 };
 
 // TODO: Move it down below
@@ -156,7 +160,7 @@ struct OpenDebugEvent {
 };
 
 struct DebugThreadStack {
-	u16 threadId;
+	u32 threadId;
 	u8 laneId; //NOTE: de facto threadId starting from 0,1,2,3,4...N
 	OpenDebugEvent* timeEvents;
 	OpenDebugEvent* dataEvents;
@@ -166,23 +170,51 @@ struct DebugThreadStack {
 #define UniqueGUID_(name, file, line, counter) UniqueGUID__(name, file, line, counter)
 #define UniqueGUID(name) UniqueGUID_(name, __FILE__, __LINE__, __COUNTER__)
 #define DEBUG_NAME(name) UniqueGUID(name)
-#define RecordDebugEvent(eventtype, InputGUID) \
+// NOTE: Event is being written until FinishDebugEvent, events with data fill it in between
+#define BeginDebugEvent(eventtype, InputGUID) \
 	u64 frameAndEventIndex_ = AtomicAddU64(&debugGlobalState->frameAndEventIndex, 1);\
 	u32 frameIndex_ = frameAndEventIndex_ >> 32;\
-	u32 eventIndex_ = frameAndEventIndex_ & U32_MAX;\
-	Assert(eventIndex_ < MAX_DEBUG_EVENTS);\
+	u32 eventIndex_ = u4(Minimum(frameAndEventIndex_ & U32_MAX, MAX_DEBUG_EVENTS));\
 	DebugEvent* event_ = debugGlobalState->events[frameIndex_] + eventIndex_;\
 	u32 coreId;\
 	event_->cycles = __rdtscp(&coreId);\
 	event_->coreId = u8(coreId);\
 	event_->type = eventtype;\
-	event_->GUID = InputGUID; \
-	event_->threadId = u2(GetFastThreadId());
+	event_->threadId = GetFastThreadId();\
+	event_->GUID = InputGUID;
+#define FinishDebugEvent \
+	WriteCompilatorFence;\
+	AtomicAddU32(&debugGlobalState->writtenEventsCount[frameIndex_], 1);
+#define RecordDebugEvent(eventtype, InputGUID) \
+	BeginDebugEvent(eventtype, InputGUID) \
+	FinishDebugEvent
 
 #if INTERNAL_BUILD
 #define TIMED_FUNCTION__(line, GUID) TimedBlock block##line(GUID)
 #define TIMED_FUNCTION_(line, GUID) TIMED_FUNCTION__(line, GUID)
+#if defined(_WIN32)
 #define TIMED_FUNCTION TIMED_FUNCTION_(__LINE__, DEBUG_NAME(__FUNCTION__))
+#else
+// NOTE: __func__ is not a string literal outside of windows compilers, so the GUID is joined once per call site
+inline
+const char* DebugJoinFunctionGUID(char* dst, u32 dstSize, const char* prefix, const char* function) {
+	u32 length = 0;
+	for (const char* at = prefix; *at && length < dstSize - 1; at++) {
+		dst[length++] = *at;
+	}
+	for (const char* at = function; *at && length < dstSize - 1; at++) {
+		dst[length++] = *at;
+	}
+	dst[length] = 0;
+	return dst;
+}
+#define TIMED_FUNCTION_GUID__(line) \
+	static char functionGUID##line[256]; \
+	static const char* functionGUIDPtr##line = DebugJoinFunctionGUID(functionGUID##line, sizeof(functionGUID##line), DEBUG_NAME(""), __func__); \
+	TIMED_FUNCTION__(line, functionGUIDPtr##line)
+#define TIMED_FUNCTION_GUID_(line) TIMED_FUNCTION_GUID__(line)
+#define TIMED_FUNCTION TIMED_FUNCTION_GUID_(__LINE__)
+#endif
 
 #define TIMED_BLOCK_BEGIN__(GUID) { RecordDebugEvent(Event_Time_BlockBegin, GUID); }
 #define TIMED_BLOCK_BEGIN_(GUID) TIMED_BLOCK_BEGIN__(GUID)
@@ -191,12 +223,19 @@ struct DebugThreadStack {
 
 #define MARKUP_FRAME_BEGIN \
 	debugGlobalState->frameStartCycles[debugGlobalState->currentFrameIndex] = __rdtsc();
+// NOTE: Render tasks run through the frame end, so it waits for events reserved in the old table
+// to be written. Nothing writes into the table afterwards, until it is reused two frames later
 #define MARKUP_FRAME_END { \
 	u32 oldFrameIndex = debugGlobalState->currentFrameIndex; \
 	debugGlobalState->frameEndCycles[oldFrameIndex] = __rdtsc();\
 	debugGlobalState->currentFrameIndex = !oldFrameIndex;\
+	debugGlobalState->writtenEventsCount[debugGlobalState->currentFrameIndex] = 0;\
 	u64 oldFrameAndEventIndex = AtomicExchangeU64(&debugGlobalState->frameAndEventIndex, u64(debugGlobalState->currentFrameIndex) << 32); \
-	debugGlobalState->eventsCount[oldFrameIndex] = oldFrameAndEventIndex & U32_MAX;\
+	u32 reservedEventsCount = u4(oldFrameAndEventIndex & U32_MAX);\
+	while (debugGlobalState->writtenEventsCount[oldFrameIndex] != reservedEventsCount) {\
+		_mm_pause();\
+	}\
+	debugGlobalState->eventsCount[oldFrameIndex] = u4(Minimum(reservedEventsCount, MAX_DEBUG_EVENTS));\
 	MARKUP_FRAME_BEGIN }
 
 inline DebugId DEBUG_POINTER_ID(void* ptr, u32 objId);
@@ -206,11 +245,12 @@ inline bool DEBUG_DATA_BLOCK_REQUESTED(DebugId did);
 
 #define DEBUG_DATA_BLOCK_DISPATCH_DEF(type) \
 	void DEBUG_DATA_BLOCK_DISPATCH(type& data, const char* GUID) { \
-		RecordDebugEvent(Event_Data_##type, GUID); \
+		BeginDebugEvent(Event_Data_##type, GUID); \
 		if(debugGlobalState->swapEvent.GUID == GUID){ \
 			data = debugGlobalState->swapEvent.data_##type; \
 		}\
 		event_->data_##type = data;	\
+		FinishDebugEvent \
 	}
 DEBUG_DATA_BLOCK_DISPATCH_DEF(bool);
 DEBUG_DATA_BLOCK_DISPATCH_DEF(f32);
@@ -231,17 +271,22 @@ DEBUG_DATA_BLOCK_DISPATCH_DEF(Rect3);
 #define DEBUG_DATA_(data, GUID) DEBUG_DATA__(data, GUID)
 #define DEBUG_DATA(data) DEBUG_DATA_(data, DEBUG_NAME(#data))
 
-#define RecordMemoryDebugEvent(type, arenaArg) \
-	RecordDebugEvent(type, DEBUG_NAME(#arenaArg)) \
+#define BeginMemoryDebugEvent(type, arenaArg) \
+	BeginDebugEvent(type, DEBUG_NAME(#arenaArg)) \
 	event_->GUID = ptrcast(const char, &(arenaArg)); \
 	event_->data_MemoryArenaSnapshot.arena = arenaArg; \
 	event_->data_MemoryArenaSnapshot.parent = 0;
+#define RecordMemoryDebugEvent(type, arenaArg) \
+	BeginMemoryDebugEvent(type, arenaArg) \
+	FinishDebugEvent
 #define RecordSubArenaDebugEvent(subarenaArg, arenaArg) { \
-	RecordMemoryDebugEvent(Event_MemoryArenaInitialize, subarenaArg) \
-	event_->data_MemoryArenaSnapshot.parent = &(arenaArg); }
+	BeginMemoryDebugEvent(Event_MemoryArenaInitialize, subarenaArg) \
+	event_->data_MemoryArenaSnapshot.parent = &(arenaArg); \
+	FinishDebugEvent }
 #define RecordAssetMemoryBlockEvent(block) { \
-	RecordDebugEvent(Event_AssetMemoryBlock, DEBUG_NAME("AssetMemoryBlock")) \
-	event_->data_AssetMemoryBlock = *(block); }
+	BeginDebugEvent(Event_AssetMemoryBlock, DEBUG_NAME("AssetMemoryBlock")) \
+	event_->data_AssetMemoryBlock = *(block); \
+	FinishDebugEvent }
 
 #else
 #define TIMED_FUNCTION
@@ -446,6 +491,7 @@ debug_variable bool DEBUG_Profiler_CpuSpansList;
 debug_variable bool DEBUG_Profiler_Pause;
 debug_variable bool DEBUG_Camera_Zoomout;
 debug_variable f32 DEBUG_Camera_ZoomoutValue = 10.f;
+debug_variable bool DEBUG_Assets_TiledBitmaps;
 debug_variable bool DEBUG_Renderer_WithSoftware;
 debug_variable bool DEBUG_Renderer_DifferentResolution;
 debug_variable f32 DEBUG_Renderer_ResolutionWidth = 960.f;
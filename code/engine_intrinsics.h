@@ -1,9 +1,23 @@
 #pragma once
 #include "engine_common.h"
+#if defined(_WIN32)
 #include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
 #include <immintrin.h>
 
+#if defined(_WIN32)
 #define WriteCompilatorFence _WriteBarrier()
+#define ReadCompilatorFence _ReadBarrier()
+#else
+#define WriteCompilatorFence asm volatile("" ::: "memory")
+#define ReadCompilatorFence asm volatile("" ::: "memory")
+#endif
+// NOTE: x64 can reorder store with later load, this is the only fence that prevents it
+#define FullMemoryFence _mm_mfence()
+
+#if defined(_WIN32)
 inline
 u32 AtomicCompareExchange(volatile u32* dst, u32 exchange, u32 comperand) {
 	return _InterlockedCompareExchange(ptrcast(volatile long, dst), exchange, comperand);
@@ -34,6 +48,104 @@ u32 GetFastThreadId() {
 	u64 threadLocalGsPtr = __readgsqword(0x30);
 	return *ptrcast(u32, threadLocalGsPtr + 0x48);
 }
+#else
+inline
+u32 AtomicCompareExchange(volatile u32* dst, u32 exchange, u32 comperand) {
+	return __sync_val_compare_and_swap(dst, comperand, exchange);
+}
+
+inline
+u64 AtomicExchangeU64(volatile u64* dst, u64 value) {
+	return __atomic_exchange_n(dst, value, __ATOMIC_SEQ_CST);
+}
+
+inline
+u32 AtomicExchangeU32(volatile u32* dst, u32 value) {
+	return __atomic_exchange_n(dst, value, __ATOMIC_SEQ_CST);
+}
+
+inline
+u32 AtomicAddU32(volatile u32* dst, u32 adder) {
+	return __atomic_fetch_add(dst, adder, __ATOMIC_SEQ_CST);
+}
+
+inline
+u64 AtomicAddU64(volatile u64* dst, u64 adder) {
+	return __atomic_fetch_add(dst, adder, __ATOMIC_SEQ_CST);
+}
+
+inline
+u32 GetFastThreadId() {
+	// NOTE: On x64 linux fs segment points to thread control block, its address is unique per thread
+	u64 threadPtr;
+	asm volatile("mov %%fs:0, %0" : "=r"(threadPtr));
+	return u4(threadPtr);
+}
+#endif
+
+// NOTE: Wider kernels are compiled for their instruction set regardless of the compiler flags and
+// selected at runtime, msvc lets intrinsics be used anywhere so it doesn't need the attribute
+#if COMPILER_MSVC
+#define TARGET_AVX2
+#define TARGET_AVX512
+#else
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl,avx2,fma")))
+#endif
+
+enum CpuSimdLevel {
+	CpuSimd_SSE2,
+	CpuSimd_AVX2,
+	CpuSimd_AVX512,
+
+	CpuSimd_Count
+};
+
+inline
+const char* GetCpuSimdLevelName(CpuSimdLevel level) {
+	const char* names[CpuSimd_Count] = { "SSE2", "AVX2", "AVX-512" };
+	return names[level];
+}
+
+inline
+CpuSimdLevel GetCpuSimdLevel() {
+	// NOTE: Instruction set support is not enough, OS has to save the wide registers (XCR0)
+#if COMPILER_MSVC
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return CpuSimd_SSE2;
+	}
+	__cpuid(info, 1);
+	bool osxsave = info[2] & (1 << 27);
+	bool fma = info[2] & (1 << 12);
+	if (!osxsave) {
+		return CpuSimd_SSE2;
+	}
+	u64 xcr0 = _xgetbv(0);
+	__cpuidex(info, 7, 0);
+	bool avx2 = info[1] & (1 << 5);
+	bool avx512 = (info[1] & (1 << 16)) && (info[1] & (1 << 17)) && (info[1] & (1 << 30)) && (info[1] & (1 << 31));
+	if (avx512 && (xcr0 & 0xE6) == 0xE6) {
+		return CpuSimd_AVX512;
+	}
+	if (avx2 && fma && (xcr0 & 0x6) == 0x6) {
+		return CpuSimd_AVX2;
+	}
+	return CpuSimd_SSE2;
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+		__builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl"))
+	{
+		return CpuSimd_AVX512;
+	}
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+		return CpuSimd_AVX2;
+	}
+	return CpuSimd_SSE2;
+#endif
+}
 
 inline
 i32 RoundF32ToI32(f32 value) {
@@ -116,8 +228,13 @@ struct BitwiseSearchResult {
 inline 
 BitwiseSearchResult LeastSignificantHighBit(u32 value) {
 	BitwiseSearchResult result = {};
-#if COMPILER_MSVC || COMPILER_LLVM
-	_BitScanForward(ptrcast(unsigned long, &result.index), value);
+#if defined(_WIN32)
+	result.found = _BitScanForward(ptrcast(unsigned long, &result.index), value);
+#elif COMPILER_LLVM || COMPILER_GPLUSPLUS
+	if (value) {
+		result.found = true;
+		result.index = __builtin_ctz(value);
+	}
 #else
 	u32 mask = 1;
 	for (u8 index = 0; index < 32; index++) {
@@ -132,3 +249,26 @@ BitwiseSearchResult LeastSignificantHighBit(u32 value) {
 #endif
 	return result;
 }
+
+inline
+BitwiseSearchResult MostSignificantHighBit(u32 value) {
+	BitwiseSearchResult result = {};
+#if defined(_WIN32)
+	result.found = _BitScanReverse(ptrcast(unsigned long, &result.index), value);
+#elif COMPILER_LLVM || COMPILER_GPLUSPLUS
+	if (value) {
+		result.found = true;
+		result.index = 31 - __builtin_clz(value);
+	}
+#else
+	for (i32 index = 31; index >= 0; index--) {
+		if (value & (1u << index)) {
+			result.found = true;
+			result.index = index;
+			break;
+		}
+	}
+	Assert(!"Slow one, add intrinsic!");
+#endif
+	return result;
+}
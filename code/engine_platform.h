@@ -30,35 +30,36 @@ struct Button {
 	bool wasDown;
 };
 
+struct ControllerButtons {
+	Button kW;
+	Button kS;
+	Button kD;
+	Button kA;
+	Button kP;
+	Button kArrowUp;
+	Button kArrowDown;
+	Button kArrowLeft;
+	Button kArrowRight;
+	Button kSpace;
+	Button kEsc;
+	Button kShift;
+	Button kCtrl;
+	Button kAlt;
+	Button mouseLeft;
+	Button mouseRight;
+	Button mouseMiddle;
+	Button mouse1B;
+	Button mouse2B;
+};
+
 #pragma warning(push)
 #pragma warning(disable : 4201)
 struct Controller {
 	// Platform independent user input
 	union {
-		struct Buttons {
-			Button kW;
-			Button kS;
-			Button kD;
-			Button kA;
-			Button kP;
-			Button kArrowUp;
-			Button kArrowDown;
-			Button kArrowLeft;
-			Button kArrowRight;
-			Button kSpace;
-			Button kEsc;
-			Button kShift;
-			Button kCtrl;
-			Button kAlt;
-			Button mouseLeft;
-			Button mouseRight;
-			Button mouseMiddle;
-			Button mouse1B;
-			Button mouse2B;
-		};
-		Buttons B;
+		ControllerButtons B;
 		Button E[19];
-		static_assert(sizeof(B) == sizeof(E));
+		static_assert(sizeof(ControllerButtons) == sizeof(Button) * 19);
 	};
 	// Mouse data is in screen space <-0.5w + 0.5, 0.5w - 0.5> <-0.5h + 0.5, 0.5h - 0.5)
 	V2 mouse;
@@ -72,9 +73,42 @@ struct InputData {
 };
 
 struct SortElement {
-	f32 key;
+	// NOTE: Compared as an unsigned integer. Render commands pack their state into it (GetRenderSortKey()),
+	// float values are stored as FloatToRadixValue()
+	u64 key;
 	u32 offset;
 };
+
+inline
+u32 FloatToRadixValue(f32 value) {
+	u32 result = *ptrcast(u32, &value);
+
+	/* NOTE:
+	   FLOAT = |Sign bit (1)|Exponent (7)|Mantissa (24)|
+	   Exponent and mantissa are monotonically increasing when float is increasing
+	   Only sign bit is problematic (is 1 when float is negative)
+	   So we set the sign bit for the positive numbers to make them higher than negatives
+	   and we negate negative numbers to unset the sign bit and keep the monotonically
+	   increasing order
+	*/
+	if (value < 0) {
+		result = ~result;
+	}
+	else {
+		result |= 0x80000000;
+	}
+	return result;
+}
+
+inline
+u32 GetRenderSortDepthBand(f32 depth) {
+	// NOTE: Signed band index with flipped sign bit, so it compares as an unsigned integer
+	f32 band = Clip(depth * RENDER_SORT_DEPTH_BANDS_PER_METER, -1073741824.f, 1073741824.f);
+	u32 result = u32(FloorF32ToI32(band)) ^ 0x80000000;
+	return result;
+}
+
+struct RadixSortJob;
 struct RenderCommandBuffer {
 	u8* pushBuffer;
 	u32 pushBufferCount;
@@ -83,6 +117,19 @@ struct RenderCommandBuffer {
 	u32 sortBufferAt;
 	u32 sortBufferCount;
 	SortElement* sortTempBuffer;
+	// NOTE: Job of the parallel sort, allocated by the software renderer when commands don't fit one task
+	RadixSortJob* sortJob;
+	// NOTE: Per tile lists of commands, grown by the software renderer itself
+	u32 tileBinBufferCount;
+	u32* tileBinBuffer;
+	// NOTE: Per 8 pixel pack of the target, index of the front-most opaque command covering it
+	u32 coverageBufferCount;
+	u32* coverageBuffer;
+	// NOTE: Asset generations of the groups rendered into this buffer. Platform might rasterize the
+	// buffer after GameMainLoopFrame returns, so engine finishes them when it gets the buffer back.
+	// Held generations are in flight too, so there is never more of them than assets keep in flight
+	u32 heldGenerationCount;
+	u32 heldGenerations[16];
 };
 
 
@@ -116,19 +163,65 @@ typedef void					(*_PlatformFileClose)(PlatformFileHandle* file);
 typedef PlatformFileGroup* (*_PlatformFileOpenAllWithExtension)(const char* extension);
 typedef void					(*_PlatformFileCloseAllInGroup)(PlatformFileGroup* group);
 typedef bool					(*_PlatformFileErrors)(PlatformFileHandle* file);
-typedef void					(*_PlatformFileRead)(PlatformFileHandle* file, u32 offset, u32 size, void* dst);
+typedef void					(*_PlatformFileRead)(PlatformFileHandle* file, u64 offset, u64 size, void* dst);
+// NOTE: Read only view of the whole file, it stays valid until the file is closed
+typedef void*					(*_PlatformFileMap)(PlatformFileHandle* file);
+struct PlatformFileReadCompletion {
+	void* userData;
+	u32 readBytes;
+	bool failed;
+};
+// NOTE: Asynchronous reads are queued and polled from one thread. Queued reads may wait for the next
+// poll to be submitted, so many of them go to the kernel at once. Returns false when the read can't
+// be queued, the caller falls back to FileRead then
+typedef bool					(*_PlatformFileReadAsync)(PlatformFileHandle* file, u64 offset, u32 size, void* dst, void* userData);
+// NOTE: Submits queued reads and returns finished ones. With wait set it sleeps until at least one
+// read finishes, unless nothing is in flight
+typedef u32						(*_PlatformFileReadAsyncPoll)(PlatformFileReadCompletion* completions, u32 maxCount, bool wait);
 
 // Memory API
 typedef void*	(*_PlatformMemoryAllocate)(u32 size);
 typedef void	(*_PlatformMemoryFree)(void* memory);
+typedef void*	(*_PlatformMemoryReserve)(u64 size);
+typedef bool	(*_PlatformMemoryCommit)(void* memory, u64 size);
+enum PlatformMemoryAdvice {
+	PlatformMemoryAdvice_WillNeed,
+	PlatformMemoryAdvice_DontNeed,
+};
+// NOTE: Only a hint for mapped memory, the range doesn't have to be page aligned
+typedef void	(*_PlatformMemoryAdvise)(void* memory, u64 size, PlatformMemoryAdvice advice);
 typedef u32		(*_PlatformTextureAllocate)(void* data, u32 width, u32 height);
 typedef void	(*_PlatformTextureFree)(u32 textureHandle);
 
 // Queue API
 struct PlatformQueue;
+struct PlatformJobNode;
 typedef void	(*PlatformQueueCallback)(void* data);
+struct PlatformJobCounter {
+	// NOTE: Number of pushed tasks which are not finished yet, zero initialize before first push
+	volatile u32 remaining;
+	volatile u32 lock;
+	PlatformJobNode* continuations;
+};
+struct PlatformJobNode {
+	// NOTE: Task waiting for a counter, storage is owned by the caller and must stay alive until
+	// the task starts (task's own counter can be used to know that)
+	PlatformQueue* queue;
+	PlatformQueueCallback callback;
+	void* args;
+	PlatformJobCounter* counter;
+	PlatformJobNode* next;
+};
 typedef void	(*_PlatformWaitForQueueCompletion)(PlatformQueue* queue);
-typedef bool	(*_PlatformPushTaskToQueue)(PlatformQueue* queue, PlatformQueueCallback callback, void* args);
+typedef void	(*_PlatformWaitForCounter)(PlatformQueue* queue, PlatformJobCounter* counter);
+// NOTE: Threads which execute tasks of the queue, including one helping thread waiting for them
+typedef u32		(*_PlatformQueueThreadCount)(PlatformQueue* queue);
+// NOTE: Returns false when queue is full, task is executed on the calling thread before returning then
+typedef bool	(*_PlatformPushTaskToQueue)(PlatformQueue* queue, PlatformQueueCallback callback, void* args, PlatformJobCounter* counter);
+// NOTE: Task is submitted once dependency drops to zero (right away if it is zero or null). Several
+// dependencies are expressed by pushing all of them with the same counter
+typedef void	(*_PlatformPushTaskAfter)(PlatformQueue* queue, PlatformJobCounter* dependency, PlatformJobNode* node,
+	PlatformQueueCallback callback, void* args, PlatformJobCounter* counter);
 
 // System API
 enum PlatformCommandState {
@@ -161,7 +254,10 @@ extern ProgramMemory* debugGlobalMemory;
 struct PlatformAPI {
 	// Thread Queue API
 	_PlatformWaitForQueueCompletion QueueWaitForCompletion;
+	_PlatformWaitForCounter QueueWaitForCounter;
+	_PlatformQueueThreadCount QueueThreadCount;
 	_PlatformPushTaskToQueue QueuePushTask;
+	_PlatformPushTaskAfter QueuePushTaskAfter;
 
 	// File API
 	_PlatformFileOpen FileOpen;
@@ -170,10 +266,16 @@ struct PlatformAPI {
 	_PlatformFileCloseAllInGroup FileCloseAllInGroup;
 	_PlatformFileErrors FileErrors;
 	_PlatformFileRead FileRead;
+	_PlatformFileMap FileMap;
+	_PlatformFileReadAsync FileReadAsync;
+	_PlatformFileReadAsyncPoll FileReadAsyncPoll;
 
 	// Memory API
 	_PlatformMemoryAllocate MemoryAllocate;
 	_PlatformMemoryFree MemoryFree;
+	_PlatformMemoryReserve MemoryReserve;
+	_PlatformMemoryCommit MemoryCommit;
+	_PlatformMemoryAdvise MemoryAdvise;
 	_PlatformTextureAllocate TextureAllocate;
 	_PlatformTextureFree TextureFree;
 
@@ -199,6 +301,8 @@ struct ProgramMemory {
 	PlatformQueue* highPriorityQueue;
 	PlatformQueue* lowPriorityQueue;
 
+	AssetMemoryConfig assetMemoryConfig;
+
 	DebugMemory debug;
 	PlatformAPI platformAPI;
 };
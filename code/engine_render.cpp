@@ -129,13 +129,42 @@ RenderGroup BeginRendering(RenderCommandBuffer* commands, Assets* assets, bool r
 inline
 void EndRendering(RenderGroup& group) {
 	Assert(group.generationId.id);
-	FinishGeneration(*group.assets, group.generationId);
+	RenderCommandBuffer* commands = group.commands;
+	if (group.renderInBackground) {
+		// NOTE: Background groups are rasterized by the task which rendered them
+		FinishGeneration(*group.assets, group.generationId);
+	}
+	else {
+		static_assert(ArrayCount(RenderCommandBuffer::heldGenerations) >= ArrayCount(Assets::inFlightGenerations) &&
+			"Held generations are in flight too, buffer must be able to hold all of them");
+		Assert(commands->heldGenerationCount < ArrayCount(commands->heldGenerations));
+		commands->heldGenerations[commands->heldGenerationCount++] = group.generationId.id;
+	}
 	group.generationId.id = 0;
 }
 
+internal
+void ReleaseRenderCommandsGenerations(RenderCommandBuffer* commands, Assets* assets) {
+	// NOTE: Call only when platform doesn't read the buffer anymore (buffer is passed to the next frame)
+	for (u32 index = 0; index < commands->heldGenerationCount; index++) {
+		GenerationId gid = { commands->heldGenerations[index] };
+		FinishGeneration(*assets, gid);
+	}
+	commands->heldGenerationCount = 0;
+}
+
+inline
+u64 GetRenderSortKey(RenderSortLayer layer, f32 depth, bool translucent, u32 textureId) {
+	u64 result = u64(layer) << RENDER_SORT_LAYER_SHIFT;
+	result |= u64(GetRenderSortDepthBand(depth)) << RENDER_SORT_DEPTH_SHIFT;
+	result |= u64(translucent) << RENDER_SORT_TRANSLUCENT_SHIFT;
+	result |= u64(textureId & RENDER_SORT_TEXTURE_MASK) << RENDER_SORT_TEXTURE_SHIFT;
+	return result;
+}
+
 #define PushRenderEntry(group, type, sortKey) ptrcast(type, PushRenderEntry_(group, sizeof(type), RenderCallType_##type, sortKey))
 inline
-void* PushRenderEntry_(RenderGroup& group, u32 size, RenderCallType type, f32 sortKey) {
+void* PushRenderEntry_(RenderGroup& group, u32 size, RenderCallType type, u64 sortKey) {
 	RenderCommandBuffer* commands = group.commands;
 	size += sizeof(RenderCallHeader);
 	Assert(commands->pushBufferSize + size <= commands->sortBufferAt - sizeof(SortElement));
@@ -144,7 +173,7 @@ void* PushRenderEntry_(RenderGroup& group, u32 size, RenderCallType type, f32 so
 	}
 	commands->sortBufferAt -= sizeof(SortElement);
 	SortElement* sortElement = ptrcast(SortElement, commands->pushBuffer + commands->sortBufferAt);
-	sortElement->key = sortKey;
+	sortElement->key = sortKey | u64(type);
 	sortElement->offset = commands->pushBufferSize;
 
 	RenderCallHeader* header = ptrcast(RenderCallHeader, commands->pushBuffer + commands->pushBufferSize);
@@ -157,19 +186,27 @@ void* PushRenderEntry_(RenderGroup& group, u32 size, RenderCallType type, f32 so
 
 inline
 bool PushClearCall(RenderGroup& group, V4 color) {
-	RenderCallClear* call = PushRenderEntry(group, RenderCallClear, -999999.f);
+	RenderCallClear* call = PushRenderEntry(group, RenderCallClear, GetRenderSortKey(RenderSortLayer_Clear, 0.f, false, 0));
 	call->color = color;
 	return true;
 }
 
 inline
-bool PushBitmap(RenderGroup& group, LoadedBitmap* bitmap, ObjectTransform transform, V3 center, V4 color, f32 sortBias) {
+bool PushBitmap(RenderGroup& group, LoadedBitmap* bitmap, ObjectTransform transform, V3 center, V4 color, f32 sortBias,
+	u32 textureId)
+{
 	V2 sizeUnprojected = transform.scale * V2{ bitmap->widthOverHeight, 1 };
 	EntityBasis params = ProjectCoords(group.projection, transform, center, sizeUnprojected, sortBias);
 	if (!params.valid) {
 		return false;
 	}
-	RenderCallBitmap* call = PushRenderEntry(group, RenderCallBitmap, params.sortKey);
+	// NOTE: Bitmaps without an asset id (e.g. ground buffers) are told apart by their address
+	if (!textureId) {
+		textureId = u4(reinterpret_cast<uptr>(bitmap) >> 6);
+	}
+	bool translucent = !(bitmap->flags & LoadedBitmap_Opaque) || color.A < 1.f;
+	RenderCallBitmap* call = PushRenderEntry(group, RenderCallBitmap,
+		GetRenderSortKey(RenderSortLayer_World, params.sortKey, translucent, textureId));
 	call->bitmap = bitmap;
 	call->center = params.center;
 	call->offset = transform.offset;
@@ -196,7 +233,7 @@ bool PushBitmap(RenderGroup& group, ObjectTransform transform, BitmapId bid, V3
 		}
 	}
 	if (bitmap) {
-		PushBitmap(group, bitmap, transform, center, color, sortBias);
+		PushBitmap(group, bitmap, transform, center, color, sortBias, bid.id);
 	}
 	else {
 		// NOTE: Background prefetching cannot be done from the background thread
@@ -212,7 +249,8 @@ bool PushRect(RenderGroup& group, ObjectTransform transform, V3 center, V2 size,
 	if (!params.valid) {
 		return false;
 	}
-	RenderCallRectangle* call = PushRenderEntry(group, RenderCallRectangle, params.sortKey);
+	RenderCallRectangle* call = PushRenderEntry(group, RenderCallRectangle,
+		GetRenderSortKey(RenderSortLayer_World, params.sortKey, color.A < 1.f, 0));
 	call->center = params.center;
 	call->size = params.size;
 	call->offset = transform.offset;
@@ -252,6 +290,94 @@ bool PushRectBorders(RenderGroup& group, ObjectTransform transform, V3 center, V
 	return true;
 }
 
+inline
+RetainedRenderKey GetRetainedRenderKey(Projection& projection, f32 chunkZ) {
+	RetainedRenderKey result = {};
+	result.chunkZ = chunkZ;
+	result.focalLength = projection.camera.focalLength;
+	result.distanceToTarget = projection.camera.distanceToTarget;
+	result.metersToPixels = projection.metersToPixels;
+	result.screenCenter = projection.screenCenter;
+	result.orthographic = projection.orthographic;
+	return result;
+}
+
+inline
+bool AreRetainedRenderKeysEqual(RetainedRenderKey& first, RetainedRenderKey& second) {
+	bool result = first.chunkZ == second.chunkZ &&
+		first.focalLength == second.focalLength &&
+		first.distanceToTarget == second.distanceToTarget &&
+		first.metersToPixels == second.metersToPixels &&
+		first.screenCenter.X == second.screenCenter.X &&
+		first.screenCenter.Y == second.screenCenter.Y &&
+		first.orthographic == second.orthographic;
+	return result;
+}
+
+inline
+bool ProjectRetainedRenderCommand(Projection& projection, RetainedRenderCommand& command, ObjectTransform transform,
+	V3 center, V2 size, f32 sortBias)
+{
+	// NOTE: Same as ProjectCoords, but the scale is kept, so the chunk offset can be added in pixels
+	f32 pixelsPerMeter = projection.metersToPixels;
+	if (!projection.orthographic) {
+		f32 denominator = projection.camera.distanceToTarget - center.Z;
+		if (denominator <= projection.camera.nearClip) {
+			return false;
+		}
+		pixelsPerMeter *= projection.camera.focalLength / denominator;
+	}
+	command.pixelsPerMeter = pixelsPerMeter;
+	command.center = projection.screenCenter + pixelsPerMeter * center.XY;
+	command.size = pixelsPerMeter * size;
+	command.offset = transform.offset;
+	command.sortDepth = 4096 * (center.Z + projection.offset.Z + 0.1f * transform.upright) - center.Y - projection.offset.Y + sortBias;
+	return true;
+}
+
+internal
+void SpliceRetainedRenderCommands(RenderGroup& group, RetainedRenderBlock* blocks, V3 chunkPos, Rect3 bounds) {
+	// NOTE: chunkPos is the camera relative position of the chunk origin, commands of entities outside
+	// of the bounds are skipped
+	Assert(!group.renderInBackground);
+	for (RetainedRenderBlock* block = blocks; block; block = block->next) {
+		for (u32 commandIndex = 0; commandIndex < block->commandCount; commandIndex++) {
+			RetainedRenderCommand& command = block->commands[commandIndex];
+			if (!IsInRectangle(bounds, chunkPos + command.entityOffset)) {
+				continue;
+			}
+			V2 center = command.center + command.pixelsPerMeter * chunkPos.XY;
+			f32 sortDepth = command.sortDepth - chunkPos.Y;
+			switch (command.type) {
+			case RenderCallType_RenderCallBitmap: {
+				LoadedBitmap* bitmap = GetBitmap(*group.assets, command.bitmap, group.generationId);
+				if (!bitmap) {
+					PrefetchBitmap(*group.assets, command.bitmap);
+					continue;
+				}
+				bool translucent = command.translucent || !(bitmap->flags & LoadedBitmap_Opaque);
+				RenderCallBitmap* call = PushRenderEntry(group, RenderCallBitmap,
+					GetRenderSortKey(RenderSortLayer_World, sortDepth, translucent, command.bitmap.id));
+				call->bitmap = bitmap;
+				call->center = center;
+				call->offset = command.offset;
+				call->color = command.color;
+				call->size = V2{ command.size.Y * bitmap->widthOverHeight, command.size.Y };
+			} break;
+			case RenderCallType_RenderCallRectangle: {
+				RenderCallRectangle* call = PushRenderEntry(group, RenderCallRectangle,
+					GetRenderSortKey(RenderSortLayer_World, sortDepth, command.translucent, 0));
+				call->center = center;
+				call->size = command.size;
+				call->offset = command.offset;
+				call->color = command.color;
+			} break;
+			InvalidDefaultCase;
+			}
+		}
+	}
+}
+
 inline
 bool PushRectOutlineInside(RenderGroup& group, ObjectTransform transform, Rect2 rect, f32 Z, V4 color, f32 thickness, f32 sortBias) {
 	Rect2 bot = GetRectFromMinMax(rect.min, V2{ rect.max.X, rect.min.Y + thickness });
@@ -270,7 +396,8 @@ bool PushCoordinateSystem(RenderGroup& group, V2 origin, V2 xAxis, V2 yAxis, V4
 	LoadedBitmap* bitmap, LoadedBitmap* normalMap, EnvironmentMap* topEnvMap,
 	EnvironmentMap* middleEnvMap, EnvironmentMap* bottomEnvMap)
 {
-	RenderCallCoordinateSystem* call = PushRenderEntry(group, RenderCallCoordinateSystem, 0.f);
+	RenderCallCoordinateSystem* call = PushRenderEntry(group, RenderCallCoordinateSystem,
+		GetRenderSortKey(RenderSortLayer_World, 0.f, true, 0));
 	call->origin = origin;
 	call->xAxis = xAxis;
 	call->yAxis = yAxis;
@@ -34,6 +34,21 @@ enum RenderCallType {
 	RenderCallType_RenderCallCoordinateSystem,
 };
 
+// NOTE: Render sort key, from the highest bits: layer (4), depth band (32), translucent (1), texture (23) and
+// command type (4). Depth is quantized to RENDER_SORT_DEPTH_BANDS_PER_METER bands, band alone decides
+// the drawing order and the fields below it put commands of one band into runs of the same state which
+// backends batch. Commands closer than a band in depth may draw in either order
+#define RENDER_SORT_DEPTH_BANDS_PER_METER 8
+#define RENDER_SORT_LAYER_SHIFT 60
+#define RENDER_SORT_DEPTH_SHIFT 28
+#define RENDER_SORT_TRANSLUCENT_SHIFT 27
+#define RENDER_SORT_TEXTURE_SHIFT 4
+#define RENDER_SORT_TEXTURE_MASK 0x7FFFFF
+enum RenderSortLayer {
+	RenderSortLayer_Clear,
+	RenderSortLayer_World,
+};
+
 struct RenderCallHeader {
 	RenderCallType type;
 };
@@ -90,6 +105,40 @@ struct ObjectTransform {
 	V2 offset;
 };
 
+// NOTE: Render command of static world geometry, projected once with the camera above the origin of
+// its chunk. It is spliced in moved by the screen offset of the chunk, which holds as long as the chunk
+// keeps its distance from the camera plane and the projection doesn't change, see RetainedRenderKey
+struct RetainedRenderCommand {
+	RenderCallType type;
+	bool translucent;
+	BitmapId bitmap;
+	// NOTE: Position of the entity inside of its chunk, for the sim region bounds test
+	V3 entityOffset;
+	f32 pixelsPerMeter;
+	f32 sortDepth;
+	V2 center;
+	// NOTE: Bitmaps keep only the height, the width is taken from the bitmap when it is spliced
+	V2 size;
+	V2 offset;
+	V4 color;
+};
+
+struct RetainedRenderBlock {
+	u32 commandCount;
+	RetainedRenderCommand commands[16];
+	RetainedRenderBlock* next;
+};
+
+struct RetainedRenderKey {
+	// NOTE: Camera relative Z of the chunk origin
+	f32 chunkZ;
+	f32 focalLength;
+	f32 distanceToTarget;
+	f32 metersToPixels;
+	V2 screenCenter;
+	bool orthographic;
+};
+
 struct RenderCommandBuffer;
 struct RenderGroup {
 	RenderCommandBuffer* commands;
@@ -102,18 +151,22 @@ struct RenderGroup {
 /*                Renderer API                  */
 inline bool PushClearCall(RenderGroup& group, V4 color = V4{ 1, 1, 1, 1 });
 inline bool PushBitmap(RenderGroup& group, LoadedBitmap* bitmap, ObjectTransform transform, V3 center,
-	V4 color = V4{ 1, 1, 1, 1 }, f32 sortBias = 0.f);
+	V4 color = V4{ 1, 1, 1, 1 }, f32 sortBias = 0.f, u32 textureId = 0);
 inline bool PushBitmap(RenderGroup& group, ObjectTransform transform, BitmapId bid, V3 center,
 	V4 color = V4{ 1, 1, 1, 1 }, f32 sortBias = 0.f);
 inline bool PushRect(RenderGroup& group, ObjectTransform transform, V3 center, V2 size,
 	V4 color = V4{ 1, 1, 1, 1 }, f32 sortBias = 0.f);
 inline bool PushRect(RenderGroup& group, ObjectTransform transform, Rect2 rectangle, f32 Z, V4 color, f32 sortBias = 0.f);
 inline bool PushRectBorders(RenderGroup& group, ObjectTransform transform, V3 center, V2 size, V4 color, f32 thickness, f32 sortBias = 0.f);
+inline bool ProjectRetainedRenderCommand(Projection& projection, RetainedRenderCommand& command, ObjectTransform transform,
+	V3 center, V2 size, f32 sortBias = 0.f);
+internal void SpliceRetainedRenderCommands(RenderGroup& group, RetainedRenderBlock* blocks, V3 chunkPos, Rect3 bounds);
 inline bool PushRectOutlineInside(RenderGroup& group, ObjectTransform transform, Rect2 rect, f32 Z, V4 color, f32 thickness, f32 sortBias = 0.f);
 
 struct RenderCommandBuffer;
 inline RenderGroup BeginRendering(RenderCommandBuffer* commands, Assets* assets, bool renderInBackground = false);
 inline void EndRendering(RenderGroup& group);
+internal void ReleaseRenderCommandsGenerations(RenderCommandBuffer* commands, Assets* assets);
 
 inline V2 FromPixelSpaceToWorldSpace(Projection& projection, V2 pixelSpacePos, f32 atDistanceFromCamera);
 inline Rect2 GetRenderRectangleAtDistance(Projection& projection, u32 width, u32 height, f32 distance);
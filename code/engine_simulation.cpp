@@ -81,6 +81,7 @@ SimRegion* BeginSimulation(MemoryArena& simArena, World& world,
 	SimRegion* simRegion = PushStructSize(simArena, SimRegion);
 	simRegion->entityCount = 0;
 	simRegion->maxEntityCount = ArrayCount(simRegion->entities);
+	simRegion->chunkCount = 0;
 	simRegion->origin = origin;
 	simRegion->bounds = bounds;
 	simRegion->distanceToClosestGroundZ = GetDistanceToTheClosestGroundLevel(world, origin);
@@ -95,6 +96,10 @@ SimRegion* BeginSimulation(MemoryArena& simArena, World& world,
 				if (!chunk) {
 					continue;
 				}
+				Assert(simRegion->chunkCount < ArrayCount(simRegion->chunks));
+				if (simRegion->chunkCount < ArrayCount(simRegion->chunks)) {
+					simRegion->chunks[simRegion->chunkCount++] = chunk;
+				}
 				for (LowEntityBlock* entities = chunk->entities; entities; entities = entities->next) {
 					for (u32 index = 0; index < entities->entityCount; index++) {
 						u32 storageEntityIndex = entities->entityIndexes[index];
@@ -16,5 +16,9 @@ struct SimRegion {
 	u32 entityCount;
 	Entity entities[1024];
 
+	// NOTE: Chunks inside of the bounds which exist, for the retained render commands of static entities
+	u32 chunkCount;
+	WorldChunk* chunks[512];
+
 	EntityHash entityHash[4096];
 };
@@ -47,6 +47,12 @@ bool IsFlagSet(Entity& entity, u32 flag) {
 	return result;
 }
 
+inline
+bool IsStaticEntity(Entity& entity) {
+	// NOTE: Never move, so their render calls are retained by the chunk
+	return entity.type == EntityType_Wall || entity.type == EntityType_Stairs || entity.type == EntityType_Space;
+}
+
 internal
 WorldPosition GetChunkPositionFromWorldPosition(World& world, i32 absX, i32 absY, i32 absZ, V3 offset) {
 	WorldPosition chunkPos = {};
@@ -281,7 +287,18 @@ internal
 void ChangeEntityChunkLocation(World& world, MemoryArena& arena, u32 lowEntityIndex, Entity& entity,
 	WorldPosition* oldPos, WorldPosition& newPos)
 {
+	bool chunkChanged = !oldPos || !AreOnTheSameChunk(*oldPos, newPos);
 	ChangeEntityChunkLocationRaw(world, arena, lowEntityIndex, oldPos, newPos);
+	if (chunkChanged && IsStaticEntity(entity)) {
+		WorldChunk* oldChunk = oldPos && IsValid(*oldPos) ? GetWorldChunk(world, *oldPos) : 0;
+		WorldChunk* newChunk = IsValid(newPos) ? GetWorldChunk(world, newPos) : 0;
+		if (oldChunk) {
+			oldChunk->renderBlocksValid = false;
+		}
+		if (newChunk) {
+			newChunk->renderBlocksValid = false;
+		}
+	}
 	if (!IsValid(newPos)) {
 		SetFlag(entity, EntityFlag_NonSpatial);
 	}
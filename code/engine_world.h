@@ -1,5 +1,6 @@
 #pragma once
 #include "engine_common.h"
+#include "engine_render.h"
 
 struct WorldPosition {
 	// 28 bytes = chunk pos, 4 bytes = tile pos inside chunk
@@ -24,6 +25,11 @@ struct WorldChunk {
 	i32 chunkZ;
 
 	LowEntityBlock* entities;
+	// NOTE: Projected render commands of the static entities, rebuilt when one of them enters or leaves
+	// the chunk or the key doesn't match anymore
+	RetainedRenderBlock* renderBlocks;
+	RetainedRenderKey renderKey;
+	bool renderBlocksValid;
 	WorldChunk* next;
 };
 
@@ -108,6 +114,7 @@ struct World {
 	MemoryArena arena;
 	WorldChunk* hashWorldChunks[4096];
 	LowEntityBlock* freeEntityBlockList;
+	RetainedRenderBlock* freeRenderBlockList;
 
 	u32 storageEntityCount;
 	EntityStorage storageEntities[10000];
@@ -126,6 +133,7 @@ internal WorldPosition OffsetWorldPosition(World& world, WorldPosition& position
 internal V3 Subtract(World& world, WorldPosition& first, WorldPosition& second);
 internal void ChangeEntityChunkLocation(World& world, MemoryArena& arena, u32 lowEntityIndex, Entity& entity, WorldPosition* oldPos, WorldPosition& newPos);
 internal WorldPosition GetChunkPositionFromWorldPosition(World& world, i32 absX, i32 absY, i32 absZ, V3 offset = V3{0.f, 0.f, 0.f});
+inline bool IsStaticEntity(Entity& entity);
 inline void SetFlag(Entity& entity, u32 flag);
 inline void ClearFlag(Entity& entity, u32 flag);
 inline bool IsFlagSet(Entity& entity, u32 flag);
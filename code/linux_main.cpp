@@ -0,0 +1,1130 @@
+#include "engine_platform.h"
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+
+PlatformAPI* Platform;
+
+#include "renderer_software.cpp"
+#include "engine_compression.h"
+
+#if defined(INTERNAL_BUILD)
+void* MEM_ALLOC_START = reinterpret_cast<void*>(TB(static_cast<u64>(10)));
+volatile u32 GLOBAL_THREAD_ID_GEN = 0;
+thread_local u32 THREAD_LOCAL_ID = 0;
+DebugGlobalState debugGlobalState_ = {};
+DebugGlobalState* debugGlobalState = &debugGlobalState_;
+#else
+void* MEM_ALLOC_START = reinterpret_cast<void*>(0);
+#endif
+
+extern "C" GAME_MAIN_LOOP_FRAME(GameMainLoopFrameStub) {}
+extern "C" GAME_FILL_SOUND_BUFFER(GameFillSoundBufferStub) {
+	f32* data = reinterpret_cast<f32*>(soundData.data);
+	for (u32 frame = 0; frame < soundData.nSamples; frame++) {
+		for (u32 channel = 0; channel < soundData.nChannels; channel++) {
+			*data++ = 0;
+		}
+	}
+}
+extern "C" DEBUG_INIT(DebugInitStub) { return 0; }
+extern "C" DEBUG_FINISH_FRAME(DebugFinishFrameStub) { return; };
+
+struct LinuxGameCode {
+	char pathToLib[MY_MAX_PATH] = "engine.so";
+	char pathToTempLib[MY_MAX_PATH] = "engine_temp.so";
+
+	void* lib = nullptr;
+	u64 lastWriteTimestamp = 0;
+	bool isValid = false;
+	bool reloaded = false;
+
+	_GameMainLoopFrame* GameMainLoopFrame = GameMainLoopFrameStub;
+	_GameFillSoundBuffer* GameFillSoundBuffer = GameFillSoundBufferStub;
+	_DebugInit* DebugInit = DebugInitStub;
+	_DebugFinishFrame* DebugFinishFrame = DebugFinishFrameStub;
+};
+
+struct LinuxState {
+	// NOTE: headless, everything is rendered to offscreen bitmap
+	u32 displayWidth;
+	u32 displayHeight;
+	u32 frameCount;
+	bool vsync;
+	const char* benchName;
+	u32 assetMemorySize;
+	u32 assetMemoryMaxSize;
+	f32 assetSoftWatermark;
+	f32 assetHardWatermark;
+	AssetReplacementPolicy assetReplacementPolicy;
+	bool assetMapFiles;
+
+	char exeFilePath[MY_MAX_PATH];
+	char exeDirectory[MY_MAX_PATH];
+	char* exeFileName;
+
+	volatile u32 framesPresented;
+};
+
+// NOTE: Frame N is rasterized by the queue while the main thread simulates frame N + 1,
+// so everything the renderer reads or writes is kept per frame in flight
+#define LINUX_FRAMES_IN_FLIGHT 2
+struct LinuxFrame {
+	RenderCommandBuffer commands;
+	BitmapData bitmap;
+	TiledRenderJob renderJob;
+	PlatformJobNode presentNode;
+	PlatformJobCounter presentCounter;
+};
+
+struct PlatformSemaphore {
+	sem_t handle;
+};
+
+inline
+void PlatformSemaphoreSignal(PlatformSemaphore* semaphore) {
+	sem_post(&semaphore->handle);
+}
+
+inline
+void PlatformSemaphoreWait(PlatformSemaphore* semaphore) {
+	while (sem_wait(&semaphore->handle) != 0 && errno == EINTR) {}
+}
+
+#include "platform_queue.cpp"
+
+// NOTE: munmap needs the size of the mapping, so it is stored in front of every allocation.
+// Header is 64 bytes to keep returned memory aligned for wide SIMD loads
+#define LINUX_ALLOCATION_HEADER_SIZE 64
+
+static bool globalRunning;
+static LinuxFrame globalFrames[LINUX_FRAMES_IN_FLIGHT];
+static LinuxState globalLinuxState;
+static PlatformQueue globalHighPriorityQueue = {};
+static PlatformQueue globalLowPriorityQueue = {};
+
+internal
+void* LinuxAllocateMemory(u64 bytes) {
+	u64 totalSize = bytes + LINUX_ALLOCATION_HEADER_SIZE;
+	void* block = mmap(0, totalSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (block == MAP_FAILED) {
+		return 0;
+	}
+	*ptrcast(u64, block) = totalSize;
+	return ptrcast(u8, block) + LINUX_ALLOCATION_HEADER_SIZE;
+}
+
+internal
+void* LinuxAllocateMemory(u32 bytes) {
+	return LinuxAllocateMemory(u64(bytes));
+}
+
+internal
+void* LinuxReserveMemory(u64 bytes) {
+	void* block = mmap(0, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (block == MAP_FAILED) {
+		return 0;
+	}
+	return block;
+}
+
+internal
+bool LinuxCommitMemory(void* memory, u64 bytes) {
+	return mprotect(memory, bytes, PROT_READ | PROT_WRITE) == 0;
+}
+
+internal
+void LinuxAdviseMemory(void* memory, u64 bytes, PlatformMemoryAdvice advice) {
+	// NOTE: Read ahead may start at the page containing the range, but only pages fully inside
+	// of it can be dropped, the neighbouring asset could still use the rest
+	uptr pageSize = uptr(sysconf(_SC_PAGESIZE));
+	uptr start = uptr(memory);
+	uptr end = start + bytes;
+	if (advice == PlatformMemoryAdvice_WillNeed) {
+		start &= ~(pageSize - 1);
+		madvise(ptrcast(void, start), end - start, MADV_WILLNEED);
+	}
+	else {
+		start = (start + pageSize - 1) & ~(pageSize - 1);
+		end &= ~(pageSize - 1);
+		if (end > start) {
+			madvise(ptrcast(void, start), end - start, MADV_DONTNEED);
+		}
+	}
+}
+
+internal
+void LinuxFreeMemory(void* memory) {
+	if (!memory) {
+		return;
+	}
+	u8* block = ptrcast(u8, memory) - LINUX_ALLOCATION_HEADER_SIZE;
+	munmap(block, *ptrcast(u64, block));
+}
+
+internal
+u32 LinuxAllocateTexture(void* data, u32 width, u32 height) {
+	// NOTE: No GPU in headless mode, assets stay in system memory and software renderer reads them directly
+	return 0;
+}
+
+internal
+void LinuxFreeTexture(u32 textureHandle) {}
+
+internal
+bool LinuxCopyFile(const char* src, const char* dst) {
+	i32 srcFd = open(src, O_RDONLY);
+	if (srcFd < 0) {
+		return false;
+	}
+	i32 dstFd = open(dst, O_WRONLY | O_CREAT | O_TRUNC, 0755);
+	if (dstFd < 0) {
+		close(srcFd);
+		return false;
+	}
+	bool success = true;
+	u8 buffer[kB(64)];
+	while (true) {
+		ssize_t readBytes = read(srcFd, buffer, sizeof(buffer));
+		if (readBytes == 0) {
+			break;
+		}
+		if (readBytes < 0 || write(dstFd, buffer, readBytes) != readBytes) {
+			success = false;
+			break;
+		}
+	}
+	close(srcFd);
+	close(dstFd);
+	return success;
+}
+
+internal
+bool LinuxLoadGameCode(LinuxGameCode& gameCode) {
+	bool success = LinuxCopyFile(gameCode.pathToLib, gameCode.pathToTempLib);
+	gameCode.lib = dlopen(gameCode.pathToTempLib, RTLD_NOW | RTLD_LOCAL);
+	if (gameCode.lib) {
+		gameCode.GameMainLoopFrame = rcst(_GameMainLoopFrame*, dlsym(gameCode.lib, "GameMainLoopFrame"));
+		gameCode.GameFillSoundBuffer = rcst(_GameFillSoundBuffer*, dlsym(gameCode.lib, "GameFillSoundBuffer"));
+		gameCode.DebugInit = rcst(_DebugInit*, dlsym(gameCode.lib, "DebugInit"));
+		gameCode.DebugFinishFrame = rcst(_DebugFinishFrame*, dlsym(gameCode.lib, "DebugFinishFrame"));
+		gameCode.isValid =
+			gameCode.GameMainLoopFrame != nullptr ||
+			gameCode.GameFillSoundBuffer != nullptr;
+		Assert(gameCode.isValid);
+	}
+	else {
+		fprintf(stderr, "Failed to load %s: %s\n", gameCode.pathToTempLib, dlerror());
+	}
+	if (!gameCode.isValid) {
+		gameCode.GameMainLoopFrame = GameMainLoopFrameStub;
+		gameCode.GameFillSoundBuffer = GameFillSoundBufferStub;
+	}
+	if (!gameCode.DebugInit) {
+		gameCode.DebugInit = DebugInitStub;
+	}
+	if (!gameCode.DebugFinishFrame) {
+		gameCode.DebugFinishFrame = DebugFinishFrameStub;
+	}
+	return success;
+}
+
+internal
+void LinuxUnloadGameCode(LinuxGameCode& gameCode) {
+	QueueWaitForCompletion(&globalHighPriorityQueue);
+	QueueWaitForCompletion(&globalLowPriorityQueue);
+	if (gameCode.lib) {
+		dlclose(gameCode.lib);
+		gameCode.lib = nullptr;
+	}
+	gameCode.GameMainLoopFrame = GameMainLoopFrameStub;
+	gameCode.isValid = false;
+}
+
+internal
+u64 LinuxGetLastWriteTime(const char* filename) {
+	struct stat stats = {};
+	if (stat(filename, &stats) != 0) {
+		return 0;
+	}
+	return u64(stats.st_mtim.tv_sec) * 1000000000ull + u64(stats.st_mtim.tv_nsec);
+}
+
+internal
+bool LinuxReloadGameCode(LinuxGameCode& gameCode) {
+	u64 lastWriteTime = LinuxGetLastWriteTime(gameCode.pathToLib);
+	gameCode.reloaded = false;
+	if (lastWriteTime != gameCode.lastWriteTimestamp) {
+		LinuxUnloadGameCode(gameCode);
+		if (LinuxLoadGameCode(gameCode)) {
+			gameCode.lastWriteTimestamp = lastWriteTime;
+			gameCode.reloaded = true;
+		}
+	}
+	return true;
+}
+
+struct ThreadProcArgs {
+	PlatformQueue* queue;
+	u32 workerIndex;
+};
+
+internal
+void* LinuxThreadProc(void* params) {
+	ThreadProcArgs* args = ptrcast(ThreadProcArgs, params);
+	PlatformQueue* queue = args->queue;
+#if INTERNAL_BUILD
+	THREAD_LOCAL_ID = AtomicAddU32(&GLOBAL_THREAD_ID_GEN, 1) + 1;
+#endif
+	QueueWorkerLoop(queue, args->workerIndex);
+	return 0;
+}
+
+internal
+u32 LinuxGetCurrentThreadId() {
+#if INTERNAL_BUILD
+	return THREAD_LOCAL_ID;
+#else
+	return 0;
+#endif
+}
+
+internal
+void InitializeQueue(ThreadProcArgs* threadArgs, u32 threadCount) {
+	Assert(threadCount);
+	PlatformQueue* queue = threadArgs->queue;
+	QueueInitialize(queue, threadCount);
+	sem_init(&queue->semaphore.handle, 0, 0);
+	for (u32 threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+		threadArgs[threadIndex].workerIndex = threadIndex;
+		pthread_t thread;
+		pthread_create(&thread, 0, LinuxThreadProc, threadArgs + threadIndex);
+		pthread_detach(thread);
+	}
+}
+
+// Platform API
+struct LinuxFileHandle {
+	PlatformFileHandle base;
+	i32 fd;
+	i32 errCode;
+	void* mapped;
+};
+
+internal
+PlatformFileHandle* LinuxFileOpen(const char* filename) {
+	LinuxFileHandle* file = ptrcast(LinuxFileHandle, LinuxAllocateMemory(u64(sizeof(LinuxFileHandle))));
+	if (!file) {
+		return 0;
+	}
+	file->errCode = 0;
+	file->mapped = 0;
+	file->fd = open(filename, O_RDONLY);
+	if (file->fd < 0) {
+		file->errCode = errno;
+		LinuxFreeMemory(file);
+		return 0;
+	}
+	struct stat stats = {};
+	fstat(file->fd, &stats);
+	file->base.size = u64(stats.st_size);
+
+	PlatformFileHandle* result = ptrcast(PlatformFileHandle, file);
+	return result;
+}
+
+internal
+void LinuxFileClose(PlatformFileHandle* handle) {
+	if (!handle) {
+		return;
+	}
+	LinuxFileHandle* file = ptrcast(LinuxFileHandle, handle);
+	if (file->mapped) {
+		munmap(file->mapped, file->base.size);
+	}
+	if (file->fd >= 0) {
+		close(file->fd);
+	}
+	LinuxFreeMemory(file);
+}
+
+internal
+bool LinuxFileHasExtension(const char* filename, const char* extension) {
+	u32 nameLength = StringLength(filename);
+	u32 extensionLength = StringLength(extension);
+	if (nameLength <= extensionLength + 1) {
+		return false;
+	}
+	const char* dot = filename + nameLength - extensionLength - 1;
+	return *dot == '.' && StringsAreEqual(dot + 1, extensionLength, extension, extensionLength);
+}
+
+internal
+PlatformFileGroup* LinuxFileGetAllWithExtension(const char* extension) {
+	PlatformFileGroup* group = ptrcast(PlatformFileGroup, LinuxAllocateMemory(u64(sizeof(PlatformFileGroup))));
+	DIR* dir = opendir(".");
+	if (!dir) {
+		return group;
+	}
+	struct dirent* entry;
+	while ((entry = readdir(dir))) {
+		if (entry->d_type == DT_REG && LinuxFileHasExtension(entry->d_name, extension)) {
+			group->count++;
+		}
+	}
+
+	group->files = ptrcast(PlatformFileHandle*, LinuxAllocateMemory(u64(sizeof(PlatformFileHandle*) * group->count)));
+	rewinddir(dir);
+	u32 it = 0;
+	while ((entry = readdir(dir)) && it < group->count) {
+		if (entry->d_type == DT_REG && LinuxFileHasExtension(entry->d_name, extension)) {
+			group->files[it++] = LinuxFileOpen(entry->d_name);
+		}
+	}
+	closedir(dir);
+	return group;
+}
+
+internal
+void LinuxFileCloseAllInGroup(PlatformFileGroup* group) {
+	if (!group) {
+		return;
+	}
+	for (u32 fileIndex = 0; fileIndex < group->count; fileIndex++) {
+		PlatformFileHandle* handle = *(group->files + fileIndex);
+		LinuxFileClose(handle);
+	}
+	LinuxFreeMemory(group->files);
+	LinuxFreeMemory(group);
+}
+
+internal
+bool LinuxFileErrors(PlatformFileHandle* handle) {
+	if (!handle) {
+		return true;
+	}
+	LinuxFileHandle* file = ptrcast(LinuxFileHandle, handle);
+	return file->errCode;
+}
+
+internal
+void LinuxFileRead(PlatformFileHandle* handle, u64 offset, u64 size, void* dst) {
+	LinuxFileHandle* file = ptrcast(LinuxFileHandle, handle);
+	if (!file || file->fd < 0) {
+		return;
+	}
+	// NOTE: pread doesn't move file cursor, so it is safe to call from many threads on the same fd
+	u8* at = ptrcast(u8, dst);
+	u64 remaining = size;
+	off_t fileOffset = off_t(offset);
+	while (remaining) {
+		ssize_t readBytes = pread(file->fd, at, remaining, fileOffset);
+		if (readBytes < 0 && errno == EINTR) {
+			continue;
+		}
+		if (readBytes <= 0) {
+			file->errCode = readBytes < 0 ? errno : EIO;
+			return;
+		}
+		at += readBytes;
+		fileOffset += readBytes;
+		remaining -= readBytes;
+	}
+}
+
+internal
+void* LinuxFileMap(PlatformFileHandle* handle) {
+	LinuxFileHandle* file = ptrcast(LinuxFileHandle, handle);
+	if (!file || file->fd < 0 || !file->base.size) {
+		return 0;
+	}
+	if (!file->mapped) {
+		void* mapped = mmap(0, file->base.size, PROT_READ, MAP_PRIVATE, file->fd, 0);
+		if (mapped == MAP_FAILED) {
+			file->errCode = errno;
+			return 0;
+		}
+		file->mapped = mapped;
+	}
+	return file->mapped;
+}
+
+// NOTE: io_uring is driven with raw syscalls, so there is no liburing dependency
+#define LINUX_ASYNC_READ_ENTRIES 128
+struct LinuxAsyncRead {
+	i32 fd;
+	u64 offset;
+	u8* dst;
+	u32 remainingSize;
+	u32 readBytes;
+	void* userData;
+};
+
+struct LinuxAsyncReads {
+	i32 ringFd;
+	u32 sqEntries;
+	u32 cqEntries;
+	u32* sqHead;
+	u32* sqTail;
+	u32* sqMask;
+	u32* sqArray;
+	io_uring_sqe* sqes;
+	u32* cqHead;
+	u32* cqTail;
+	u32* cqMask;
+	io_uring_cqe* cqes;
+	u32 queuedCount;
+	// NOTE: Reads in flight, the kernel can complete a read short and the rest is queued again
+	LinuxAsyncRead slots[2 * LINUX_ASYNC_READ_ENTRIES];
+	u32 freeSlots[2 * LINUX_ASYNC_READ_ENTRIES];
+	u32 freeSlotCount;
+	u32 slotCount;
+};
+static LinuxAsyncReads globalAsyncReads = { -1 };
+
+internal
+void LinuxInitAsyncReads(LinuxAsyncReads& reads) {
+	reads.ringFd = -1;
+	io_uring_params params = {};
+	i32 ringFd = i4(syscall(__NR_io_uring_setup, LINUX_ASYNC_READ_ENTRIES, &params));
+	if (ringFd < 0) {
+		// NOTE: Old kernel or io_uring is disabled, asset loads fall back to FileRead
+		return;
+	}
+	u64 sqRingSize = params.sq_off.array + params.sq_entries * sizeof(u32);
+	u64 cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+	if (singleMap) {
+		sqRingSize = Maximum(sqRingSize, cqRingSize);
+	}
+	u8* sqRing = ptrcast(u8, mmap(0, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING));
+	u8* cqRing = sqRing;
+	if (sqRing != MAP_FAILED && !singleMap) {
+		cqRing = ptrcast(u8, mmap(0, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING));
+	}
+	void* sqes = MAP_FAILED;
+	if (sqRing != MAP_FAILED && cqRing != MAP_FAILED) {
+		sqes = mmap(0, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+	}
+	if (sqes == MAP_FAILED) {
+		// NOTE: Process is going to use FileRead only, mappings die with it
+		close(ringFd);
+		return;
+	}
+	reads.sqEntries = params.sq_entries;
+	reads.cqEntries = params.cq_entries;
+	reads.sqHead = ptrcast(u32, sqRing + params.sq_off.head);
+	reads.sqTail = ptrcast(u32, sqRing + params.sq_off.tail);
+	reads.sqMask = ptrcast(u32, sqRing + params.sq_off.ring_mask);
+	reads.sqArray = ptrcast(u32, sqRing + params.sq_off.array);
+	reads.sqes = ptrcast(io_uring_sqe, sqes);
+	reads.cqHead = ptrcast(u32, cqRing + params.cq_off.head);
+	reads.cqTail = ptrcast(u32, cqRing + params.cq_off.tail);
+	reads.cqMask = ptrcast(u32, cqRing + params.cq_off.ring_mask);
+	reads.cqes = ptrcast(io_uring_cqe, cqRing + params.cq_off.cqes);
+	reads.slotCount = Minimum(reads.cqEntries, u4(ArrayCount(reads.slots)));
+	reads.freeSlotCount = reads.slotCount;
+	for (u32 slotIndex = 0; slotIndex < reads.freeSlotCount; slotIndex++) {
+		reads.freeSlots[slotIndex] = slotIndex;
+	}
+	reads.ringFd = ringFd;
+}
+
+internal
+void LinuxSubmitQueuedReads(LinuxAsyncReads& reads) {
+	while (reads.queuedCount) {
+		i32 submitted = i4(syscall(__NR_io_uring_enter, reads.ringFd, reads.queuedCount, 0, 0, 0, 0));
+		if (submitted < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			// NOTE: EAGAIN/EBUSY, kernel is out of resources, retry on the next poll
+			break;
+		}
+		reads.queuedCount -= u4(submitted);
+	}
+}
+
+internal
+bool LinuxQueueAsyncRead(LinuxAsyncReads& reads, u32 slotIndex) {
+	u32 tail = *reads.sqTail;
+	if (tail - __atomic_load_n(reads.sqHead, __ATOMIC_ACQUIRE) == reads.sqEntries) {
+		LinuxSubmitQueuedReads(reads);
+		if (tail - __atomic_load_n(reads.sqHead, __ATOMIC_ACQUIRE) == reads.sqEntries) {
+			return false;
+		}
+	}
+	LinuxAsyncRead* read = reads.slots + slotIndex;
+	u32 index = tail & *reads.sqMask;
+	io_uring_sqe* sqe = reads.sqes + index;
+	*sqe = {};
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = read->fd;
+	sqe->off = read->offset;
+	sqe->addr = u64(read->dst);
+	sqe->len = read->remainingSize;
+	sqe->user_data = slotIndex;
+	reads.sqArray[index] = index;
+	__atomic_store_n(reads.sqTail, tail + 1, __ATOMIC_RELEASE);
+	reads.queuedCount++;
+	return true;
+}
+
+internal
+bool LinuxFileReadAsync(PlatformFileHandle* handle, u64 offset, u32 size, void* dst, void* userData) {
+	LinuxFileHandle* file = ptrcast(LinuxFileHandle, handle);
+	LinuxAsyncReads& reads = globalAsyncReads;
+	// NOTE: Completion ring must have room for every read in flight, kernel drops completions otherwise,
+	// there is a free slot only when it has
+	if (reads.ringFd < 0 || !file || file->fd < 0 || !reads.freeSlotCount) {
+		return false;
+	}
+	u32 slotIndex = reads.freeSlots[reads.freeSlotCount - 1];
+	LinuxAsyncRead* read = reads.slots + slotIndex;
+	read->fd = file->fd;
+	read->offset = offset;
+	read->dst = ptrcast(u8, dst);
+	read->remainingSize = size;
+	read->readBytes = 0;
+	read->userData = userData;
+	if (!LinuxQueueAsyncRead(reads, slotIndex)) {
+		return false;
+	}
+	reads.freeSlotCount--;
+	return true;
+}
+
+internal
+bool LinuxContinueAsyncRead(LinuxAsyncReads& reads, u32 slotIndex, i32 result) {
+	// NOTE: Returns true while the read is still in flight. Short reads are queued again for the rest,
+	// or finished here with pread when the submission ring is full
+	LinuxAsyncRead* read = reads.slots + slotIndex;
+	bool interrupted = result == -EINTR || result == -EAGAIN;
+	if (!interrupted) {
+		if (result <= 0) {
+			return false;
+		}
+		read->offset += u4(result);
+		read->dst += u4(result);
+		read->remainingSize -= u4(result);
+		read->readBytes += u4(result);
+		if (!read->remainingSize) {
+			return false;
+		}
+	}
+	if (LinuxQueueAsyncRead(reads, slotIndex)) {
+		return true;
+	}
+	while (read->remainingSize) {
+		ssize_t readBytes = pread(read->fd, read->dst, read->remainingSize, off_t(read->offset));
+		if (readBytes < 0 && errno == EINTR) {
+			continue;
+		}
+		if (readBytes <= 0) {
+			break;
+		}
+		read->offset += u64(readBytes);
+		read->dst += readBytes;
+		read->remainingSize -= u4(readBytes);
+		read->readBytes += u4(readBytes);
+	}
+	return false;
+}
+
+internal
+u32 LinuxFileReadAsyncPoll(PlatformFileReadCompletion* completions, u32 maxCount, bool wait) {
+	LinuxAsyncReads& reads = globalAsyncReads;
+	if (reads.ringFd < 0) {
+		return 0;
+	}
+	LinuxSubmitQueuedReads(reads);
+	u32 count = 0;
+	u32 head = *reads.cqHead;
+	// NOTE: Rest of a short read goes back in flight, so waiting goes on until a read really finishes
+	bool waiting = wait;
+	while (!count) {
+		u32 tail = __atomic_load_n(reads.cqTail, __ATOMIC_ACQUIRE);
+		if (head == tail) {
+			if (!waiting || reads.freeSlotCount == reads.slotCount) {
+				break;
+			}
+			i32 entered = i4(syscall(__NR_io_uring_enter, reads.ringFd, reads.queuedCount, 1, IORING_ENTER_GETEVENTS, 0, 0));
+			if (entered >= 0) {
+				reads.queuedCount -= u4(entered);
+			}
+			else if (errno != EINTR) {
+				waiting = false;
+			}
+			continue;
+		}
+		while (head != tail && count < maxCount) {
+			io_uring_cqe* cqe = reads.cqes + (head & *reads.cqMask);
+			u32 slotIndex = u4(cqe->user_data);
+			i32 result = cqe->res;
+			// NOTE: Entry is given back before the rest of a short read is queued, so its completion has room
+			__atomic_store_n(reads.cqHead, ++head, __ATOMIC_RELEASE);
+			if (LinuxContinueAsyncRead(reads, slotIndex, result)) {
+				continue;
+			}
+			LinuxAsyncRead* read = reads.slots + slotIndex;
+			PlatformFileReadCompletion* completion = completions + count++;
+			completion->userData = read->userData;
+			completion->readBytes = read->readBytes;
+			completion->failed = result < 0 && result != -EINTR && result != -EAGAIN;
+			reads.freeSlots[reads.freeSlotCount++] = slotIndex;
+		}
+		if (!waiting) {
+			break;
+		}
+	}
+	LinuxSubmitQueuedReads(reads);
+	return count;
+}
+
+internal
+PlatformCommandHandle LinuxSystemExecuteCommand(char* cwd, char* command) {
+	PlatformCommandHandle result = {};
+	pid_t pid = fork();
+	if (pid < 0) {
+		result.state = CmdState_Failed;
+		return result;
+	}
+	if (pid == 0) {
+		if (cwd && chdir(cwd) != 0) {
+			_exit(1);
+		}
+		execl("/bin/sh", "sh", "-c", command, (char*)0);
+		_exit(1);
+	}
+	result.processHandle = u64(pid);
+	result.state = CmdState_Running;
+	return result;
+}
+
+internal
+PlatformCommandState LinuxSystemGetCommandState(PlatformCommandHandle& command) {
+	i32 status = 0;
+	pid_t state = waitpid(pid_t(command.processHandle), &status, WNOHANG);
+	if (state == 0) {
+		command.state = CmdState_Running;
+	}
+	else if (state > 0) {
+		if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+			command.state = CmdState_Completed;
+		}
+		else {
+			command.state = CmdState_Failed;
+		}
+	}
+	else {
+		command.state = CmdState_Failed;
+	}
+	return command.state;
+}
+
+internal
+void* DebugAllocate(u64 size) {
+	return LinuxAllocateMemory(size);
+}
+
+internal
+FileData DebugReadEntireFile(const char* filename) {
+	i32 fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		// TODO: LOGGING
+		return FileData{ nullptr, 0 };
+	}
+	struct stat stats = {};
+	if (fstat(fd, &stats) != 0) {
+		// TODO: LOGGING
+		close(fd);
+		return FileData{ nullptr, 0 };
+	}
+	// NOTE: For now support only reading files up to 4gb
+	Assert(u64(stats.st_size) < UINT32_MAX);
+	u64 fileSize = u64(stats.st_size);
+	void* fileContent = LinuxAllocateMemory(fileSize);
+	if (!fileContent) {
+		// TODO: LOGGING
+		close(fd);
+		return FileData{ nullptr, 0 };
+	}
+	if (read(fd, fileContent, fileSize) != ssize_t(fileSize)) {
+		// TODO: LOGGING
+		LinuxFreeMemory(fileContent);
+		close(fd);
+		return FileData{ nullptr, 0 };
+	}
+	close(fd);
+	return FileData{ fileContent, fileSize };
+}
+
+internal
+bool DebugWriteToFile(const char* filename, void* buffer, u64 size) {
+	i32 fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		// TODO: LOGGING
+		return false;
+	}
+	// NOTE: For now support only reading files up to 4gb
+	Assert(size < UINT32_MAX);
+	if (write(fd, buffer, size) != ssize_t(size)) {
+		// TODO: LOGGING
+		close(fd);
+		return false;
+	}
+	close(fd);
+	return true;
+}
+
+internal
+void DebugFreeFile(FileData& file) {
+	LinuxFreeMemory(file.content);
+}
+
+internal
+void LinuxResizeBitmapMemory(BitmapData& bitmap, u32 newWidth, u32 newHeight) {
+	// NOTE: Tiled software renderer works on 8 pixels wide lanes, rows are padded to full lanes
+	bitmap.width = newWidth;
+	bitmap.height = newHeight;
+	bitmap.pitch = BITMAP_BYTES_PER_PIXEL * AlignUp8(bitmap.width);
+
+	if (bitmap.data) {
+		LinuxFreeMemory(bitmap.data);
+	}
+	bitmap.data = LinuxAllocateMemory(u64(bitmap.pitch) * bitmap.height);
+}
+
+inline
+u64 LinuxGetCurrentTimestamp() {
+	timespec timestamp = {};
+	clock_gettime(CLOCK_MONOTONIC, &timestamp);
+	return u64(timestamp.tv_sec) * 1000000000ull + u64(timestamp.tv_nsec);
+}
+
+inline internal
+f32 LinuxCalculateTimeElapsed(u64 startTime, u64 endTime) {
+	return f4(f64(endTime - startTime) / 1e9);
+}
+
+internal
+void LinuxSleepUntil(u64 timestamp) {
+	u64 now = LinuxGetCurrentTimestamp();
+	if (now < timestamp) {
+		timespec sleepTime = {};
+		u64 diff = timestamp - now;
+		sleepTime.tv_sec = diff / 1000000000ull;
+		sleepTime.tv_nsec = diff % 1000000000ull;
+		nanosleep(&sleepTime, 0);
+	}
+}
+
+internal
+void LinuxPresentFrame(void* data) {
+	// NOTE: Headless, there is nothing to show. Frame's bitmap is complete here
+	AtomicAddU32(&globalLinuxState.framesPresented, 1);
+}
+
+internal
+void LinuxBeginRenderCommands(LinuxFrame* frame, PlatformQueue* queue) {
+	// NOTE: sort -> rasterize tiles -> present, main thread doesn't wait for any of them
+	RenderCommandBuffer* renderCommands = &frame->commands;
+	if (renderCommands->pushBufferCount > renderCommands->sortBufferCount) {
+		LinuxFreeMemory(renderCommands->sortTempBuffer);
+		renderCommands->sortBufferCount = renderCommands->pushBufferCount;
+		renderCommands->sortTempBuffer = ptrcast(SortElement, LinuxAllocateMemory(u64(sizeof(SortElement) * renderCommands->sortBufferCount)));
+	}
+
+	LoadedBitmap dstBuffer = {};
+	dstBuffer.height = frame->bitmap.height;
+	dstBuffer.width = frame->bitmap.width;
+	dstBuffer.data = ptrcast(u32, frame->bitmap.data);
+	dstBuffer.pitch = frame->bitmap.pitch;
+	BeginTiledRenderGroupToBuffer(&frame->renderJob, renderCommands, dstBuffer, queue, TiledRender_SortCommands);
+	QueuePushTaskAfter(queue, &frame->renderJob.tilesCounter, &frame->presentNode, LinuxPresentFrame, frame, &frame->presentCounter);
+}
+
+internal
+void LinuxFinishFrame(LinuxFrame* frame, PlatformQueue* queue) {
+	QueueWaitForCounter(queue, &frame->presentCounter);
+	ResetRenderCommands(&frame->commands);
+}
+
+internal
+ProgramMemory LinuxInitProgramMemory(LinuxState& state) {
+	ProgramMemory programMemory = {};
+	programMemory.debug.FreeFile = DebugFreeFile;
+	programMemory.debug.ReadEntireFile = DebugReadEntireFile;
+	programMemory.debug.WriteFile = DebugWriteToFile;
+	programMemory.debug.Allocate = DebugAllocate;
+	programMemory.debug.GetCurrThreadId = LinuxGetCurrentThreadId;
+	programMemory.permanentMemorySize = MB(64);
+	programMemory.transientMemorySize = MB(512);
+#if defined(INTERNAL_BUILD)
+	programMemory.debugMemorySize = MB(512);
+#else
+	programMemory.debugMemorySize = 0;
+#endif
+	programMemory.memoryBlockSize = programMemory.permanentMemorySize +
+		programMemory.transientMemorySize +
+		programMemory.debugMemorySize;
+	// NOTE: Address is only a hint, kernel is free to place the block somewhere else
+	programMemory.memoryBlock = mmap(
+		MEM_ALLOC_START,
+		programMemory.memoryBlockSize,
+		PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+		-1, 0
+	);
+	if (programMemory.memoryBlock == MAP_FAILED) {
+		// TODO log error
+		return {};
+	}
+	programMemory.permanentMemory = programMemory.memoryBlock;
+	programMemory.transientMemory = ptrcast(void, ptrcast(u8, programMemory.permanentMemory) +
+		programMemory.permanentMemorySize);
+	programMemory.debugMemory = ptrcast(void, ptrcast(u8, programMemory.transientMemory) +
+		programMemory.transientMemorySize);
+	programMemory.platformAPI.QueuePushTask = QueuePushTask;
+	programMemory.platformAPI.QueuePushTaskAfter = QueuePushTaskAfter;
+	programMemory.platformAPI.QueueWaitForCompletion = QueueWaitForCompletion;
+	programMemory.platformAPI.QueueWaitForCounter = QueueWaitForCounter;
+	programMemory.platformAPI.QueueThreadCount = QueueThreadCount;
+	programMemory.platformAPI.FileOpen = LinuxFileOpen;
+	programMemory.platformAPI.FileClose = LinuxFileClose;
+	programMemory.platformAPI.FileOpenAllWithExtension = LinuxFileGetAllWithExtension;
+	programMemory.platformAPI.FileCloseAllInGroup = LinuxFileCloseAllInGroup;
+	programMemory.platformAPI.FileErrors = LinuxFileErrors;
+	programMemory.platformAPI.FileRead = LinuxFileRead;
+	programMemory.platformAPI.FileMap = LinuxFileMap;
+	programMemory.platformAPI.FileReadAsync = LinuxFileReadAsync;
+	programMemory.platformAPI.FileReadAsyncPoll = LinuxFileReadAsyncPoll;
+	programMemory.platformAPI.MemoryAllocate = LinuxAllocateMemory;
+	programMemory.platformAPI.MemoryFree = LinuxFreeMemory;
+	programMemory.platformAPI.MemoryReserve = LinuxReserveMemory;
+	programMemory.platformAPI.MemoryCommit = LinuxCommitMemory;
+	programMemory.platformAPI.MemoryAdvise = LinuxAdviseMemory;
+	programMemory.platformAPI.SystemExecuteCommand = LinuxSystemExecuteCommand;
+	programMemory.platformAPI.SystemGetCommandState = LinuxSystemGetCommandState;
+	programMemory.platformAPI.TextureAllocate = LinuxAllocateTexture;
+	programMemory.platformAPI.TextureFree = LinuxFreeTexture;
+
+	programMemory.highPriorityQueue = &globalHighPriorityQueue;
+	programMemory.lowPriorityQueue = &globalLowPriorityQueue;
+	programMemory.assetMemoryConfig.initialSize = state.assetMemorySize;
+	programMemory.assetMemoryConfig.maxSize = state.assetMemoryMaxSize;
+	programMemory.assetMemoryConfig.softWatermark = state.assetSoftWatermark;
+	programMemory.assetMemoryConfig.hardWatermark = state.assetHardWatermark;
+	programMemory.assetMemoryConfig.replacementPolicy = state.assetReplacementPolicy;
+	programMemory.assetMemoryConfig.mapFiles = state.assetMapFiles;
+	return programMemory;
+}
+
+// NOTE: Asset benches drive the engine's loader through the platform API, so the asset system is built in too
+#include "engine_rand.cpp"
+#include "engine_assets.cpp"
+#include "bench.cpp"
+
+internal
+void LinuxParseCommandLine(LinuxState& state, i32 argc, char** argv) {
+	for (i32 argIndex = 1; argIndex < argc; argIndex++) {
+		const char* arg = argv[argIndex];
+		bool hasValue = argIndex + 1 < argc;
+		if (strcmp(arg, "--frames") == 0 && hasValue) {
+			state.frameCount = u4(atoi(argv[++argIndex]));
+		}
+		else if (strcmp(arg, "--width") == 0 && hasValue) {
+			state.displayWidth = u4(atoi(argv[++argIndex]));
+		}
+		else if (strcmp(arg, "--height") == 0 && hasValue) {
+			state.displayHeight = u4(atoi(argv[++argIndex]));
+		}
+		else if (strcmp(arg, "--vsync") == 0) {
+			state.vsync = true;
+		}
+		else if (strcmp(arg, "--bench") == 0 && hasValue) {
+			state.benchName = argv[++argIndex];
+		}
+		else if (strcmp(arg, "--asset-memory") == 0 && hasValue) {
+			state.assetMemorySize = MB(u4(atoi(argv[++argIndex])));
+		}
+		else if (strcmp(arg, "--asset-memory-max") == 0 && hasValue) {
+			state.assetMemoryMaxSize = MB(u4(atoi(argv[++argIndex])));
+		}
+		else if (strcmp(arg, "--asset-soft-watermark") == 0 && hasValue) {
+			state.assetSoftWatermark = f4(atof(argv[++argIndex]));
+		}
+		else if (strcmp(arg, "--asset-hard-watermark") == 0 && hasValue) {
+			state.assetHardWatermark = f4(atof(argv[++argIndex]));
+		}
+		else if (strcmp(arg, "--asset-policy") == 0 && hasValue) {
+			const char* policy = argv[++argIndex];
+			state.assetReplacementPolicy = strcmp(policy, "clock") == 0 ? AssetReplacement_Clock : AssetReplacement_Adaptive;
+		}
+		else if (strcmp(arg, "--asset-map") == 0) {
+			state.assetMapFiles = true;
+		}
+		else {
+			fprintf(stderr, "Usage: %s [--frames N] [--width W] [--height H] [--vsync] [--bench name] "
+				"[--asset-memory MB] [--asset-memory-max MB] [--asset-soft-watermark F] [--asset-hard-watermark F] "
+				"[--asset-policy adaptive|clock] [--asset-map]\n", argv[0]);
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	globalLinuxState.displayWidth = 960;
+	globalLinuxState.displayHeight = 540;
+	globalLinuxState.frameCount = 0; // NOTE: 0 means run until killed
+	globalLinuxState.vsync = false;
+	LinuxParseCommandLine(globalLinuxState, argc, argv);
+	u32 processorCount = u4(Maximum(sysconf(_SC_NPROCESSORS_ONLN), 1l));
+	{
+		// NOTE: Threads read their args after this scope ends, so they can't live on the stack
+		u32 threadCount = QueueHighPriorityWorkerCount(processorCount);
+		local_persist ThreadProcArgs threadArgs[PLATFORM_QUEUE_MAX_WORKERS] = {};
+		for (u32 thread = 0; thread < threadCount; thread++) {
+			threadArgs[thread] = { &globalHighPriorityQueue, 0 };
+		}
+		InitializeQueue(threadArgs, threadCount);
+	}
+	{
+		// NOTE: Windows needs shared GL contexts on these threads for texture uploads, headless doesn't
+		u32 threadCount = QueueLowPriorityWorkerCount(processorCount);
+		local_persist ThreadProcArgs threadArgs[PLATFORM_QUEUE_MAX_WORKERS] = {};
+		for (u32 thread = 0; thread < threadCount; thread++) {
+			threadArgs[thread] = { &globalLowPriorityQueue, 0 };
+		}
+		InitializeQueue(threadArgs, threadCount);
+	}
+
+	LinuxInitAsyncReads(globalAsyncReads);
+	ProgramMemory programMemory = LinuxInitProgramMemory(globalLinuxState);
+	if (!programMemory.memoryBlock) {
+		// TODO: Logging
+		return 1;
+	}
+	Platform = &programMemory.platformAPI;
+	debugGlobalMemory = &programMemory;
+	InitializeSoftwareRenderer(GetCpuSimdLevel());
+	if (globalLinuxState.benchName) {
+		return LinuxRunBench(globalLinuxState.benchName, &globalHighPriorityQueue) ? 0 : 1;
+	}
+
+	LinuxGameCode gameCode = {};
+	ssize_t length = readlink("/proc/self/exe", globalLinuxState.exeFilePath, MY_MAX_PATH - 1);
+	length = Maximum(0, length);
+	globalLinuxState.exeFilePath[length] = 0;
+	globalLinuxState.exeFileName = globalLinuxState.exeFilePath;
+	char* tmpChar = globalLinuxState.exeFilePath;
+	for (u32 charIndex = 0; charIndex < length; charIndex++) {
+		if (*tmpChar == '/') {
+			globalLinuxState.exeFileName = tmpChar + 1;
+		}
+		tmpChar++;
+	}
+	CopyString(globalLinuxState.exeFilePath, globalLinuxState.exeFileName - globalLinuxState.exeFilePath, globalLinuxState.exeDirectory, MY_MAX_PATH);
+	char tmpStr[MY_MAX_PATH];
+	CopyString(gameCode.pathToLib, MY_MAX_PATH, tmpStr, MY_MAX_PATH);
+	ConcatenateString(globalLinuxState.exeDirectory, MY_MAX_PATH, tmpStr, MY_MAX_PATH, gameCode.pathToLib, MY_MAX_PATH);
+	CopyString(gameCode.pathToTempLib, MY_MAX_PATH, tmpStr, MY_MAX_PATH);
+	ConcatenateString(globalLinuxState.exeDirectory, MY_MAX_PATH, tmpStr, MY_MAX_PATH, gameCode.pathToTempLib, MY_MAX_PATH);
+	LinuxReloadGameCode(gameCode);
+#if INTERNAL_BUILD
+	debugGlobalState = gameCode.DebugInit(programMemory);
+#endif
+	MARKUP_FRAME_BEGIN;
+	InputData inputData = {};
+	globalRunning = true;
+
+	u32 frameRefreshHz = 60;
+	f32 targetFrameRefreshSeconds = 1.0f / f4(frameRefreshHz);
+
+	// NOTE: There is no audio device, sound is still mixed to exercise the same code path as on windows
+	SoundData soundData = {};
+	soundData.nChannels = 2;
+	soundData.nSamplesPerSec = SOUND_SAMPLES_PER_SECOND;
+	soundData.nSamples = AlignUp8(u4(soundData.nSamplesPerSec * targetFrameRefreshSeconds));
+	soundData.data = LinuxAllocateMemory(u64(sizeof(f32) * soundData.nSamples * soundData.nChannels));
+
+	for (u32 frameIndex = 0; frameIndex < ArrayCount(globalFrames); frameIndex++) {
+		LinuxFrame* frame = globalFrames + frameIndex;
+		LinuxResizeBitmapMemory(frame->bitmap, globalLinuxState.displayWidth, globalLinuxState.displayHeight);
+		RenderCommandBuffer& renderCommands = frame->commands;
+		renderCommands.maxPushBufferSize = MB(4);
+		renderCommands.pushBuffer = ptrcast(u8, LinuxAllocateMemory(u64(renderCommands.maxPushBufferSize)));
+		renderCommands.sortBufferAt = renderCommands.maxPushBufferSize;
+		renderCommands.pushBufferCount = 0;
+		renderCommands.pushBufferSize = 0;
+		renderCommands.sortBufferCount = 256;
+		renderCommands.sortTempBuffer = ptrcast(SortElement, LinuxAllocateMemory(u64(sizeof(SortElement) * renderCommands.sortBufferCount)));
+	}
+
+	u64 runStartTime = LinuxGetCurrentTimestamp();
+	u64 frameStartTime = runStartTime;
+	u32 framesDone = 0;
+	while (globalRunning) {
+		LinuxReloadGameCode(gameCode);
+#if INTERNAL_BUILD
+		debugGlobalState = gameCode.DebugInit(programMemory);
+#endif
+
+		inputData.dtFrame = targetFrameRefreshSeconds;
+		programMemory.executableReloaded = gameCode.reloaded;
+		// PART: Waiting for the renderer to give back the buffers of this frame slot
+		LinuxFrame* frame = globalFrames + (framesDone % LINUX_FRAMES_IN_FLIGHT);
+		LinuxFinishFrame(frame, &globalHighPriorityQueue);
+
+		TIMED_BLOCK_BEGIN(GameMainLoop);
+		// PART: Game main loop
+		u32 renderWidth = frame->bitmap.width;
+		u32 renderHeight = frame->bitmap.height;
+		gameCode.GameMainLoopFrame(programMemory, &frame->commands, inputData, renderWidth, renderHeight);
+		TIMED_BLOCK_END;
+#if INTERNAL_BUILD
+		gameCode.DebugFinishFrame(programMemory, &frame->commands, inputData, renderWidth, renderHeight);
+#endif
+		// PART: Rendering to offscreen bitmap, finishes while the next frame is simulated
+		LinuxBeginRenderCommands(frame, &globalHighPriorityQueue);
+		MARKUP_FRAME_END;
+
+		// PART: Mixing sound to nowhere
+		TIMED_BLOCK_BEGIN(GatherAndRenderSound);
+		gameCode.GameFillSoundBuffer(programMemory, soundData);
+		TIMED_BLOCK_END;
+
+		if (globalLinuxState.vsync) {
+			LinuxSleepUntil(frameStartTime + u64(targetFrameRefreshSeconds * 1e9f));
+		}
+		frameStartTime = LinuxGetCurrentTimestamp();
+		framesDone++;
+		if (globalLinuxState.frameCount && framesDone >= globalLinuxState.frameCount) {
+			globalRunning = false;
+		}
+	}
+	for (u32 frameIndex = 0; frameIndex < ArrayCount(globalFrames); frameIndex++) {
+		LinuxFinishFrame(globalFrames + frameIndex, &globalHighPriorityQueue);
+	}
+	QueueWaitForCompletion(&globalHighPriorityQueue);
+	QueueWaitForCompletion(&globalLowPriorityQueue);
+	Assert(globalLinuxState.framesPresented == framesDone);
+	f32 secondsElapsed = LinuxCalculateTimeElapsed(runStartTime, LinuxGetCurrentTimestamp());
+	printf("%u frames in %.3fs (%.3fms/frame, %.1f fps)\n", framesDone, secondsElapsed,
+		1000.f * secondsElapsed / f4(Maximum(1u, framesDone)), f4(framesDone) / secondsElapsed);
+	return 0;
+}
@@ -0,0 +1,283 @@
+/* Work-stealing task queue shared by platform layers.
+ * Every worker thread owns one Chase-Lev deque: owner pushes and pops at the bottom without
+ * any atomic RMW, other threads steal from the top with a single CAS. Deque 0 is used by threads
+ * which are not workers of the queue (main thread), its owner side is guarded by submitLock.
+ * Tasks can depend on a PlatformJobCounter: they are parked on the counter and submitted by the
+ * thread which finishes the last task of that counter, so nobody has to block to build a pipeline.
+ *
+ * NOTE: Platform layer has to define PlatformSemaphore, PlatformSemaphoreSignal() and
+ * PlatformSemaphoreWait() before including this file.
+ */
+
+#define PLATFORM_QUEUE_MAX_WORKERS 64
+#define PLATFORM_QUEUE_DEQUE_SIZE 256
+static_assert((PLATFORM_QUEUE_DEQUE_SIZE & (PLATFORM_QUEUE_DEQUE_SIZE - 1)) == 0);
+
+struct PlatformQueueTask {
+	PlatformQueueCallback callback;
+	void* args;
+	PlatformJobCounter* counter;
+};
+
+struct alignas(64) PlatformQueueDeque {
+	volatile u32 top;
+	u8 pad0[60];
+	volatile u32 bottom;
+	u8 pad1[60];
+	PlatformQueueTask tasks[PLATFORM_QUEUE_DEQUE_SIZE];
+};
+
+struct PlatformQueue {
+	PlatformQueueDeque deques[PLATFORM_QUEUE_MAX_WORKERS + 1];
+	u32 dequeCount;
+	volatile u32 submitLock;
+	alignas(64) PlatformJobCounter pending;
+	alignas(64) volatile u32 sleepingWorkers;
+	PlatformSemaphore semaphore;
+};
+
+enum QueueStealResult {
+	QueueSteal_Empty,
+	QueueSteal_Success,
+	QueueSteal_Contended
+};
+
+thread_local PlatformQueue* THREAD_LOCAL_QUEUE = 0;
+thread_local u32 THREAD_LOCAL_DEQUE_INDEX = 0;
+
+inline
+bool QueueDequePush(PlatformQueueDeque* deque, PlatformQueueTask task) {
+	// NOTE: Owner only
+	u32 bottom = deque->bottom;
+	u32 top = deque->top;
+	ReadCompilatorFence;
+	if (i4(bottom - top) >= PLATFORM_QUEUE_DEQUE_SIZE) {
+		return false;
+	}
+	deque->tasks[bottom & (PLATFORM_QUEUE_DEQUE_SIZE - 1)] = task;
+	WriteCompilatorFence;
+	deque->bottom = bottom + 1;
+	return true;
+}
+
+inline
+bool QueueDequePop(PlatformQueueDeque* deque, PlatformQueueTask* task) {
+	// NOTE: Owner only
+	u32 bottom = deque->bottom - 1;
+	deque->bottom = bottom;
+	FullMemoryFence;
+	u32 top = deque->top;
+	if (i4(bottom - top) < 0) {
+		deque->bottom = bottom + 1;
+		return false;
+	}
+	*task = deque->tasks[bottom & (PLATFORM_QUEUE_DEQUE_SIZE - 1)];
+	if (bottom != top) {
+		return true;
+	}
+	// NOTE: Last task in the deque, race with thieves for it
+	bool won = AtomicCompareExchange(&deque->top, top + 1, top) == top;
+	deque->bottom = top + 1;
+	return won;
+}
+
+inline
+QueueStealResult QueueDequeSteal(PlatformQueueDeque* deque, PlatformQueueTask* task) {
+	u32 top = deque->top;
+	ReadCompilatorFence;
+	u32 bottom = deque->bottom;
+	if (i4(bottom - top) <= 0) {
+		return QueueSteal_Empty;
+	}
+	*task = deque->tasks[top & (PLATFORM_QUEUE_DEQUE_SIZE - 1)];
+	if (AtomicCompareExchange(&deque->top, top + 1, top) != top) {
+		return QueueSteal_Contended;
+	}
+	return QueueSteal_Success;
+}
+
+// NOTE: High priority workers take every logical processor but the main thread's one. Low priority
+// workers mostly wait on file reads and fill background caches, so they get a fraction of them
+inline
+u32 QueueHighPriorityWorkerCount(u32 processorCount) {
+	u32 result = processorCount > 1 ? processorCount - 1 : 1;
+	return Minimum(result, u32(PLATFORM_QUEUE_MAX_WORKERS));
+}
+
+inline
+u32 QueueLowPriorityWorkerCount(u32 processorCount) {
+	u32 result = Maximum(processorCount / 8, 2u);
+	return Minimum(result, u32(PLATFORM_QUEUE_MAX_WORKERS));
+}
+
+internal
+void QueueInitialize(PlatformQueue* queue, u32 workerCount) {
+	Assert(workerCount <= PLATFORM_QUEUE_MAX_WORKERS);
+	queue->dequeCount = workerCount + 1;
+}
+
+internal void QueueSignalCounter(PlatformJobCounter* counter);
+
+inline
+void QueueRunTask(PlatformQueue* queue, PlatformQueueTask task) {
+	task.callback(task.args);
+	if (task.counter) {
+		QueueSignalCounter(task.counter);
+	}
+	// NOTE: Nothing can depend on pending counter, it is not visible outside of the queue
+	AtomicAddU32(&queue->pending.remaining, U32_MAX);
+}
+
+internal
+bool QueueSubmitTask(PlatformQueue* queue, PlatformQueueTask task) {
+	// NOTE: Counters must be already incremented by the caller
+	bool pushed = false;
+	if (THREAD_LOCAL_QUEUE == queue) {
+		pushed = QueueDequePush(queue->deques + THREAD_LOCAL_DEQUE_INDEX, task);
+	}
+	else {
+		while (AtomicCompareExchange(&queue->submitLock, 1, 0) != 0) { _mm_pause(); }
+		pushed = QueueDequePush(queue->deques, task);
+		AtomicExchangeU32(&queue->submitLock, 0);
+	}
+	if (!pushed) {
+		// NOTE: Deque is full, the task can't be dropped because somebody might wait for its counter,
+		// so the submitting thread pays for it
+		QueueRunTask(queue, task);
+		return false;
+	}
+	// NOTE: Pairs with sleepingWorkers increment in QueueWorkerLoop, either we see the sleeper
+	// or the sleeper sees our task before going to sleep
+	FullMemoryFence;
+	if (queue->sleepingWorkers) {
+		PlatformSemaphoreSignal(&queue->semaphore);
+	}
+	return true;
+}
+
+internal
+void QueueSignalCounter(PlatformJobCounter* counter) {
+	// NOTE: Decrement is done under the lock, otherwise the counter could be reused and get new
+	// continuations between reaching zero and detaching the old ones
+	while (AtomicCompareExchange(&counter->lock, 1, 0) != 0) { _mm_pause(); }
+	PlatformJobNode* node = 0;
+	if (AtomicAddU32(&counter->remaining, U32_MAX) == 1) {
+		node = counter->continuations;
+		counter->continuations = 0;
+	}
+	AtomicExchangeU32(&counter->lock, 0);
+	// NOTE: Nodes might be reused by their owners as soon as they are submitted
+	while (node) {
+		PlatformJobNode* next = node->next;
+		QueueSubmitTask(node->queue, PlatformQueueTask{ node->callback, node->args, node->counter });
+		node = next;
+	}
+}
+
+internal
+u32 QueueThreadCount(PlatformQueue* queue) {
+	return queue->dequeCount;
+}
+
+internal
+bool QueuePushTask(PlatformQueue* queue, PlatformQueueCallback callback, void* args, PlatformJobCounter* counter) {
+	PlatformQueueTask task = { callback, args, counter };
+	if (counter) {
+		AtomicAddU32(&counter->remaining, 1);
+	}
+	AtomicAddU32(&queue->pending.remaining, 1);
+	return QueueSubmitTask(queue, task);
+}
+
+internal
+void QueuePushTaskAfter(PlatformQueue* queue, PlatformJobCounter* dependency, PlatformJobNode* node,
+	PlatformQueueCallback callback, void* args, PlatformJobCounter* counter)
+{
+	// NOTE: Counters are taken right away, so waiting for them covers tasks which are not submitted yet
+	node->queue = queue;
+	node->callback = callback;
+	node->args = args;
+	node->counter = counter;
+	node->next = 0;
+	if (counter) {
+		AtomicAddU32(&counter->remaining, 1);
+	}
+	AtomicAddU32(&queue->pending.remaining, 1);
+	bool ready = true;
+	if (dependency) {
+		while (AtomicCompareExchange(&dependency->lock, 1, 0) != 0) { _mm_pause(); }
+		if (dependency->remaining) {
+			node->next = dependency->continuations;
+			dependency->continuations = node;
+			ready = false;
+		}
+		AtomicExchangeU32(&dependency->lock, 0);
+	}
+	if (ready) {
+		QueueSubmitTask(queue, PlatformQueueTask{ callback, args, counter });
+	}
+}
+
+internal
+bool QueueTryExecuteTask(PlatformQueue* queue) {
+	PlatformQueueTask task;
+	bool found = false;
+	u32 ownIndex = 0;
+	if (THREAD_LOCAL_QUEUE == queue) {
+		ownIndex = THREAD_LOCAL_DEQUE_INDEX;
+		found = QueueDequePop(queue->deques + ownIndex, &task);
+	}
+	while (!found) {
+		bool contended = false;
+		for (u32 offset = 1; offset <= queue->dequeCount && !found; offset++) {
+			u32 victimIndex = (ownIndex + offset) % queue->dequeCount;
+			if (THREAD_LOCAL_QUEUE == queue && victimIndex == ownIndex) {
+				continue;
+			}
+			QueueStealResult result = QueueDequeSteal(queue->deques + victimIndex, &task);
+			found = result == QueueSteal_Success;
+			contended |= result == QueueSteal_Contended;
+		}
+		if (!contended) {
+			break;
+		}
+	}
+	if (found) {
+		QueueRunTask(queue, task);
+	}
+	return found;
+}
+
+internal
+void QueueWorkerLoop(PlatformQueue* queue, u32 workerIndex) {
+	Assert(workerIndex + 1 < queue->dequeCount);
+	THREAD_LOCAL_QUEUE = queue;
+	THREAD_LOCAL_DEQUE_INDEX = workerIndex + 1;
+	while (true) {
+		if (QueueTryExecuteTask(queue)) {
+			continue;
+		}
+		AtomicAddU32(&queue->sleepingWorkers, 1);
+		if (!QueueTryExecuteTask(queue)) {
+			PlatformSemaphoreWait(&queue->semaphore);
+		}
+		AtomicAddU32(&queue->sleepingWorkers, U32_MAX);
+	}
+}
+
+internal
+void QueueWaitForCounter(PlatformQueue* queue, PlatformJobCounter* counter) {
+	TIMED_FUNCTION;
+	// NOTE: Signaling thread still holds the lock for a moment after the last decrement,
+	// counter might be gone right after this returns
+	while (counter->remaining || counter->lock) {
+		if (!QueueTryExecuteTask(queue)) {
+			_mm_pause();
+		}
+	}
+}
+
+internal
+void QueueWaitForCompletion(PlatformQueue* queue) {
+	QueueWaitForCounter(queue, &queue->pending);
+}
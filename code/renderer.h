@@ -6,7 +6,14 @@
 #ifndef APIENTRY
 #define APIENTRY
 #endif
+#if defined(_WIN32)
 #include "gl/GL.h"
+#else
+#include <GL/gl.h>
+// NOTE: mesa headers define extension names as macros, they collide with OpenGLInfo members
+#undef GL_EXT_texture_sRGB
+#undef GL_EXT_framebuffer_sRGB
+#endif
 //
 // 
 // OpenGL renderer windows specific
@@ -55,6 +62,8 @@ inline void OpenGLFreeTexture(GLuint handle);
 //
 //
 // Software renderer platform-agnostic API
+internal void InitializeSoftwareRenderer(CpuSimdLevel level);
 internal void TiledRenderGroupToBuffer(RenderCommandBuffer* commands, LoadedBitmap& dstBuffer, PlatformQueue* queue);
-internal void SortRenderCommands(RenderCommandBuffer* commands);
+internal void SortRenderCommands(RenderCommandBuffer* commands, PlatformQueue* queue = 0);
+internal void RecordRenderBatchStats(RenderCommandBuffer* commands);
 inline void ResetRenderCommands(RenderCommandBuffer* commands);
\ No newline at end of file
@@ -55,10 +55,10 @@ void OpenGLFreeTexture(GLuint handle) {
 }
 
 inline
-void OpenGLRenderRectangle(V2 min, V2 max, V4 color) {
+void OpenGLPushRectangle(V2 min, V2 max, V4 color) {
+	// NOTE: Goes between glBegin(GL_TRIANGLES) and glEnd(), so runs of rectangles share one batch
 	glColor4f(color.R, color.G, color.B, color.A);
 
-	glBegin(GL_TRIANGLES);
 	glTexCoord2f(0.f, 0.f);
 	glVertex2f(min.X, min.Y);
 	glTexCoord2f(1.f, 0.f);
@@ -72,7 +72,44 @@ void OpenGLRenderRectangle(V2 min, V2 max, V4 color) {
 	glVertex2f(min.X, max.Y);
 	glTexCoord2f(1.f, 1.f);
 	glVertex2f(max.X, max.Y);
-	glEnd();
+}
+
+struct OpenGLBatchState {
+	GLuint boundTexture;
+	bool texturing;
+	bool drawing;
+};
+
+inline
+void OpenGLEndBatch(OpenGLBatchState& state) {
+	if (state.drawing) {
+		glEnd();
+		state.drawing = false;
+	}
+}
+
+inline
+void OpenGLBeginBatch(OpenGLBatchState& state, bool texturing, GLuint texture) {
+	// NOTE: State changes only between batches, commands sorted by texture come in runs of one state
+	if (state.texturing != texturing) {
+		OpenGLEndBatch(state);
+		if (texturing) {
+			glEnable(GL_TEXTURE_2D);
+		}
+		else {
+			glDisable(GL_TEXTURE_2D);
+		}
+		state.texturing = texturing;
+	}
+	if (texturing && state.boundTexture != texture) {
+		OpenGLEndBatch(state);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		state.boundTexture = texture;
+	}
+	if (!state.drawing) {
+		glBegin(GL_TRIANGLES);
+		state.drawing = true;
+	}
 }
 
 internal
@@ -106,6 +143,9 @@ void OpenGLRenderCommandsToBuffer(RenderCommandBuffer* commands,
 
 	
 	SortElement* sortElement = ptrcast(SortElement, commands->pushBuffer + commands->sortBufferAt);
+	OpenGLBatchState batch = {};
+	batch.boundTexture = U32_MAX;
+	batch.texturing = true;
 	for (u32 sortIndex = 0; sortIndex < commands->pushBufferCount; sortIndex++, sortElement++) {
 		u8* address = commands->pushBuffer + sortElement->offset;
 		RenderCallHeader* header = ptrcast(RenderCallHeader, address);
@@ -113,6 +153,7 @@ void OpenGLRenderCommandsToBuffer(RenderCommandBuffer* commands,
 		switch (header->type) {
 		case RenderCallType_RenderCallClear: {
 			RenderCallClear* call = ptrcast(RenderCallClear, address);
+			OpenGLEndBatch(batch);
 			glClearColor(call->color.R, call->color.G, call->color.B, call->color.A);
 			glClear(GL_COLOR_BUFFER_BIT);
 		} break;
@@ -122,9 +163,8 @@ void OpenGLRenderCommandsToBuffer(RenderCommandBuffer* commands,
 			V2 xAxis = V2{ call->size.X, 0 };
 			V2 yAxis = V2{ 0, call->size.Y };
 			V2 origin = call->center - call->size / 2.f;
-			glDisable(GL_TEXTURE_2D);
-			OpenGLRenderRectangle(origin, origin + call->size, call->color);
-			glEnable(GL_TEXTURE_2D);
+			OpenGLBeginBatch(batch, false, 0);
+			OpenGLPushRectangle(origin, origin + call->size, call->color);
 		} break;
 		case RenderCallType_RenderCallBitmap: {
 			// TODO: RenderCallBitmap and RenderCallRectangle have different approaches to calculate center
@@ -136,10 +176,14 @@ void OpenGLRenderCommandsToBuffer(RenderCommandBuffer* commands,
 			V2 origin = call->center - Hadamard(call->bitmap->align, call->size);
 
 			LoadedBitmap* bitmap = call->bitmap;
-			glBindTexture(GL_TEXTURE_2D, bitmap->textureHandle);
-			OpenGLRenderRectangle(origin, origin + call->size, call->color);
+			OpenGLBeginBatch(batch, true, bitmap->textureHandle);
+			OpenGLPushRectangle(origin, origin + call->size, call->color);
 		} break;
 		InvalidDefaultCase;
 		}
 	}
+	OpenGLEndBatch(batch);
+	if (!batch.texturing) {
+		glEnable(GL_TEXTURE_2D);
+	}
 }
\ No newline at end of file
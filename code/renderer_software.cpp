@@ -1,27 +1,89 @@
 #include "renderer.h"
 #include "engine_arena.h"
+#include <string.h>
+
+// NOTE: Software renderer approximates sRGB with gamma 2. Scalar paths and the composer decode and
+// encode through these tables, the encode table is indexed by the linear value quantized to 16 bits
+#define SRGB_LINEAR_STEPS 0xFFFF
+struct SRGBTables {
+	f32 toLinear1[256];
+	u8 toSRGB255[SRGB_LINEAR_STEPS + 1];
+};
+static SRGBTables globalSRGBTables;
+
+internal
+void InitializeSRGBTables() {
+	SRGBTables& tables = globalSRGBTables;
+	f32 inv255 = 1.f / 255.f;
+	for (u32 value = 0; value < ArrayCount(tables.toLinear1); value++) {
+		tables.toLinear1[value] = Squared(inv255 * f4(value));
+	}
+	f32 invSteps = 1.f / f4(SRGB_LINEAR_STEPS);
+	for (u32 index = 0; index <= SRGB_LINEAR_STEPS; index++) {
+		tables.toSRGB255[index] = u8(255.f * SquareRoot(invSteps * f4(index)) + 0.5f);
+	}
+}
+
+inline
+u32 GetSRGBTableIndex(f32 linear) {
+	f32 scaled = linear * f4(SRGB_LINEAR_STEPS) + 0.5f;
+	return u4(Minimum(Maximum(scaled, 0.f), f4(SRGB_LINEAR_STEPS)));
+}
 
 inline
 V4 SRGB255ToLinear1(V4 input) {
+	// NOTE: Channels are 8 bit values stored as floats
+	SRGBTables& tables = globalSRGBTables;
 	V4 result = {};
-	f32 inv255 = 1.f / 255.f;
-	result.R = Squared(inv255 * input.R);
-	result.G = Squared(inv255 * input.G);
-	result.B = Squared(inv255 * input.B);
-	result.A = inv255 * input.A;
+	result.R = tables.toLinear1[u4(input.R) & 0xFF];
+	result.G = tables.toLinear1[u4(input.G) & 0xFF];
+	result.B = tables.toLinear1[u4(input.B) & 0xFF];
+	result.A = (1.f / 255.f) * input.A;
 	return result;
 }
 
 inline
-V4 Linear1ToSRGB255(V4 input) {
-	V4 result = {};
-	result.R = 255.f * SquareRoot(input.R);
-	result.G = 255.f * SquareRoot(input.G);
-	result.B = 255.f * SquareRoot(input.B);
-	result.A = 255.f * input.A;
+V4 UnpackSRGB8ToLinear1(u32 pixel) {
+	SRGBTables& tables = globalSRGBTables;
+	V4 result = {
+		tables.toLinear1[(pixel >> 16) & 0xFF],
+		tables.toLinear1[(pixel >> 8) & 0xFF],
+		tables.toLinear1[(pixel >> 0) & 0xFF],
+		(1.f / 255.f) * f4((pixel >> 24) & 0xFF)
+	};
 	return result;
 }
 
+inline
+u32 PackLinear1ToSRGB8(V4 linear) {
+	SRGBTables& tables = globalSRGBTables;
+	f32 alpha = Minimum(Maximum(255.f * linear.A, 0.f), 255.f);
+	return (u4(alpha + 0.5f) << 24) |
+		(u4(tables.toSRGB255[GetSRGBTableIndex(linear.R)]) << 16) |
+		(u4(tables.toSRGB255[GetSRGBTableIndex(linear.G)]) << 8) |
+		(u4(tables.toSRGB255[GetSRGBTableIndex(linear.B)]) << 0);
+}
+
+internal
+void DownsampleBitmap(LoadedBitmap& src, LoadedBitmap& dst) {
+	// NOTE: 2x2 box filter over premultiplied linear texels, odd last row/column of src is dropped
+	Assert(dst.width == src.width / 2 && dst.height == src.height / 2);
+	u8* dstRow = ptrcast(u8, dst.data);
+	u8* srcRow = ptrcast(u8, src.data);
+	for (i32 Y = 0; Y < dst.height; Y++) {
+		u32* dstTexel = ptrcast(u32, dstRow);
+		u32* srcTexel0 = ptrcast(u32, srcRow);
+		u32* srcTexel1 = ptrcast(u32, srcRow + src.pitch);
+		for (i32 X = 0; X < dst.width; X++) {
+			V4 sum = UnpackSRGB8ToLinear1(srcTexel0[2 * X]) + UnpackSRGB8ToLinear1(srcTexel0[2 * X + 1]) +
+				UnpackSRGB8ToLinear1(srcTexel1[2 * X]) + UnpackSRGB8ToLinear1(srcTexel1[2 * X + 1]);
+			dstTexel[X] = PackLinear1ToSRGB8(0.25f * sum);
+		}
+		dstRow += dst.pitch;
+		srcRow += 2 * src.pitch;
+	}
+}
+
 inline
 V4 Unpack4x8(u32* pixel) {
 	V4 result = { f4((*pixel >> 16) & 0xFF),
@@ -33,7 +95,7 @@ V4 Unpack4x8(u32* pixel) {
 
 inline
 V4 Sample4x8FromTexture(LoadedBitmap& texture, u32 X, u32 Y) {
-	i32 texelIndex = Y * texture.pitch + X * BITMAP_BYTES_PER_PIXEL;
+	u32 texelIndex = GetTexelOffset(texture, X, Y);
 	u32* texelPtr = ptrcast(u32, ptrcast(u8, texture.data) + texelIndex);
 	V4 result = Unpack4x8(texelPtr);
 	return result;
@@ -133,29 +195,14 @@ void RenderRectangleTransparent(LoadedBitmap& bitmap, V2 start, V2 end, V4 color
 	for (i32 Y = minY; Y < maxY; Y++) {
 		u32* dstPixel = ptrcast(u32, dstRow);
 		for (i32 X = minX; X < maxX; X++) {
-			V4 dest = {
-					f4((*dstPixel >> 16) & 0xFF),
-					f4((*dstPixel >> 8) & 0xFF),
-					f4((*dstPixel >> 0) & 0xFF),
-					f4((*dstPixel >> 24) & 0xFF)
-			};
-			f32 inv255 = 1.f / 255.f;
-			dest.R = Squared(inv255 * dest.R);
-			dest.G = Squared(inv255 * dest.G);
-			dest.B = Squared(inv255 * dest.B);
-			dest.A = inv255 * dest.A;
+			V4 dest = UnpackSRGB8ToLinear1(*dstPixel);
 			V4 output = {
 					color.R + (1 - color.A) * dest.R,
 					color.G + (1 - color.A) * dest.G,
 					color.B + (1 - color.A) * dest.B,
 					color.A + dest.A - color.A * dest.A
 			};
-
-			output = Linear1ToSRGB255(output);
-			*dstPixel = (u4(output.A + 0.5f) << 24) |
-				(u4(output.R + 0.5f) << 16) |
-				(u4(output.G + 0.5f) << 8) |
-				(u4(output.B + 0.5f) << 0);
+			*dstPixel = PackLinear1ToSRGB8(output);
 
 			dstPixel++;
 		}
@@ -226,33 +273,15 @@ void RenderBitmap(LoadedBitmap& screenBitmap, LoadedBitmap& loadedBitmap, V2 pos
 		u32* dstPixel = ptrcast(u32, dstRow);
 		u32* srcPixel = ptrcast(u32, srcRow);
 		for (i32 X = minX; X < maxX; X++) {
-			V4 dest = {
-					f4((*dstPixel >> 16) & 0xFF),
-					f4((*dstPixel >> 8) & 0xFF),
-					f4((*dstPixel >> 0) & 0xFF),
-					f4((*dstPixel >> 24) & 0xFF)
-			};
-			dest = SRGB255ToLinear1(dest);
-
-			V4 texel = {
-					f4((*srcPixel >> 16) & 0xFF),
-					f4((*srcPixel >> 8) & 0xFF),
-					f4((*srcPixel >> 0) & 0xFF),
-					f4((*srcPixel >> 24) & 0xFF)
-			};
-			texel = SRGB255ToLinear1(texel);
-
+			V4 dest = UnpackSRGB8ToLinear1(*dstPixel);
+			V4 texel = UnpackSRGB8ToLinear1(*srcPixel);
 			V4 output = {
 					texel.R + (1 - texel.A) * dest.R,
 					texel.G + (1 - texel.A) * dest.G,
 					texel.B + (1 - texel.A) * dest.B,
 					texel.A + dest.A - texel.A * dest.A
 			};
-			output = Linear1ToSRGB255(output);
-			*dstPixel = (u4(output.A + 0.5f) << 24) |
-				(u4(output.R + 0.5f) << 16) |
-				(u4(output.G + 0.5f) << 8) |
-				(u4(output.B + 0.5f) << 0);
+			*dstPixel = PackLinear1ToSRGB8(output);
 
 			dstPixel++;
 			srcPixel++;
@@ -424,20 +453,14 @@ void RenderRectangleSlowly(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxis,
 #endif
 				}
 
-				V4 dest = Unpack4x8(dstPixel);
-				dest = SRGB255ToLinear1(dest);
-
+				V4 dest = UnpackSRGB8ToLinear1(*dstPixel);
 				V4 output = {
 					texel.R + (1 - texel.A) * dest.R,
 					texel.G + (1 - texel.A) * dest.G,
 					texel.B + (1 - texel.A) * dest.B,
 					texel.A + dest.A - texel.A * dest.A
 				};
-				output = Linear1ToSRGB255(output);
-				*dstPixel = (u4(output.A + 0.5f) << 24) |
-					(u4(output.R + 0.5f) << 16) |
-					(u4(output.G + 0.5f) << 8) |
-					(u4(output.B + 0.5f) << 0);
+				*dstPixel = PackLinear1ToSRGB8(output);
 			}
 			dstPixel++;
 		}
@@ -445,10 +468,21 @@ void RenderRectangleSlowly(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxis,
 	}
 }
 
-void RenderFilledRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxis, V4 color,
-	Rect2i clipRect)
-{
-	TIMED_FUNCTION;
+// NOTE: Texel offset of both layouts is a sum of a row part and a column part, kernels compute them
+// once for Y, Y + 1, X and X + 1 of the bilinear footprint. Row-major layout has zero tile mask
+inline
+u32 GetTexelRowOffset(u32 Y, u32 pitch, u32 tileMask) {
+	return (Y & ~tileMask) * pitch + ((Y & tileMask) << 4);
+}
+
+inline
+u32 GetTexelColumnOffset(u32 X, u32 tileMask, u32 columnShift) {
+	return ((X & ~tileMask) << columnShift) + ((X & tileMask) << 2);
+}
+
+inline
+Rect2i GetRectangleFillRect(V2 origin, V2 xAxis, V2 yAxis, Rect2i clipRect) {
+	// NOTE: Bounding box of the parallelogram in pixels, clipped, not aligned to any pack width
 	V2 points[4] = {
 		origin,
 		origin + xAxis,
@@ -466,14 +500,21 @@ void RenderFilledRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V
 		if (testP.X < fminX) fminX = testP.X;
 		if (testP.X > fmaxX) fmaxX = testP.X;
 	}
-	// TODO: Allocate aligned!!!
-	clipRect = Intersection(clipRect, { 0, 0, bitmap.width, bitmap.height });
 	Rect2i fillRect = {};
 	fillRect.minY = FloorF32ToI32(fminY);
 	fillRect.maxY = CeilF32ToI32(fmaxY) + 1;
 	fillRect.minX = FloorF32ToI32(fminX);
 	fillRect.maxX = CeilF32ToI32(fmaxX) + 1;
-	fillRect = Intersection(fillRect, clipRect);
+	return Intersection(fillRect, clipRect);
+}
+
+TARGET_AVX2
+void RenderFilledRectangle_AVX2(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxis, V4 color,
+	Rect2i clipRect)
+{
+	TIMED_FUNCTION;
+	clipRect = Intersection(clipRect, { 0, 0, bitmap.width, bitmap.height });
+	Rect2i fillRect = GetRectangleFillRect(origin, xAxis, yAxis, clipRect);
 	if (!HasArea(fillRect)) {
 		return;
 	}
@@ -524,12 +565,13 @@ void RenderFilledRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V
 	i32 minX = fillRect.minX;
 	i32 maxX = fillRect.maxX;
 
-	// NOTE: Assume aligned X boundaries and proper clipping
+	// NOTE: Assume aligned X boundaries and proper clipping, last pack of the row might stick out
+	// of the bitmap width into row padding (masked out)
 	Assert(((maxX - minX) & 7) == 0);
-	Assert(maxX <= clipRect.maxX);
+	Assert(maxX <= AlignUp8(clipRect.maxX));
 	Assert(minX >= clipRect.minX);
-	Assert((minX * BITMAP_BYTES_PER_PIXEL & 31) == 0)
-		i32 packsNum = (maxX - minX) >> 3; // Divide by 8
+	Assert((minX * BITMAP_BYTES_PER_PIXEL & 31) == 0);
+	i32 packsNum = (maxX - minX) >> 3; // Divide by 8
 
 	static_assert(BITMAP_BYTES_PER_PIXEL == 4);
 	color.RGB *= color.A;
@@ -555,8 +597,7 @@ void RenderFilledRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V
 	__m256 colorR = _mm256_mul_ps(u16max, _mm256_set1_ps(color.R));
 	__m256 colorG = _mm256_mul_ps(u16max, _mm256_set1_ps(color.G));
 	__m256 colorB = _mm256_mul_ps(u16max, _mm256_set1_ps(color.B));
-	__m256 eight = _mm256_set1_ps(8.f);
-	__m256 dxBase = _mm256_set1_ps(f4(minX) - origin.X);
+	__m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
 #define E(mm, i) ptrcast(f32, &mm)[i]
 #define Ei(mm, i) ptrcast(u32, &mm)[i]
 	u32 rowAdvance = bitmap.pitch;
@@ -565,9 +606,11 @@ void RenderFilledRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V
 	for (i32 Y = minY; Y < maxY; Y++) {
 		u32* dstPixel = ptrcast(u32, row);
 		__m256 dy = _mm256_set1_ps(f4(Y) + 0.5f - origin.Y);
-		__m256 dx = _mm256_add_ps(dxBase, _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f));
-		__m256i clipMask = startupClipMask;
+		__m256i clipMask = packsNum == 1 ? _mm256_and_si256(startupClipMask, endClipMask) : startupClipMask;
 		for (i32 iter = 0; iter < packsNum; iter++) {
+			// NOTE: Pixel position is exact before subtracting the origin, so every kernel variant
+			// produces the same u, v (no accumulated error along the row)
+			__m256 dx = _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps(f4(minX + 8 * iter)), laneOffsets), originX);
 			__m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(dx, xAX), _mm256_mul_ps(dy, xAY)), uCfx8);
 			__m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(dx, yAX), _mm256_mul_ps(dy, yAY)), vCfx8);
 			__m256i writeMask = _mm256_castps_si256(
@@ -626,7 +669,6 @@ void RenderFilledRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V
 			);
 			_mm256_store_si256(ptrcast(__m256i, dstPixel), outputARGB);
 			dstPixel += 8;
-			dx = _mm256_add_ps(dx, eight);
 			if (iter == packsNum - 2) {
 				clipMask = endClipMask;
 			}
@@ -640,34 +682,13 @@ void RenderFilledRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V
 }
 
 
-void RenderRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxis, V4 color,
+TARGET_AVX2
+void RenderRectangle_AVX2(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxis, V4 color,
 	LoadedBitmap& texture, Rect2i clipRect)
 {
 	TIMED_FUNCTION;
-	V2 points[4] = {
-		origin,
-		origin + xAxis,
-		origin + yAxis,
-		origin + xAxis + yAxis
-	};
-	f32 fminY = F32_MAX;
-	f32 fmaxY = -F32_MAX;
-	f32 fminX = F32_MAX;
-	f32 fmaxX = -F32_MAX;
-	for (u32 pIndex = 0; pIndex < ArrayCount(points); pIndex++) {
-		V2 testP = points[pIndex];
-		if (testP.Y < fminY) fminY = testP.Y;
-		if (testP.Y > fmaxY) fmaxY = testP.Y;
-		if (testP.X < fminX) fminX = testP.X;
-		if (testP.X > fmaxX) fmaxX = testP.X;
-	}
 	clipRect = Intersection(clipRect, { 0, 0, bitmap.width, bitmap.height });
-	Rect2i fillRect = {};
-	fillRect.minY = FloorF32ToI32(fminY);
-	fillRect.maxY = CeilF32ToI32(fmaxY) + 1;
-	fillRect.minX = FloorF32ToI32(fminX);
-	fillRect.maxX = CeilF32ToI32(fmaxX) + 1;
-	fillRect = Intersection(fillRect, clipRect);
+	Rect2i fillRect = GetRectangleFillRect(origin, xAxis, yAxis, clipRect);
 	if (!HasArea(fillRect)) {
 		return;
 	}
@@ -718,9 +739,10 @@ void RenderRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxi
 	i32 minX = fillRect.minX;
 	i32 maxX = fillRect.maxX;
 
-	// NOTE: Assume aligned X boundaries and proper clipping
+	// NOTE: Assume aligned X boundaries and proper clipping, last pack of the row might stick out
+	// of the bitmap width into row padding (masked out)
 	Assert(((maxX - minX) & 7) == 0);
-	Assert(maxX <= clipRect.maxX);
+	Assert(maxX <= AlignUp8(clipRect.maxX));
 	Assert(minX >= clipRect.minX);
 	Assert((minX * BITMAP_BYTES_PER_PIXEL & 31) == 0);
 	i32 packsNum = (maxX - minX) >> 3; // Divide by 8
@@ -730,6 +752,8 @@ void RenderRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxi
 	f32 uCf = 1.f / (Squared(xAxis.X) + Squared(xAxis.Y));
 	f32 vCf = 1.f / (Squared(yAxis.X) + Squared(yAxis.Y));
 	u32 pitch = texture.pitch;
+	u32 tileMask = (texture.flags & LoadedBitmap_Tiled) ? BITMAP_TILE_SIZE - 1 : 0;
+	u32 tileColumnShift = (texture.flags & LoadedBitmap_Tiled) ? 4 : 2;
 	int* textureGatherBase = ptrcast(int, texture.data);
 
 	__m256i zeroTo7 = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
@@ -757,8 +781,9 @@ void RenderRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxi
 	__m256 colorG = _mm256_set1_ps(color.G);
 	__m256 colorB = _mm256_set1_ps(color.B);
 	__m256i pitchWide = _mm256_set1_epi32(pitch);
-	__m256 eight = _mm256_set1_ps(8.f);
-	__m256 dxBase = _mm256_set1_ps(f4(minX) - origin.X);
+	__m256i tileMaskWide = _mm256_set1_epi32(tileMask);
+	__m128i columnShift = _mm_cvtsi32_si128(tileColumnShift);
+	__m256 laneOffsets = _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f);
 #define E(mm, i) ptrcast(f32, &mm)[i]
 #define Ei(mm, i) ptrcast(u32, &mm)[i]
 	u32 rowAdvance = bitmap.pitch;
@@ -767,9 +792,9 @@ void RenderRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxi
 	for (i32 Y = minY; Y < maxY; Y++) {
 		u32* dstPixel = ptrcast(u32, row);
 		__m256 dy = _mm256_set1_ps(f4(Y) - origin.Y);
-		__m256 dx = _mm256_add_ps(dxBase, _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f));
-		__m256i clipMask = startupClipMask;
+		__m256i clipMask = packsNum == 1 ? _mm256_and_si256(startupClipMask, endClipMask) : startupClipMask;
 		for (i32 iter = 0; iter < packsNum; iter++) {
+			__m256 dx = _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps(f4(minX + 8 * iter)), laneOffsets), originX);
 			__m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(dx, xAX), _mm256_mul_ps(dy, xAY)), uCfx8);
 			__m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(dx, yAX), _mm256_mul_ps(dy, yAY)), vCfx8);
 			__m256i writeMask = _mm256_castps_si256(
@@ -795,15 +820,29 @@ void RenderRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxi
 			__m256 fX = _mm256_sub_ps(texelX, _mm256_cvtepi32_ps(texelXint));
 			__m256 fY = _mm256_sub_ps(texelY, _mm256_cvtepi32_ps(texelYint));
 
-			// Calculate memory indicies for gathering bilinear sample
-			__m256i mulY_Pitch = _mm256_mullo_epi32(texelYint, pitchWide);
-			__m256i sliX_2 = _mm256_slli_epi32(texelXint, 2);
-			__m256i mulY_Plus1_Pitch = _mm256_mullo_epi32(_mm256_add_epi32(texelYint, onei), pitchWide);
-			__m256i sliX_Plus1_2 = _mm256_slli_epi32(_mm256_add_epi32(texelXint, onei), 2);
-			__m256i texelAIndexes = _mm256_add_epi32(mulY_Pitch, sliX_2);
-			__m256i texelBIndexes = _mm256_add_epi32(mulY_Pitch, sliX_Plus1_2);
-			__m256i texelCIndexes = _mm256_add_epi32(mulY_Plus1_Pitch, sliX_2);
-			__m256i texelDIndexes = _mm256_add_epi32(mulY_Plus1_Pitch, sliX_Plus1_2);
+			// Calculate memory indicies for gathering bilinear sample, see GetTexelRowOffset()
+			__m256i texelYint1 = _mm256_add_epi32(texelYint, onei);
+			__m256i texelXint1 = _mm256_add_epi32(texelXint, onei);
+			__m256i rowOffset0 = _mm256_add_epi32(
+				_mm256_mullo_epi32(_mm256_andnot_si256(tileMaskWide, texelYint), pitchWide),
+				_mm256_slli_epi32(_mm256_and_si256(texelYint, tileMaskWide), 4)
+			);
+			__m256i rowOffset1 = _mm256_add_epi32(
+				_mm256_mullo_epi32(_mm256_andnot_si256(tileMaskWide, texelYint1), pitchWide),
+				_mm256_slli_epi32(_mm256_and_si256(texelYint1, tileMaskWide), 4)
+			);
+			__m256i columnOffset0 = _mm256_add_epi32(
+				_mm256_sll_epi32(_mm256_andnot_si256(tileMaskWide, texelXint), columnShift),
+				_mm256_slli_epi32(_mm256_and_si256(texelXint, tileMaskWide), 2)
+			);
+			__m256i columnOffset1 = _mm256_add_epi32(
+				_mm256_sll_epi32(_mm256_andnot_si256(tileMaskWide, texelXint1), columnShift),
+				_mm256_slli_epi32(_mm256_and_si256(texelXint1, tileMaskWide), 2)
+			);
+			__m256i texelAIndexes = _mm256_add_epi32(rowOffset0, columnOffset0);
+			__m256i texelBIndexes = _mm256_add_epi32(rowOffset0, columnOffset1);
+			__m256i texelCIndexes = _mm256_add_epi32(rowOffset1, columnOffset0);
+			__m256i texelDIndexes = _mm256_add_epi32(rowOffset1, columnOffset1);
 
 			// Gather ARGB data
 			__m256i texelA_ARGBi = _mm256_i32gather_epi32(textureGatherBase, texelAIndexes, 1);
@@ -920,7 +959,6 @@ void RenderRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxi
 			);
 			_mm256_store_si256(ptrcast(__m256i, dstPixel), outputARGB);
 			dstPixel += 8;
-			dx = _mm256_add_ps(dx, eight);
 			if (iter == packsNum - 2) {
 				clipMask = endClipMask;
 			}
@@ -934,6 +972,708 @@ void RenderRectangleOptimized(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxi
 	LLVM_MCA_END(opt_render_rect);
 }
 
+void RenderFilledRectangle_SSE2(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxis, V4 color,
+	Rect2i clipRect)
+{
+	TIMED_FUNCTION;
+	clipRect = Intersection(clipRect, { 0, 0, bitmap.width, bitmap.height });
+	Rect2i fillRect = GetRectangleFillRect(origin, xAxis, yAxis, clipRect);
+	if (!HasArea(fillRect)) {
+		return;
+	}
+	// NOTE: Packs are aligned to 4 pixels, so the last one of the row stays inside of the tile or
+	// the row padding, pixels outside of fillRect are written back unchanged
+	i32 minX = fillRect.minX & ~3;
+	i32 maxX = fillRect.maxX;
+	Assert(minX >= clipRect.minX);
+	Assert(((maxX + 3) & ~3) <= AlignUp8(clipRect.maxX));
+
+	static_assert(BITMAP_BYTES_PER_PIXEL == 4);
+	color.RGB *= color.A;
+	f32 uCf = 1.f / (Squared(xAxis.X) + Squared(xAxis.Y));
+	f32 vCf = 1.f / (Squared(yAxis.X) + Squared(yAxis.Y));
+	__m128i zeroTo3 = _mm_setr_epi32(0, 1, 2, 3);
+	__m128i clipMinX = _mm_set1_epi32(fillRect.minX - 1);
+	__m128i clipMaxX = _mm_set1_epi32(fillRect.maxX);
+	__m128 zero = _mm_set1_ps(0.f);
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 u16max = _mm_set1_ps(Squared(255.f));
+	__m128 o255 = _mm_set1_ps(255.f);
+	__m128 inv255wide = _mm_set1_ps(1.f / 255.f);
+	__m128 uCfx4 = _mm_set1_ps(uCf);
+	__m128 vCfx4 = _mm_set1_ps(vCf);
+	__m128 originX = _mm_set1_ps(origin.X);
+	__m128 xAX = _mm_set1_ps(xAxis.X);
+	__m128 xAY = _mm_set1_ps(xAxis.Y);
+	__m128 yAX = _mm_set1_ps(yAxis.X);
+	__m128 yAY = _mm_set1_ps(yAxis.Y);
+	__m128i maskFF = _mm_set1_epi32(0xFF);
+	__m128 colorA = _mm_mul_ps(o255, _mm_set1_ps(color.A));
+	__m128 colorR = _mm_mul_ps(u16max, _mm_set1_ps(color.R));
+	__m128 colorG = _mm_mul_ps(u16max, _mm_set1_ps(color.G));
+	__m128 colorB = _mm_mul_ps(u16max, _mm_set1_ps(color.B));
+	__m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	u8* row = ptrcast(u8, bitmap.data) + fillRect.minY * bitmap.pitch + minX * BITMAP_BYTES_PER_PIXEL;
+	for (i32 Y = fillRect.minY; Y < fillRect.maxY; Y++) {
+		u32* dstPixel = ptrcast(u32, row);
+		__m128 dy = _mm_set1_ps(f4(Y) + 0.5f - origin.Y);
+		for (i32 X = minX; X < maxX; X += 4) {
+			__m128 dx = _mm_sub_ps(_mm_add_ps(_mm_set1_ps(f4(X)), laneOffsets), originX);
+			__m128 u = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(dx, xAX), _mm_mul_ps(dy, xAY)), uCfx4);
+			__m128 v = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(dx, yAX), _mm_mul_ps(dy, yAY)), vCfx4);
+			__m128i laneX = _mm_add_epi32(_mm_set1_epi32(X), zeroTo3);
+			__m128i clipMask = _mm_and_si128(_mm_cmpgt_epi32(laneX, clipMinX), _mm_cmplt_epi32(laneX, clipMaxX));
+			__m128i writeMask = _mm_castps_si128(
+				_mm_and_ps(
+					_mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)),
+					_mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(v, one))
+				)
+			);
+			writeMask = _mm_and_si128(writeMask, clipMask);
+
+			__m128i dest_ARGBi = _mm_load_si128(ptrcast(__m128i, dstPixel));
+			__m128 destA = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(dest_ARGBi, 24), maskFF));
+			__m128 destR = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(dest_ARGBi, 16), maskFF));
+			__m128 destG = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(dest_ARGBi, 8), maskFF));
+			__m128 destB = _mm_cvtepi32_ps(_mm_and_si128(dest_ARGBi, maskFF));
+
+			// Dest from SRGB255 to linear255
+			destR = _mm_mul_ps(destR, destR);
+			destG = _mm_mul_ps(destG, destG);
+			destB = _mm_mul_ps(destB, destB);
+
+			// Blend output
+			__m128 invAlpha = _mm_sub_ps(one, _mm_mul_ps(inv255wide, colorA));
+			__m128 outputR = _mm_add_ps(colorR, _mm_mul_ps(invAlpha, destR));
+			__m128 outputG = _mm_add_ps(colorG, _mm_mul_ps(invAlpha, destG));
+			__m128 outputB = _mm_add_ps(colorB, _mm_mul_ps(invAlpha, destB));
+			__m128 outputA = _mm_add_ps(colorA, _mm_mul_ps(invAlpha, destA));
+
+			// Back to SRGB255
+			outputR = _mm_sqrt_ps(outputR);
+			outputG = _mm_sqrt_ps(outputG);
+			outputB = _mm_sqrt_ps(outputB);
+
+			__m128i outputARGB = _mm_cvtps_epi32(outputB);
+			outputARGB = _mm_add_epi32(outputARGB, _mm_slli_epi32(_mm_cvtps_epi32(outputG), 8));
+			outputARGB = _mm_add_epi32(outputARGB, _mm_slli_epi32(_mm_cvtps_epi32(outputR), 16));
+			outputARGB = _mm_add_epi32(outputARGB, _mm_slli_epi32(_mm_cvtps_epi32(outputA), 24));
+			outputARGB = _mm_or_si128(
+				_mm_and_si128(writeMask, outputARGB),
+				_mm_andnot_si128(writeMask, dest_ARGBi)
+			);
+			_mm_store_si128(ptrcast(__m128i, dstPixel), outputARGB);
+			dstPixel += 4;
+		}
+		row += bitmap.pitch;
+	}
+}
+
+void RenderRectangle_SSE2(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxis, V4 color,
+	LoadedBitmap& texture, Rect2i clipRect)
+{
+	TIMED_FUNCTION;
+	clipRect = Intersection(clipRect, { 0, 0, bitmap.width, bitmap.height });
+	Rect2i fillRect = GetRectangleFillRect(origin, xAxis, yAxis, clipRect);
+	if (!HasArea(fillRect)) {
+		return;
+	}
+	i32 minX = fillRect.minX & ~3;
+	i32 maxX = fillRect.maxX;
+	Assert(minX >= clipRect.minX);
+	Assert(((maxX + 3) & ~3) <= AlignUp8(clipRect.maxX));
+
+	static_assert(BITMAP_BYTES_PER_PIXEL == 4);
+	color.RGB *= color.A;
+	f32 uCf = 1.f / (Squared(xAxis.X) + Squared(xAxis.Y));
+	f32 vCf = 1.f / (Squared(yAxis.X) + Squared(yAxis.Y));
+	u32 pitch = texture.pitch;
+	u32 tileMask = (texture.flags & LoadedBitmap_Tiled) ? BITMAP_TILE_SIZE - 1 : 0;
+	u32 tileColumnShift = (texture.flags & LoadedBitmap_Tiled) ? 4 : 2;
+	u8* textureBase = ptrcast(u8, texture.data);
+
+	__m128i zeroTo3 = _mm_setr_epi32(0, 1, 2, 3);
+	__m128i clipMinX = _mm_set1_epi32(fillRect.minX - 1);
+	__m128i clipMaxX = _mm_set1_epi32(fillRect.maxX);
+	__m128 zero = _mm_set1_ps(0.f);
+	__m128 half = _mm_set1_ps(0.5f);
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 u16max = _mm_set1_ps(Squared(255.f));
+	__m128 o255 = _mm_set1_ps(255.f);
+	__m128 inv255wide = _mm_set1_ps(1.f / 255.f);
+	__m128 uCfx4 = _mm_set1_ps(uCf);
+	__m128 vCfx4 = _mm_set1_ps(vCf);
+	__m128 originX = _mm_set1_ps(origin.X);
+	__m128 xAX = _mm_set1_ps(xAxis.X);
+	__m128 xAY = _mm_set1_ps(xAxis.Y);
+	__m128 yAX = _mm_set1_ps(yAxis.X);
+	__m128 yAY = _mm_set1_ps(yAxis.Y);
+	__m128i maskFF = _mm_set1_epi32(0xFF);
+	__m128 uWcf = _mm_set1_ps(f4(texture.width - 2));
+	__m128 vHcf = _mm_set1_ps(f4(texture.height - 2));
+	__m128 colorA = _mm_set1_ps(color.A);
+	__m128 colorR = _mm_set1_ps(color.R);
+	__m128 colorG = _mm_set1_ps(color.G);
+	__m128 colorB = _mm_set1_ps(color.B);
+	__m128 laneOffsets = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+	u8* row = ptrcast(u8, bitmap.data) + fillRect.minY * bitmap.pitch + minX * BITMAP_BYTES_PER_PIXEL;
+	for (i32 Y = fillRect.minY; Y < fillRect.maxY; Y++) {
+		u32* dstPixel = ptrcast(u32, row);
+		__m128 dy = _mm_set1_ps(f4(Y) - origin.Y);
+		for (i32 X = minX; X < maxX; X += 4) {
+			__m128 dx = _mm_sub_ps(_mm_add_ps(_mm_set1_ps(f4(X)), laneOffsets), originX);
+			__m128 u = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(dx, xAX), _mm_mul_ps(dy, xAY)), uCfx4);
+			__m128 v = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(dx, yAX), _mm_mul_ps(dy, yAY)), vCfx4);
+			__m128i laneX = _mm_add_epi32(_mm_set1_epi32(X), zeroTo3);
+			__m128i clipMask = _mm_and_si128(_mm_cmpgt_epi32(laneX, clipMinX), _mm_cmplt_epi32(laneX, clipMaxX));
+			__m128i writeMask = _mm_castps_si128(
+				_mm_and_ps(
+					_mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)),
+					_mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(v, one))
+				)
+			);
+			writeMask = _mm_and_si128(writeMask, clipMask);
+			u = _mm_min_ps(one, _mm_max_ps(u, zero));
+			v = _mm_min_ps(one, _mm_max_ps(v, zero));
+
+			__m128 texelX = _mm_add_ps(_mm_mul_ps(u, uWcf), half);
+			__m128 texelY = _mm_add_ps(_mm_mul_ps(v, vHcf), half);
+			__m128i texelXint = _mm_cvttps_epi32(texelX);
+			__m128i texelYint = _mm_cvttps_epi32(texelY);
+			__m128 fX = _mm_sub_ps(texelX, _mm_cvtepi32_ps(texelXint));
+			__m128 fY = _mm_sub_ps(texelY, _mm_cvtepi32_ps(texelYint));
+
+			// NOTE: No gather and no 32 bit multiply before SSE4.1, bilinear sample is fetched per lane
+			alignas(16) i32 texelXs[4];
+			alignas(16) i32 texelYs[4];
+			alignas(16) u32 texelsA[4];
+			alignas(16) u32 texelsB[4];
+			alignas(16) u32 texelsC[4];
+			alignas(16) u32 texelsD[4];
+			_mm_store_si128(ptrcast(__m128i, texelXs), texelXint);
+			_mm_store_si128(ptrcast(__m128i, texelYs), texelYint);
+			for (u32 lane = 0; lane < 4; lane++) {
+				u32 rowOffset0 = GetTexelRowOffset(texelYs[lane], pitch, tileMask);
+				u32 rowOffset1 = GetTexelRowOffset(texelYs[lane] + 1, pitch, tileMask);
+				u32 columnOffset0 = GetTexelColumnOffset(texelXs[lane], tileMask, tileColumnShift);
+				u32 columnOffset1 = GetTexelColumnOffset(texelXs[lane] + 1, tileMask, tileColumnShift);
+				texelsA[lane] = *ptrcast(u32, textureBase + rowOffset0 + columnOffset0);
+				texelsB[lane] = *ptrcast(u32, textureBase + rowOffset0 + columnOffset1);
+				texelsC[lane] = *ptrcast(u32, textureBase + rowOffset1 + columnOffset0);
+				texelsD[lane] = *ptrcast(u32, textureBase + rowOffset1 + columnOffset1);
+			}
+			__m128i texelA_ARGBi = _mm_load_si128(ptrcast(__m128i, texelsA));
+			__m128i texelB_ARGBi = _mm_load_si128(ptrcast(__m128i, texelsB));
+			__m128i texelC_ARGBi = _mm_load_si128(ptrcast(__m128i, texelsC));
+			__m128i texelD_ARGBi = _mm_load_si128(ptrcast(__m128i, texelsD));
+			__m128i dest_ARGBi = _mm_load_si128(ptrcast(__m128i, dstPixel));
+
+			// Convert ARGB to individual channels
+			__m128 texelAA = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texelA_ARGBi, 24), maskFF));
+			__m128 texelAR = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texelA_ARGBi, 16), maskFF));
+			__m128 texelAG = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texelA_ARGBi, 8), maskFF));
+			__m128 texelAB = _mm_cvtepi32_ps(_mm_and_si128(texelA_ARGBi, maskFF));
+
+			__m128 texelBA = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texelB_ARGBi, 24), maskFF));
+			__m128 texelBR = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texelB_ARGBi, 16), maskFF));
+			__m128 texelBG = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texelB_ARGBi, 8), maskFF));
+			__m128 texelBB = _mm_cvtepi32_ps(_mm_and_si128(texelB_ARGBi, maskFF));
+
+			__m128 texelCA = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texelC_ARGBi, 24), maskFF));
+			__m128 texelCR = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texelC_ARGBi, 16), maskFF));
+			__m128 texelCG = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texelC_ARGBi, 8), maskFF));
+			__m128 texelCB = _mm_cvtepi32_ps(_mm_and_si128(texelC_ARGBi, maskFF));
+
+			__m128 texelDA = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texelD_ARGBi, 24), maskFF));
+			__m128 texelDR = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texelD_ARGBi, 16), maskFF));
+			__m128 texelDG = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texelD_ARGBi, 8), maskFF));
+			__m128 texelDB = _mm_cvtepi32_ps(_mm_and_si128(texelD_ARGBi, maskFF));
+
+			__m128 destA = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(dest_ARGBi, 24), maskFF));
+			__m128 destR = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(dest_ARGBi, 16), maskFF));
+			__m128 destG = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(dest_ARGBi, 8), maskFF));
+			__m128 destB = _mm_cvtepi32_ps(_mm_and_si128(dest_ARGBi, maskFF));
+
+			// srgb255 to linear255
+			texelAR = _mm_mul_ps(texelAR, texelAR);
+			texelAG = _mm_mul_ps(texelAG, texelAG);
+			texelAB = _mm_mul_ps(texelAB, texelAB);
+
+			texelBR = _mm_mul_ps(texelBR, texelBR);
+			texelBG = _mm_mul_ps(texelBG, texelBG);
+			texelBB = _mm_mul_ps(texelBB, texelBB);
+
+			texelCR = _mm_mul_ps(texelCR, texelCR);
+			texelCG = _mm_mul_ps(texelCG, texelCG);
+			texelCB = _mm_mul_ps(texelCB, texelCB);
+
+			texelDR = _mm_mul_ps(texelDR, texelDR);
+			texelDG = _mm_mul_ps(texelDG, texelDG);
+			texelDB = _mm_mul_ps(texelDB, texelDB);
+
+			// BILINEAR LERP
+			__m128 texelABA = _mm_add_ps(texelAA, _mm_mul_ps(fX, _mm_sub_ps(texelBA, texelAA)));
+			__m128 texelABR = _mm_add_ps(texelAR, _mm_mul_ps(fX, _mm_sub_ps(texelBR, texelAR)));
+			__m128 texelABG = _mm_add_ps(texelAG, _mm_mul_ps(fX, _mm_sub_ps(texelBG, texelAG)));
+			__m128 texelABB = _mm_add_ps(texelAB, _mm_mul_ps(fX, _mm_sub_ps(texelBB, texelAB)));
+
+			__m128 texelCDA = _mm_add_ps(texelCA, _mm_mul_ps(fX, _mm_sub_ps(texelDA, texelCA)));
+			__m128 texelCDR = _mm_add_ps(texelCR, _mm_mul_ps(fX, _mm_sub_ps(texelDR, texelCR)));
+			__m128 texelCDG = _mm_add_ps(texelCG, _mm_mul_ps(fX, _mm_sub_ps(texelDG, texelCG)));
+			__m128 texelCDB = _mm_add_ps(texelCB, _mm_mul_ps(fX, _mm_sub_ps(texelDB, texelCB)));
+
+			__m128 texelA = _mm_add_ps(texelABA, _mm_mul_ps(fY, _mm_sub_ps(texelCDA, texelABA)));
+			__m128 texelR = _mm_add_ps(texelABR, _mm_mul_ps(fY, _mm_sub_ps(texelCDR, texelABR)));
+			__m128 texelG = _mm_add_ps(texelABG, _mm_mul_ps(fY, _mm_sub_ps(texelCDG, texelABG)));
+			__m128 texelB = _mm_add_ps(texelABB, _mm_mul_ps(fY, _mm_sub_ps(texelCDB, texelABB)));
+
+			// Color modulation
+			texelA = _mm_mul_ps(texelA, colorA);
+			texelR = _mm_mul_ps(texelR, colorR);
+			texelG = _mm_mul_ps(texelG, colorG);
+			texelB = _mm_mul_ps(texelB, colorB);
+
+			// Clamp
+			texelA = _mm_min_ps(_mm_max_ps(texelA, zero), o255);
+			texelR = _mm_min_ps(_mm_max_ps(texelR, zero), u16max);
+			texelG = _mm_min_ps(_mm_max_ps(texelG, zero), u16max);
+			texelB = _mm_min_ps(_mm_max_ps(texelB, zero), u16max);
+
+			// Dest from SRGB255 to linear255
+			destR = _mm_mul_ps(destR, destR);
+			destG = _mm_mul_ps(destG, destG);
+			destB = _mm_mul_ps(destB, destB);
+
+			// Blend output
+			__m128 invAlpha = _mm_sub_ps(one, _mm_mul_ps(inv255wide, texelA));
+			__m128 outputR = _mm_add_ps(texelR, _mm_mul_ps(invAlpha, destR));
+			__m128 outputG = _mm_add_ps(texelG, _mm_mul_ps(invAlpha, destG));
+			__m128 outputB = _mm_add_ps(texelB, _mm_mul_ps(invAlpha, destB));
+			__m128 outputA = _mm_add_ps(texelA, _mm_mul_ps(invAlpha, destA));
+
+			// Back to SRGB255
+			outputR = _mm_sqrt_ps(outputR);
+			outputG = _mm_sqrt_ps(outputG);
+			outputB = _mm_sqrt_ps(outputB);
+
+			__m128i outputARGB = _mm_cvtps_epi32(outputB);
+			outputARGB = _mm_add_epi32(outputARGB, _mm_slli_epi32(_mm_cvtps_epi32(outputG), 8));
+			outputARGB = _mm_add_epi32(outputARGB, _mm_slli_epi32(_mm_cvtps_epi32(outputR), 16));
+			outputARGB = _mm_add_epi32(outputARGB, _mm_slli_epi32(_mm_cvtps_epi32(outputA), 24));
+			outputARGB = _mm_or_si128(
+				_mm_and_si128(writeMask, outputARGB),
+				_mm_andnot_si128(writeMask, dest_ARGBi)
+			);
+			_mm_store_si128(ptrcast(__m128i, dstPixel), outputARGB);
+			dstPixel += 4;
+		}
+		row += bitmap.pitch;
+	}
+}
+
+#if !COMPILER_MSVC
+// NOTE: GCC reports the undefined passthrough operand inside AVX-512 intrinsics as maybe uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+TARGET_AVX512
+void RenderFilledRectangle_AVX512(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxis, V4 color,
+	Rect2i clipRect)
+{
+	TIMED_FUNCTION;
+	clipRect = Intersection(clipRect, { 0, 0, bitmap.width, bitmap.height });
+	Rect2i fillRect = GetRectangleFillRect(origin, xAxis, yAxis, clipRect);
+	if (!HasArea(fillRect)) {
+		return;
+	}
+	// NOTE: Pixels outside of the write mask are neither loaded nor stored, so packs start right at
+	// fillRect and need no alignment
+	i32 minX = fillRect.minX;
+	i32 maxX = fillRect.maxX;
+
+	static_assert(BITMAP_BYTES_PER_PIXEL == 4);
+	color.RGB *= color.A;
+	f32 uCf = 1.f / (Squared(xAxis.X) + Squared(xAxis.Y));
+	f32 vCf = 1.f / (Squared(yAxis.X) + Squared(yAxis.Y));
+	__m512 zero = _mm512_set1_ps(0.f);
+	__m512 one = _mm512_set1_ps(1.0f);
+	__m512 u16max = _mm512_set1_ps(Squared(255.f));
+	__m512 o255 = _mm512_set1_ps(255.f);
+	__m512 inv255wide = _mm512_set1_ps(1.f / 255.f);
+	__m512 uCfx16 = _mm512_set1_ps(uCf);
+	__m512 vCfx16 = _mm512_set1_ps(vCf);
+	__m512 originX = _mm512_set1_ps(origin.X);
+	__m512 xAX = _mm512_set1_ps(xAxis.X);
+	__m512 xAY = _mm512_set1_ps(xAxis.Y);
+	__m512 yAX = _mm512_set1_ps(yAxis.X);
+	__m512 yAY = _mm512_set1_ps(yAxis.Y);
+	__m512i maskFF = _mm512_set1_epi32(0xFF);
+	__m512 colorA = _mm512_mul_ps(o255, _mm512_set1_ps(color.A));
+	__m512 colorR = _mm512_mul_ps(u16max, _mm512_set1_ps(color.R));
+	__m512 colorG = _mm512_mul_ps(u16max, _mm512_set1_ps(color.G));
+	__m512 colorB = _mm512_mul_ps(u16max, _mm512_set1_ps(color.B));
+	__m512 laneOffsets = _mm512_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f,
+		8.5f, 9.5f, 10.5f, 11.5f, 12.5f, 13.5f, 14.5f, 15.5f);
+	u8* row = ptrcast(u8, bitmap.data) + fillRect.minY * bitmap.pitch + minX * BITMAP_BYTES_PER_PIXEL;
+	for (i32 Y = fillRect.minY; Y < fillRect.maxY; Y++) {
+		u32* dstPixel = ptrcast(u32, row);
+		__m512 dy = _mm512_set1_ps(f4(Y) + 0.5f - origin.Y);
+		for (i32 X = minX; X < maxX; X += 16) {
+			__m512 dx = _mm512_sub_ps(_mm512_add_ps(_mm512_set1_ps(f4(X)), laneOffsets), originX);
+			__m512 u = _mm512_mul_ps(_mm512_add_ps(_mm512_mul_ps(dx, xAX), _mm512_mul_ps(dy, xAY)), uCfx16);
+			__m512 v = _mm512_mul_ps(_mm512_add_ps(_mm512_mul_ps(dx, yAX), _mm512_mul_ps(dy, yAY)), vCfx16);
+			i32 remaining = maxX - X;
+			__mmask16 writeMask = remaining >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << remaining) - 1);
+			writeMask = _mm512_mask_cmp_ps_mask(writeMask, u, zero, _CMP_GE_OQ);
+			writeMask = _mm512_mask_cmp_ps_mask(writeMask, u, one, _CMP_LE_OQ);
+			writeMask = _mm512_mask_cmp_ps_mask(writeMask, v, zero, _CMP_GE_OQ);
+			writeMask = _mm512_mask_cmp_ps_mask(writeMask, v, one, _CMP_LE_OQ);
+
+			__m512i dest_ARGBi = _mm512_maskz_loadu_epi32(writeMask, dstPixel);
+			__m512 destA = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(dest_ARGBi, 24), maskFF));
+			__m512 destR = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(dest_ARGBi, 16), maskFF));
+			__m512 destG = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(dest_ARGBi, 8), maskFF));
+			__m512 destB = _mm512_cvtepi32_ps(_mm512_and_si512(dest_ARGBi, maskFF));
+
+			// Dest from SRGB255 to linear255
+			destR = _mm512_mul_ps(destR, destR);
+			destG = _mm512_mul_ps(destG, destG);
+			destB = _mm512_mul_ps(destB, destB);
+
+			// Blend output
+			__m512 invAlpha = _mm512_sub_ps(one, _mm512_mul_ps(inv255wide, colorA));
+			__m512 outputR = _mm512_add_ps(colorR, _mm512_mul_ps(invAlpha, destR));
+			__m512 outputG = _mm512_add_ps(colorG, _mm512_mul_ps(invAlpha, destG));
+			__m512 outputB = _mm512_add_ps(colorB, _mm512_mul_ps(invAlpha, destB));
+			__m512 outputA = _mm512_add_ps(colorA, _mm512_mul_ps(invAlpha, destA));
+
+			// Back to SRGB255
+			outputR = _mm512_sqrt_ps(outputR);
+			outputG = _mm512_sqrt_ps(outputG);
+			outputB = _mm512_sqrt_ps(outputB);
+
+			__m512i outputARGB = _mm512_cvtps_epi32(outputB);
+			outputARGB = _mm512_add_epi32(outputARGB, _mm512_slli_epi32(_mm512_cvtps_epi32(outputG), 8));
+			outputARGB = _mm512_add_epi32(outputARGB, _mm512_slli_epi32(_mm512_cvtps_epi32(outputR), 16));
+			outputARGB = _mm512_add_epi32(outputARGB, _mm512_slli_epi32(_mm512_cvtps_epi32(outputA), 24));
+			_mm512_mask_storeu_epi32(dstPixel, writeMask, outputARGB);
+			dstPixel += 16;
+		}
+		row += bitmap.pitch;
+	}
+}
+
+TARGET_AVX512
+void RenderRectangle_AVX512(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxis, V4 color,
+	LoadedBitmap& texture, Rect2i clipRect)
+{
+	TIMED_FUNCTION;
+	clipRect = Intersection(clipRect, { 0, 0, bitmap.width, bitmap.height });
+	Rect2i fillRect = GetRectangleFillRect(origin, xAxis, yAxis, clipRect);
+	if (!HasArea(fillRect)) {
+		return;
+	}
+	i32 minX = fillRect.minX;
+	i32 maxX = fillRect.maxX;
+
+	static_assert(BITMAP_BYTES_PER_PIXEL == 4);
+	color.RGB *= color.A;
+	f32 uCf = 1.f / (Squared(xAxis.X) + Squared(xAxis.Y));
+	f32 vCf = 1.f / (Squared(yAxis.X) + Squared(yAxis.Y));
+	u32 pitch = texture.pitch;
+	u32 tileMask = (texture.flags & LoadedBitmap_Tiled) ? BITMAP_TILE_SIZE - 1 : 0;
+	u32 tileColumnShift = (texture.flags & LoadedBitmap_Tiled) ? 4 : 2;
+	int* textureGatherBase = ptrcast(int, texture.data);
+
+	__m512 zero = _mm512_set1_ps(0.f);
+	__m512 half = _mm512_set1_ps(0.5f);
+	__m512 one = _mm512_set1_ps(1.0f);
+	__m512 u16max = _mm512_set1_ps(Squared(255.f));
+	__m512 o255 = _mm512_set1_ps(255.f);
+	__m512 inv255wide = _mm512_set1_ps(1.f / 255.f);
+	__m512 uCfx16 = _mm512_set1_ps(uCf);
+	__m512 vCfx16 = _mm512_set1_ps(vCf);
+	__m512 originX = _mm512_set1_ps(origin.X);
+	__m512 xAX = _mm512_set1_ps(xAxis.X);
+	__m512 xAY = _mm512_set1_ps(xAxis.Y);
+	__m512 yAX = _mm512_set1_ps(yAxis.X);
+	__m512 yAY = _mm512_set1_ps(yAxis.Y);
+	__m512i maskFF = _mm512_set1_epi32(0xFF);
+	__m512 uWcf = _mm512_set1_ps(f4(texture.width - 2));
+	__m512 vHcf = _mm512_set1_ps(f4(texture.height - 2));
+	__m512 colorA = _mm512_set1_ps(color.A);
+	__m512 colorR = _mm512_set1_ps(color.R);
+	__m512 colorG = _mm512_set1_ps(color.G);
+	__m512 colorB = _mm512_set1_ps(color.B);
+	__m512i zeroi = _mm512_setzero_si512();
+	__m512i onei = _mm512_set1_epi32(1);
+	__m512i pitchWide = _mm512_set1_epi32(pitch);
+	__m512i tileMaskWide = _mm512_set1_epi32(tileMask);
+	__m128i columnShift = _mm_cvtsi32_si128(tileColumnShift);
+	__m512 laneOffsets = _mm512_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f,
+		8.f, 9.f, 10.f, 11.f, 12.f, 13.f, 14.f, 15.f);
+	u8* row = ptrcast(u8, bitmap.data) + fillRect.minY * bitmap.pitch + minX * BITMAP_BYTES_PER_PIXEL;
+	for (i32 Y = fillRect.minY; Y < fillRect.maxY; Y++) {
+		u32* dstPixel = ptrcast(u32, row);
+		__m512 dy = _mm512_set1_ps(f4(Y) - origin.Y);
+		for (i32 X = minX; X < maxX; X += 16) {
+			__m512 dx = _mm512_sub_ps(_mm512_add_ps(_mm512_set1_ps(f4(X)), laneOffsets), originX);
+			__m512 u = _mm512_mul_ps(_mm512_add_ps(_mm512_mul_ps(dx, xAX), _mm512_mul_ps(dy, xAY)), uCfx16);
+			__m512 v = _mm512_mul_ps(_mm512_add_ps(_mm512_mul_ps(dx, yAX), _mm512_mul_ps(dy, yAY)), vCfx16);
+			i32 remaining = maxX - X;
+			__mmask16 writeMask = remaining >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << remaining) - 1);
+			writeMask = _mm512_mask_cmp_ps_mask(writeMask, u, zero, _CMP_GE_OQ);
+			writeMask = _mm512_mask_cmp_ps_mask(writeMask, u, one, _CMP_LE_OQ);
+			writeMask = _mm512_mask_cmp_ps_mask(writeMask, v, zero, _CMP_GE_OQ);
+			writeMask = _mm512_mask_cmp_ps_mask(writeMask, v, one, _CMP_LE_OQ);
+			u = _mm512_min_ps(one, _mm512_max_ps(u, zero));
+			v = _mm512_min_ps(one, _mm512_max_ps(v, zero));
+
+			__m512 texelX = _mm512_add_ps(_mm512_mul_ps(u, uWcf), half);
+			__m512 texelY = _mm512_add_ps(_mm512_mul_ps(v, vHcf), half);
+			__m512i texelXint = _mm512_cvttps_epi32(texelX);
+			__m512i texelYint = _mm512_cvttps_epi32(texelY);
+			__m512 fX = _mm512_sub_ps(texelX, _mm512_cvtepi32_ps(texelXint));
+			__m512 fY = _mm512_sub_ps(texelY, _mm512_cvtepi32_ps(texelYint));
+
+			// Calculate memory indicies for gathering bilinear sample, lanes outside of the write mask
+			// are not fetched at all
+			__m512i texelYint1 = _mm512_add_epi32(texelYint, onei);
+			__m512i texelXint1 = _mm512_add_epi32(texelXint, onei);
+			__m512i rowOffset0 = _mm512_add_epi32(
+				_mm512_mullo_epi32(_mm512_andnot_si512(tileMaskWide, texelYint), pitchWide),
+				_mm512_slli_epi32(_mm512_and_si512(texelYint, tileMaskWide), 4)
+			);
+			__m512i rowOffset1 = _mm512_add_epi32(
+				_mm512_mullo_epi32(_mm512_andnot_si512(tileMaskWide, texelYint1), pitchWide),
+				_mm512_slli_epi32(_mm512_and_si512(texelYint1, tileMaskWide), 4)
+			);
+			__m512i columnOffset0 = _mm512_add_epi32(
+				_mm512_sll_epi32(_mm512_andnot_si512(tileMaskWide, texelXint), columnShift),
+				_mm512_slli_epi32(_mm512_and_si512(texelXint, tileMaskWide), 2)
+			);
+			__m512i columnOffset1 = _mm512_add_epi32(
+				_mm512_sll_epi32(_mm512_andnot_si512(tileMaskWide, texelXint1), columnShift),
+				_mm512_slli_epi32(_mm512_and_si512(texelXint1, tileMaskWide), 2)
+			);
+			__m512i texelAIndexes = _mm512_add_epi32(rowOffset0, columnOffset0);
+			__m512i texelBIndexes = _mm512_add_epi32(rowOffset0, columnOffset1);
+			__m512i texelCIndexes = _mm512_add_epi32(rowOffset1, columnOffset0);
+			__m512i texelDIndexes = _mm512_add_epi32(rowOffset1, columnOffset1);
+			__m512i texelA_ARGBi = _mm512_mask_i32gather_epi32(zeroi, writeMask, texelAIndexes, textureGatherBase, 1);
+			__m512i texelB_ARGBi = _mm512_mask_i32gather_epi32(zeroi, writeMask, texelBIndexes, textureGatherBase, 1);
+			__m512i texelC_ARGBi = _mm512_mask_i32gather_epi32(zeroi, writeMask, texelCIndexes, textureGatherBase, 1);
+			__m512i texelD_ARGBi = _mm512_mask_i32gather_epi32(zeroi, writeMask, texelDIndexes, textureGatherBase, 1);
+			__m512i dest_ARGBi = _mm512_maskz_loadu_epi32(writeMask, dstPixel);
+
+			// Convert ARGB to individual channels
+			__m512 texelAA = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(texelA_ARGBi, 24), maskFF));
+			__m512 texelAR = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(texelA_ARGBi, 16), maskFF));
+			__m512 texelAG = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(texelA_ARGBi, 8), maskFF));
+			__m512 texelAB = _mm512_cvtepi32_ps(_mm512_and_si512(texelA_ARGBi, maskFF));
+
+			__m512 texelBA = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(texelB_ARGBi, 24), maskFF));
+			__m512 texelBR = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(texelB_ARGBi, 16), maskFF));
+			__m512 texelBG = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(texelB_ARGBi, 8), maskFF));
+			__m512 texelBB = _mm512_cvtepi32_ps(_mm512_and_si512(texelB_ARGBi, maskFF));
+
+			__m512 texelCA = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(texelC_ARGBi, 24), maskFF));
+			__m512 texelCR = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(texelC_ARGBi, 16), maskFF));
+			__m512 texelCG = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(texelC_ARGBi, 8), maskFF));
+			__m512 texelCB = _mm512_cvtepi32_ps(_mm512_and_si512(texelC_ARGBi, maskFF));
+
+			__m512 texelDA = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(texelD_ARGBi, 24), maskFF));
+			__m512 texelDR = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(texelD_ARGBi, 16), maskFF));
+			__m512 texelDG = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(texelD_ARGBi, 8), maskFF));
+			__m512 texelDB = _mm512_cvtepi32_ps(_mm512_and_si512(texelD_ARGBi, maskFF));
+
+			__m512 destA = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(dest_ARGBi, 24), maskFF));
+			__m512 destR = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(dest_ARGBi, 16), maskFF));
+			__m512 destG = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(dest_ARGBi, 8), maskFF));
+			__m512 destB = _mm512_cvtepi32_ps(_mm512_and_si512(dest_ARGBi, maskFF));
+
+			// srgb255 to linear255
+			texelAR = _mm512_mul_ps(texelAR, texelAR);
+			texelAG = _mm512_mul_ps(texelAG, texelAG);
+			texelAB = _mm512_mul_ps(texelAB, texelAB);
+
+			texelBR = _mm512_mul_ps(texelBR, texelBR);
+			texelBG = _mm512_mul_ps(texelBG, texelBG);
+			texelBB = _mm512_mul_ps(texelBB, texelBB);
+
+			texelCR = _mm512_mul_ps(texelCR, texelCR);
+			texelCG = _mm512_mul_ps(texelCG, texelCG);
+			texelCB = _mm512_mul_ps(texelCB, texelCB);
+
+			texelDR = _mm512_mul_ps(texelDR, texelDR);
+			texelDG = _mm512_mul_ps(texelDG, texelDG);
+			texelDB = _mm512_mul_ps(texelDB, texelDB);
+
+			// BILINEAR LERP
+			__m512 texelABA = _mm512_add_ps(texelAA, _mm512_mul_ps(fX, _mm512_sub_ps(texelBA, texelAA)));
+			__m512 texelABR = _mm512_add_ps(texelAR, _mm512_mul_ps(fX, _mm512_sub_ps(texelBR, texelAR)));
+			__m512 texelABG = _mm512_add_ps(texelAG, _mm512_mul_ps(fX, _mm512_sub_ps(texelBG, texelAG)));
+			__m512 texelABB = _mm512_add_ps(texelAB, _mm512_mul_ps(fX, _mm512_sub_ps(texelBB, texelAB)));
+
+			__m512 texelCDA = _mm512_add_ps(texelCA, _mm512_mul_ps(fX, _mm512_sub_ps(texelDA, texelCA)));
+			__m512 texelCDR = _mm512_add_ps(texelCR, _mm512_mul_ps(fX, _mm512_sub_ps(texelDR, texelCR)));
+			__m512 texelCDG = _mm512_add_ps(texelCG, _mm512_mul_ps(fX, _mm512_sub_ps(texelDG, texelCG)));
+			__m512 texelCDB = _mm512_add_ps(texelCB, _mm512_mul_ps(fX, _mm512_sub_ps(texelDB, texelCB)));
+
+			__m512 texelA = _mm512_add_ps(texelABA, _mm512_mul_ps(fY, _mm512_sub_ps(texelCDA, texelABA)));
+			__m512 texelR = _mm512_add_ps(texelABR, _mm512_mul_ps(fY, _mm512_sub_ps(texelCDR, texelABR)));
+			__m512 texelG = _mm512_add_ps(texelABG, _mm512_mul_ps(fY, _mm512_sub_ps(texelCDG, texelABG)));
+			__m512 texelB = _mm512_add_ps(texelABB, _mm512_mul_ps(fY, _mm512_sub_ps(texelCDB, texelABB)));
+
+			// Color modulation
+			texelA = _mm512_mul_ps(texelA, colorA);
+			texelR = _mm512_mul_ps(texelR, colorR);
+			texelG = _mm512_mul_ps(texelG, colorG);
+			texelB = _mm512_mul_ps(texelB, colorB);
+
+			// Clamp
+			texelA = _mm512_min_ps(_mm512_max_ps(texelA, zero), o255);
+			texelR = _mm512_min_ps(_mm512_max_ps(texelR, zero), u16max);
+			texelG = _mm512_min_ps(_mm512_max_ps(texelG, zero), u16max);
+			texelB = _mm512_min_ps(_mm512_max_ps(texelB, zero), u16max);
+
+			// Dest from SRGB255 to linear255
+			destR = _mm512_mul_ps(destR, destR);
+			destG = _mm512_mul_ps(destG, destG);
+			destB = _mm512_mul_ps(destB, destB);
+
+			// Blend output
+			__m512 invAlpha = _mm512_sub_ps(one, _mm512_mul_ps(inv255wide, texelA));
+			__m512 outputR = _mm512_add_ps(texelR, _mm512_mul_ps(invAlpha, destR));
+			__m512 outputG = _mm512_add_ps(texelG, _mm512_mul_ps(invAlpha, destG));
+			__m512 outputB = _mm512_add_ps(texelB, _mm512_mul_ps(invAlpha, destB));
+			__m512 outputA = _mm512_add_ps(texelA, _mm512_mul_ps(invAlpha, destA));
+
+			// Back to SRGB255
+			outputR = _mm512_sqrt_ps(outputR);
+			outputG = _mm512_sqrt_ps(outputG);
+			outputB = _mm512_sqrt_ps(outputB);
+
+			__m512i outputARGB = _mm512_cvtps_epi32(outputB);
+			outputARGB = _mm512_add_epi32(outputARGB, _mm512_slli_epi32(_mm512_cvtps_epi32(outputG), 8));
+			outputARGB = _mm512_add_epi32(outputARGB, _mm512_slli_epi32(_mm512_cvtps_epi32(outputR), 16));
+			outputARGB = _mm512_add_epi32(outputARGB, _mm512_slli_epi32(_mm512_cvtps_epi32(outputA), 24));
+			_mm512_mask_storeu_epi32(dstPixel, writeMask, outputARGB);
+			dstPixel += 16;
+		}
+		row += bitmap.pitch;
+	}
+}
+#if !COMPILER_MSVC
+#pragma GCC diagnostic pop
+#endif
+
+inline
+bool CanBlitBitmap(RenderCallBitmap* call) {
+	// NOTE: Unscaled, unmodulated bitmaps without partial alpha come out of the blend kernel as
+	// their own texels, they are copied instead (origin snapped to the pixel grid)
+	LoadedBitmap* bitmap = call->bitmap;
+	return (bitmap->flags & LoadedBitmap_AlphaTested) && !(bitmap->flags & LoadedBitmap_Tiled) &&
+		call->color.R == 1.f && call->color.G == 1.f && call->color.B == 1.f && call->color.A == 1.f &&
+		Abs(call->size.X - f4(bitmap->width)) < 0.5f &&
+		Abs(call->size.Y - f4(bitmap->height)) < 0.5f;
+}
+
+inline
+LoadedBitmap* SelectBitmapMip(LoadedBitmap* bitmap, V2 xAxis, V2 yAxis) {
+	// NOTE: Takes the level with one to two texels per pixel along the more minified axis,
+	// bilinear filter covers the rest. Below that texels are skipped, which aliases and misses cache
+	f32 texelsPerPixel = Maximum(f4(bitmap->width) / Length(xAxis), f4(bitmap->height) / Length(yAxis));
+	u32 level = 0;
+	while (level < bitmap->mipCount && texelsPerPixel >= 2.f) {
+		texelsPerPixel *= 0.5f;
+		level++;
+	}
+	return level ? bitmap->mips + level - 1 : bitmap;
+}
+
+internal
+void RenderBitmapBlit(LoadedBitmap& bitmap, LoadedBitmap& texture, i32 originX, i32 originY, Rect2i clipRect) {
+	TIMED_FUNCTION;
+	Assert(texture.flags & LoadedBitmap_AlphaTested);
+	clipRect = Intersection(clipRect, { 0, 0, bitmap.width, bitmap.height });
+	Rect2i fillRect = Intersection({ originX, originY, originX + texture.width, originY + texture.height }, clipRect);
+	if (!HasArea(fillRect)) {
+		return;
+	}
+	i32 width = fillRect.maxX - fillRect.minX;
+	u8* srcRow = ptrcast(u8, texture.data) + (fillRect.minY - originY) * texture.pitch +
+		(fillRect.minX - originX) * BITMAP_BYTES_PER_PIXEL;
+	u8* dstRow = ptrcast(u8, bitmap.data) + fillRect.minY * bitmap.pitch + fillRect.minX * BITMAP_BYTES_PER_PIXEL;
+	if (texture.flags & LoadedBitmap_Opaque) {
+		for (i32 Y = fillRect.minY; Y < fillRect.maxY; Y++) {
+			memcpy(dstRow, srcRow, width * BITMAP_BYTES_PER_PIXEL);
+			srcRow += texture.pitch;
+			dstRow += bitmap.pitch;
+		}
+		return;
+	}
+	for (i32 Y = fillRect.minY; Y < fillRect.maxY; Y++) {
+		u32* src = ptrcast(u32, srcRow);
+		u32* dst = ptrcast(u32, dstRow);
+		i32 X = 0;
+		for (; X + 4 <= width; X += 4) {
+			// NOTE: Alpha is 0 or 255, arithmetic shift turns it into the select mask
+			__m128i srcPixels = _mm_loadu_si128(ptrcast(__m128i, src + X));
+			__m128i dstPixels = _mm_loadu_si128(ptrcast(__m128i, dst + X));
+			__m128i mask = _mm_srai_epi32(srcPixels, 24);
+			_mm_storeu_si128(ptrcast(__m128i, dst + X),
+				_mm_or_si128(_mm_and_si128(mask, srcPixels), _mm_andnot_si128(mask, dstPixels)));
+		}
+		for (; X < width; X++) {
+			if (src[X] >> 24) {
+				dst[X] = src[X];
+			}
+		}
+		srcRow += texture.pitch;
+		dstRow += bitmap.pitch;
+	}
+}
+
+typedef void (*_RenderFilledRectangle)(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxis, V4 color,
+	Rect2i clipRect);
+typedef void (*_RenderRectangle)(LoadedBitmap& bitmap, V2 origin, V2 xAxis, V2 yAxis, V4 color,
+	LoadedBitmap& texture, Rect2i clipRect);
+
+struct SoftwareRendererKernels {
+	CpuSimdLevel level;
+	_RenderFilledRectangle RenderFilledRectangle;
+	_RenderRectangle RenderRectangle;
+};
+
+// NOTE: SSE2 is always there on x64, wider kernels are picked once by InitializeSoftwareRenderer()
+static SoftwareRendererKernels globalSoftwareRendererKernels = {
+	CpuSimd_SSE2, RenderFilledRectangle_SSE2, RenderRectangle_SSE2
+};
+
+internal
+void InitializeSoftwareRenderer(CpuSimdLevel level) {
+	Assert(level <= GetCpuSimdLevel());
+	InitializeSRGBTables();
+	SoftwareRendererKernels& kernels = globalSoftwareRendererKernels;
+	kernels.level = level;
+	switch (level) {
+	case CpuSimd_SSE2: {
+		kernels.RenderFilledRectangle = RenderFilledRectangle_SSE2;
+		kernels.RenderRectangle = RenderRectangle_SSE2;
+	} break;
+	case CpuSimd_AVX2: {
+		kernels.RenderFilledRectangle = RenderFilledRectangle_AVX2;
+		kernels.RenderRectangle = RenderRectangle_AVX2;
+	} break;
+	case CpuSimd_AVX512: {
+		kernels.RenderFilledRectangle = RenderFilledRectangle_AVX512;
+		kernels.RenderRectangle = RenderRectangle_AVX512;
+	} break;
+	InvalidDefaultCase;
+	}
+}
+
 inline
 void ResetRenderCommands(RenderCommandBuffer* commands) {
 	commands->pushBufferCount = 0;
@@ -941,64 +1681,178 @@ void ResetRenderCommands(RenderCommandBuffer* commands) {
 	commands->sortBufferAt = commands->maxPushBufferSize;
 }
 
+struct SoftwareSamplerRun {
+	// NOTE: Sampling setup of the last bitmap command, commands sorted by texture come in runs which
+	// draw the same bitmap at the same size, so they share it
+	LoadedBitmap* bitmap;
+	V2 size;
+	V4 color;
+	bool blit;
+	LoadedBitmap* texture;
+};
+
+inline
+void SoftwareRenderCommand(RenderCallHeader* header, LoadedBitmap& dstBuffer, Rect2i clipRect, SoftwareSamplerRun& run) {
+	u8* address = ptrcast(u8, header) + sizeof(RenderCallHeader);
+	switch (header->type) {
+	case RenderCallType_RenderCallClear: {
+		RenderCallClear* call = ptrcast(RenderCallClear, address);
+		RenderRectangleTransparent(dstBuffer, V2{ 0, 0 }, V2i(dstBuffer.width, dstBuffer.height), call->color, clipRect);
+	} break;
+	case RenderCallType_RenderCallRectangle: {
+		RenderCallRectangle* call = ptrcast(RenderCallRectangle, address);
+#if 0
+		V2 min = call->center - call->size / 2.f;
+		V2 max = min + call->size;
+		RenderRectangleTransparent(dstBuffer, min, max, call->color, clipRect);
+#else
+		V2 xAxis = V2{ call->size.X, 0 };
+		V2 yAxis = V2{ 0, call->size.Y };
+		V2 origin = call->center - call->size / 2.f;
+		globalSoftwareRendererKernels.RenderFilledRectangle(dstBuffer, origin, xAxis, yAxis, call->color, clipRect);
+#endif
+	} break;
+	case RenderCallType_RenderCallBitmap: {
+		// TODO: RenderCallBitmap and RenderCallRectangle have different approaches to calculate center
+		// It should be unified (check groundLevel) which is different from RenderCallRectangle,
+		// also, size is properly changed in RenderCallRectangle and not in RenderCallBitmap
+		RenderCallBitmap* call = ptrcast(RenderCallBitmap, address);
+		V2 origin = call->center - Hadamard(call->bitmap->align, call->size);
+		V2 xAxis = V2{ call->size.X, 0 };
+		V2 yAxis = V2{ 0, call->size.Y };
+		if (run.bitmap != call->bitmap || run.size != call->size || run.color != call->color) {
+			run.bitmap = call->bitmap;
+			run.size = call->size;
+			run.color = call->color;
+			run.blit = CanBlitBitmap(call);
+			run.texture = run.blit ? call->bitmap : SelectBitmapMip(call->bitmap, xAxis, yAxis);
+		}
+		if (run.blit) {
+			RenderBitmapBlit(dstBuffer, *call->bitmap, RoundF32ToI32(origin.X), RoundF32ToI32(origin.Y), clipRect);
+		}
+		else {
+			globalSoftwareRendererKernels.RenderRectangle(dstBuffer, origin, xAxis, yAxis, call->color, *run.texture, clipRect);
+		}
+	} break;
+	case RenderCallType_RenderCallCoordinateSystem: {
+		RenderCallCoordinateSystem* call = ptrcast(RenderCallCoordinateSystem, address);
+		RenderRectangleSlowly(dstBuffer, call->origin, call->xAxis, call->yAxis,
+			call->color, *call->bitmap, call->normalMap, call->topEnvMap,
+			call->middleEnvMap, call->bottomEnvMap
+		);
+		V4 color = V4{ 1.f, 0.f, 0.f, 0.f };
+		V2 size = V2{ 5.f, 5.f };
+		V2 points[4]{
+			call->origin,
+			call->origin + call->xAxis,
+			call->origin + call->yAxis,
+			call->origin + call->xAxis + call->yAxis
+		};
+		RenderRectangleOpaque(dstBuffer, points[0], points[0] + size, color.RGB);
+		RenderRectangleOpaque(dstBuffer, points[1], points[1] + size, color.RGB);
+		RenderRectangleOpaque(dstBuffer, points[2], points[2] + size, color.RGB);
+		RenderRectangleOpaque(dstBuffer, points[3], points[3] + size, color.RGB);
+	} break;
+	InvalidDefaultCase;
+	}
+}
+
 internal
 void SoftwareRenderCommandsToBuffer(RenderCommandBuffer* commands, LoadedBitmap& dstBuffer, Rect2i clipRect) {
 	TIMED_FUNCTION;
 	SortElement* sortElement = ptrcast(SortElement, commands->pushBuffer + commands->sortBufferAt);
+	SoftwareSamplerRun run = {};
 	for (u32 sortIndex = 0; sortIndex < commands->pushBufferCount; sortIndex++, sortElement++) {
-		u8* address = commands->pushBuffer + sortElement->offset;
-		RenderCallHeader* header = ptrcast(RenderCallHeader, address);
-		address += sizeof(RenderCallHeader);
-		switch (header->type) {
-		case RenderCallType_RenderCallClear: {
-			RenderCallClear* call = ptrcast(RenderCallClear, address);
-			RenderRectangleTransparent(dstBuffer, V2{ 0, 0 }, V2i(dstBuffer.width, dstBuffer.height), call->color, clipRect);
-		} break;
-		case RenderCallType_RenderCallRectangle: {
-			RenderCallRectangle* call = ptrcast(RenderCallRectangle, address);
-#if 0
-			V2 min = call->center - call->size / 2.f;
-			V2 max = min + call->size;
-			RenderRectangleTransparent(dstBuffer, min, max, call->color, clipRect);
-#else
-			V2 xAxis = V2{ call->size.X, 0 };
-			V2 yAxis = V2{ 0, call->size.Y };
-			V2 origin = call->center - call->size / 2.f;
-			RenderFilledRectangleOptimized(dstBuffer, origin, xAxis, yAxis, call->color, clipRect);
-#endif
-		} break;
-		case RenderCallType_RenderCallBitmap: {
-			// TODO: RenderCallBitmap and RenderCallRectangle have different approaches to calculate center
-			// It should be unified (check groundLevel) which is different from RenderCallRectangle,
-			// also, size is properly changed in RenderCallRectangle and not in RenderCallBitmap
-			RenderCallBitmap* call = ptrcast(RenderCallBitmap, address);
-			V2 xAxis = V2{ call->size.X, 0 };
-			V2 yAxis = V2{ 0, call->size.Y };
-			V2 origin = call->center - Hadamard(call->bitmap->align, call->size);
-			RenderRectangleOptimized(dstBuffer, origin, xAxis, yAxis, call->color, *call->bitmap, clipRect);
-		} break;
-		case RenderCallType_RenderCallCoordinateSystem: {
-			RenderCallCoordinateSystem* call = ptrcast(RenderCallCoordinateSystem, address);
-			RenderRectangleSlowly(dstBuffer, call->origin, call->xAxis, call->yAxis,
-				call->color, *call->bitmap, call->normalMap, call->topEnvMap,
-				call->middleEnvMap, call->bottomEnvMap
-			);
-			V4 color = V4{ 1.f, 0.f, 0.f, 0.f };
-			V2 size = V2{ 5.f, 5.f };
-			V2 points[4]{
-				call->origin,
-				call->origin + call->xAxis,
-				call->origin + call->yAxis,
-				call->origin + call->xAxis + call->yAxis
-			};
-			RenderRectangleOpaque(dstBuffer, points[0], points[0] + size, color.RGB);
-			RenderRectangleOpaque(dstBuffer, points[1], points[1] + size, color.RGB);
-			RenderRectangleOpaque(dstBuffer, points[2], points[2] + size, color.RGB);
-			RenderRectangleOpaque(dstBuffer, points[3], points[3] + size, color.RGB);
-		} break;
-		InvalidDefaultCase;
+		RenderCallHeader* header = ptrcast(RenderCallHeader, commands->pushBuffer + sortElement->offset);
+		SoftwareRenderCommand(header, dstBuffer, clipRect, run);
+	}
+}
+
+internal
+Rect2i GetRenderCommandBounds(RenderCallHeader* header, LoadedBitmap& dstBuffer) {
+	// NOTE: Pixels which might be touched by the command, has to match what SoftwareRenderCommand() does
+	u8* address = ptrcast(u8, header) + sizeof(RenderCallHeader);
+	V2 min = {};
+	V2 max = {};
+	switch (header->type) {
+	case RenderCallType_RenderCallClear: {
+		return Rect2i{ 0, 0, dstBuffer.width, dstBuffer.height };
+	} break;
+	case RenderCallType_RenderCallRectangle: {
+		RenderCallRectangle* call = ptrcast(RenderCallRectangle, address);
+		min = call->center - call->size / 2.f;
+		max = min + call->size;
+	} break;
+	case RenderCallType_RenderCallBitmap: {
+		RenderCallBitmap* call = ptrcast(RenderCallBitmap, address);
+		min = call->center - Hadamard(call->bitmap->align, call->size);
+		max = min + call->size;
+	} break;
+	case RenderCallType_RenderCallCoordinateSystem: {
+		RenderCallCoordinateSystem* call = ptrcast(RenderCallCoordinateSystem, address);
+		V2 points[4]{
+			call->origin,
+			call->origin + call->xAxis,
+			call->origin + call->yAxis,
+			call->origin + call->xAxis + call->yAxis
+		};
+		min = points[0];
+		max = points[0];
+		for (u32 pIndex = 1; pIndex < ArrayCount(points); pIndex++) {
+			min = V2{ Minimum(min.X, points[pIndex].X), Minimum(min.Y, points[pIndex].Y) };
+			max = V2{ Maximum(max.X, points[pIndex].X), Maximum(max.Y, points[pIndex].Y) };
+		}
+		max += V2{ 5.f, 5.f }; // NOTE: Corner markers
+	} break;
+	InvalidDefaultCase;
+	}
+	Rect2i result = {};
+	result.minX = FloorF32ToI32(min.X);
+	result.minY = FloorF32ToI32(min.Y);
+	result.maxX = CeilF32ToI32(max.X) + 1;
+	result.maxY = CeilF32ToI32(max.Y) + 1;
+	return result;
+}
+
+internal
+bool GetRenderCommandOpaqueRect(RenderCallHeader* header, LoadedBitmap& dstBuffer, Rect2i* opaqueRect) {
+	// NOTE: Pixels which the command surely overwrites without reading the destination. Kernels decide
+	// pixel by pixel with their own sampling offsets, so the rect stays one pixel inside of the edges
+	u8* address = ptrcast(u8, header) + sizeof(RenderCallHeader);
+	V2 min = {};
+	V2 max = {};
+	switch (header->type) {
+	case RenderCallType_RenderCallClear: {
+		RenderCallClear* call = ptrcast(RenderCallClear, address);
+		*opaqueRect = Rect2i{ 0, 0, dstBuffer.width, dstBuffer.height };
+		return call->color.A == 1.f;
+	} break;
+	case RenderCallType_RenderCallRectangle: {
+		RenderCallRectangle* call = ptrcast(RenderCallRectangle, address);
+		if (call->color.A != 1.f) {
+			return false;
 		}
+		min = call->center - call->size / 2.f;
+		max = min + call->size;
+	} break;
+	case RenderCallType_RenderCallBitmap: {
+		RenderCallBitmap* call = ptrcast(RenderCallBitmap, address);
+		if (!(call->bitmap->flags & LoadedBitmap_Opaque) || call->color.A != 1.f) {
+			return false;
+		}
+		min = call->center - Hadamard(call->bitmap->align, call->size);
+		max = min + call->size;
+	} break;
+	case RenderCallType_RenderCallCoordinateSystem: {
+		return false;
+	} break;
+	InvalidDefaultCase;
 	}
+	opaqueRect->minX = CeilF32ToI32(min.X) + 1;
+	opaqueRect->minY = CeilF32ToI32(min.Y) + 1;
+	opaqueRect->maxX = FloorF32ToI32(max.X) - 1;
+	opaqueRect->maxY = FloorF32ToI32(max.Y) - 1;
+	return HasArea(*opaqueRect);
 }
 
 inline
@@ -1154,36 +2008,14 @@ void MergeSortWithCopying(SortElement* array, u32 count, SortElement* tempBuffer
 	return;
 }
 
-inline
-u32 FloatToRadixValue(f32 value) {
-	u32 result = *ptrcast(u32, &value);
-
-	/* NOTE:
-	   FLOAT = |Sign bit (1)|Exponent (7)|Mantissa (24)|
-	   Exponent and mantissa are monotonically increasing when float is increasing
-	   Only sign bit is problematic (is 1 when float is negative)
-	   So we set the sign bit for the positive numbers to make them higher than negatives
-	   and we negate negative numbers to unset the sign bit and keep the monotonically
-	   increasing order
-	*/
-	if (value < 0) {
-		result = ~result;
-	}
-	else {
-		result |= 0x80000000;
-	}
-	return result;
-}
-
 internal
 void RadixSort(SortElement* array, u32 count, SortElement* tempBuffer) {
 	TIMED_FUNCTION;
-	for (u32 bitOffset = 0; bitOffset < 32; bitOffset += 8) {
+	for (u32 bitOffset = 0; bitOffset < 64; bitOffset += 8) {
 		u32 bucketOffsets[256] = {};
 		for (u32 elementIndex = 0; elementIndex < count; elementIndex++) {
 			SortElement* element = array + elementIndex;
-			u32 radixValue = FloatToRadixValue(element->key);
-			u8 radixPiece = (radixValue >> bitOffset) & 0xFF;
+			u8 radixPiece = (element->key >> bitOffset) & 0xFF;
 			bucketOffsets[radixPiece]++;
 		}
 
@@ -1197,8 +2029,7 @@ void RadixSort(SortElement* array, u32 count, SortElement* tempBuffer) {
 		for (u32 elementIndex = 0; elementIndex < count; elementIndex++) {
 			SortElement* src = array + elementIndex;
 
-			u32 radixValue = FloatToRadixValue(src->key);
-			u8 radixPiece = (radixValue >> bitOffset) & 0xFF;
+			u8 radixPiece = (src->key >> bitOffset) & 0xFF;
 			u32 position = bucketOffsets[radixPiece]++;
 
 			SortElement* dest = tempBuffer + position;
@@ -1210,8 +2041,170 @@ void RadixSort(SortElement* array, u32 count, SortElement* tempBuffer) {
 	}
 }
 
+#define RADIX_SORT_MAX_TASKS 16
+// NOTE: Splitting the passes only pays off on many cores and big arrays, task count and sync overhead
+// make it slower than RadixSort below that. Frames sort far fewer commands, so they stay serial
+#define RADIX_SORT_MIN_ELEMENTS_PER_TASK 65536
+#define RADIX_SORT_DIGIT_COUNT 8
+
+enum RadixSortPhase {
+	RadixSort_Count,
+	RadixSort_Histogram,
+	RadixSort_Scatter,
+	RadixSort_CopyBack
+};
+
+struct RadixSortJob;
+struct RadixSortTaskArgs {
+	RadixSortJob* job;
+	u32 taskIndex;
+};
+
+// NOTE: Over 128KB with the counts, so it has to live on the heap, not on the stack of a worker
+struct RadixSortJob {
+	SortElement* src;
+	SortElement* dst;
+	SortElement* array;
+	u32 count;
+	u32 taskCount;
+	RadixSortPhase phase;
+	u32 digit;
+	// NOTE: Per task digit counts, turned into scatter offsets of the task before the scatter
+	u32 counts[RADIX_SORT_MAX_TASKS][RADIX_SORT_DIGIT_COUNT][256];
+	RadixSortTaskArgs tasks[RADIX_SORT_MAX_TASKS];
+	PlatformJobCounter counter;
+};
+
 internal
-void SortRenderCommands(RenderCommandBuffer* commands) {
+void RadixSortTask(void* data) {
+	RadixSortTaskArgs* args = ptrcast(RadixSortTaskArgs, data);
+	RadixSortJob* job = args->job;
+	u32 taskIndex = args->taskIndex;
+	// NOTE: Chunks are contiguous and in task order, so scattering them keeps the sort stable
+	u32 begin = u4(u64(job->count) * taskIndex / job->taskCount);
+	u32 end = u4(u64(job->count) * (taskIndex + 1) / job->taskCount);
+	u32 bitOffset = job->digit * 8;
+	switch (job->phase) {
+	case RadixSort_Count: {
+		// NOTE: All digits are counted in one read of the keys
+		u32 (*counts)[256] = job->counts[taskIndex];
+		ZeroSize_(ptrcast(u8, counts), sizeof(job->counts[taskIndex]));
+		for (u32 elementIndex = begin; elementIndex < end; elementIndex++) {
+			u64 key = job->src[elementIndex].key;
+			for (u32 digit = 0; digit < RADIX_SORT_DIGIT_COUNT; digit++) {
+				counts[digit][(key >> (digit * 8)) & 0xFF]++;
+			}
+		}
+	} break;
+	case RadixSort_Histogram: {
+		u32* counts = job->counts[taskIndex][job->digit];
+		ZeroSize_(ptrcast(u8, counts), sizeof(job->counts[taskIndex][job->digit]));
+		for (u32 elementIndex = begin; elementIndex < end; elementIndex++) {
+			counts[(job->src[elementIndex].key >> bitOffset) & 0xFF]++;
+		}
+	} break;
+	case RadixSort_Scatter: {
+		u32* offsets = job->counts[taskIndex][job->digit];
+		for (u32 elementIndex = begin; elementIndex < end; elementIndex++) {
+			SortElement* src = job->src + elementIndex;
+			job->dst[offsets[(src->key >> bitOffset) & 0xFF]++] = *src;
+		}
+	} break;
+	case RadixSort_CopyBack: {
+		for (u32 elementIndex = begin; elementIndex < end; elementIndex++) {
+			job->array[elementIndex] = job->src[elementIndex];
+		}
+	} break;
+	}
+}
+
+internal
+void RunRadixSortPhase(RadixSortJob* job, RadixSortPhase phase, PlatformQueue* queue) {
+	job->phase = phase;
+	if (job->taskCount == 1) {
+		RadixSortTask(job->tasks);
+		return;
+	}
+	// NOTE: Calling thread takes the first chunk and helps with the rest while waiting
+	for (u32 taskIndex = 1; taskIndex < job->taskCount; taskIndex++) {
+		Platform->QueuePushTask(queue, RadixSortTask, job->tasks + taskIndex, &job->counter);
+	}
+	RadixSortTask(job->tasks);
+	Platform->QueueWaitForCounter(queue, &job->counter);
+}
+
+inline
+u32 GetRadixSortTaskCount(u32 count, PlatformQueue* queue) {
+	u32 result = 1;
+	if (queue) {
+		result = Minimum(Minimum(Platform->QueueThreadCount(queue), count / RADIX_SORT_MIN_ELEMENTS_PER_TASK),
+			u4(RADIX_SORT_MAX_TASKS));
+		result = Maximum(result, 1u);
+	}
+	return result;
+}
+
+internal
+void ParallelRadixSort(RadixSortJob* jobMemory, SortElement* array, u32 count, SortElement* tempBuffer, PlatformQueue* queue) {
+	// NOTE: Same result as RadixSort, queue can be null for a single threaded run
+	TIMED_FUNCTION;
+	RadixSortJob& job = *jobMemory;
+	job.src = array;
+	job.dst = tempBuffer;
+	job.array = array;
+	job.count = count;
+	job.digit = 0;
+	job.counter = {};
+	job.taskCount = GetRadixSortTaskCount(count, queue);
+	for (u32 taskIndex = 0; taskIndex < job.taskCount; taskIndex++) {
+		job.tasks[taskIndex].job = &job;
+		job.tasks[taskIndex].taskIndex = taskIndex;
+	}
+	RunRadixSortPhase(&job, RadixSort_Count, queue);
+
+	// NOTE: Digit counts don't depend on the order, so passes over a uniform digit are skipped up front.
+	// Render keys have most of them uniform within a frame (layer, depth exponent, unused texture bits)
+	bool uniformDigits[RADIX_SORT_DIGIT_COUNT] = {};
+	for (u32 digit = 0; digit < RADIX_SORT_DIGIT_COUNT; digit++) {
+		for (u32 bucketIndex = 0; bucketIndex < 256 && !uniformDigits[digit]; bucketIndex++) {
+			u32 bucketCount = 0;
+			for (u32 taskIndex = 0; taskIndex < job.taskCount; taskIndex++) {
+				bucketCount += job.counts[taskIndex][digit][bucketIndex];
+			}
+			uniformDigits[digit] = bucketCount == count;
+		}
+	}
+	// NOTE: Histograms of the count phase are valid until the first scatter changes the order
+	bool countsAreFresh = true;
+	for (u32 digit = 0; digit < RADIX_SORT_DIGIT_COUNT; digit++) {
+		if (uniformDigits[digit]) {
+			continue;
+		}
+		job.digit = digit;
+		if (!countsAreFresh) {
+			RunRadixSortPhase(&job, RadixSort_Histogram, queue);
+		}
+		u32 total = 0;
+		for (u32 bucketIndex = 0; bucketIndex < 256; bucketIndex++) {
+			for (u32 taskIndex = 0; taskIndex < job.taskCount; taskIndex++) {
+				u32 taskBucketCount = job.counts[taskIndex][digit][bucketIndex];
+				job.counts[taskIndex][digit][bucketIndex] = total;
+				total += taskBucketCount;
+			}
+		}
+		RunRadixSortPhase(&job, RadixSort_Scatter, queue);
+		SortElement* swapper = job.src;
+		job.src = job.dst;
+		job.dst = swapper;
+		countsAreFresh = false;
+	}
+	if (job.src != array) {
+		RunRadixSortPhase(&job, RadixSort_CopyBack, queue);
+	}
+}
+
+internal
+void SortRenderCommands(RenderCommandBuffer* commands, PlatformQueue* queue) {
 	TIMED_FUNCTION;
 	SortElement* array = ptrcast(SortElement, commands->pushBuffer + commands->sortBufferAt);
 	u32 count = commands->pushBufferCount;
@@ -1241,7 +2234,15 @@ void SortRenderCommands(RenderCommandBuffer* commands) {
 	//BubbleSort(array, count);
 	//MergeSort(array, count, tempBuffer);
 	//MergeSortWithCopying(array, count, tempBuffer);
-	RadixSort(array, count, tempBuffer);
+	if (GetRadixSortTaskCount(count, queue) > 1) {
+		if (!commands->sortJob) {
+			commands->sortJob = ptrcast(RadixSortJob, Platform->MemoryAllocate(sizeof(RadixSortJob)));
+		}
+		ParallelRadixSort(commands->sortJob, array, count, tempBuffer, queue);
+	}
+	else {
+		RadixSort(array, count, tempBuffer);
+	}
 #if SLOW_VALIDATION
 	for (u32 sortIndex = 0; sortIndex < count - 1; sortIndex++) {
 		SortElement* A = array + sortIndex;
@@ -1259,63 +2260,498 @@ void SoftwareRenderCommandsToBuffer(RenderCommandBuffer* commands, LoadedBitmap&
 	SoftwareRenderCommandsToBuffer(commands, dstBuffer, clipRect);
 }
 
-struct RenderTiledArgs {
-	Rect2i clipRect;
+struct RenderTileBin {
+	// NOTE: Push buffer offsets of the commands touching the tile, in sorted order
+	u32* offsets;
+	u32 count;
+};
+
+struct RenderTileStats {
+	// NOTE: In packs of 8 pixels of one row, overdraw of the tile is shadedPacks / packs of the tile
+	u32 shadedPacks;
+	u32 occludedPacks;
+};
+
+enum TiledRenderFlags {
+	TiledRender_SortCommands = 0x1,
+	TiledRender_SkipBinning = 0x2, // NOTE: Every tile walks all of the commands, for measurements
+	TiledRender_SkipOcclusion = 0x4, // NOTE: Bins are drawn back to front only, for measurements
+};
+
+// NOTE: Tiles are handed out to the tasks one by one from nextTile, so there are a few tiles per
+// thread to even out tiles with a lot of work
+#define RENDER_TILES_PER_THREAD 4
+#define RENDER_MIN_TILE_WIDTH 32
+#define RENDER_MIN_TILE_HEIGHT 16
+#define RENDER_MAX_TILE_COUNT 1024
+#define RENDER_MAX_TILE_TASKS 64
+struct TiledRenderJob {
 	RenderCommandBuffer* commands;
-	LoadedBitmap* dstBuffer;
+	PlatformQueue* queue;
+	LoadedBitmap dstBuffer;
+	u32 tileWidth;
+	u32 tileHeight;
+	u32 tileCountX;
+	u32 tileCountY;
+	u32 taskCount;
+	bool binned;
+	bool occlusion;
+	u32* coverage;
+	u32 coveragePitch;
+	volatile u32 nextTile;
+	volatile u32 tilesDone;
+	PlatformJobCounter sortCounter;
+	PlatformJobCounter tilesCounter;
+	RenderTileBin bins[RENDER_MAX_TILE_COUNT];
+	RenderTileStats tileStats[RENDER_MAX_TILE_COUNT];
+	PlatformJobNode taskNodes[RENDER_MAX_TILE_TASKS];
+};
+
+inline
+Rect2i GetTileClipRect(TiledRenderJob* job, u32 tileIndex) {
+	u32 tileX = tileIndex % job->tileCountX;
+	u32 tileY = tileIndex / job->tileCountX;
+	Rect2i result = {};
+	result.minX = tileX * job->tileWidth;
+	result.minY = tileY * job->tileHeight;
+	result.maxX = Minimum(result.minX + i4(job->tileWidth), job->dstBuffer.width);
+	result.maxY = Minimum(result.minY + i4(job->tileHeight), job->dstBuffer.height);
+	return result;
+}
+
+inline
+bool GetRenderCommandTiles(TiledRenderJob* job, RenderCallHeader* header, Rect2i* tiles) {
+	Rect2i screenRect = { 0, 0, job->dstBuffer.width, job->dstBuffer.height };
+	Rect2i bounds = Intersection(GetRenderCommandBounds(header, job->dstBuffer), screenRect);
+	if (!HasArea(bounds)) {
+		return false;
+	}
+	tiles->minX = u4(bounds.minX) / job->tileWidth;
+	tiles->minY = u4(bounds.minY) / job->tileHeight;
+	tiles->maxX = u4(bounds.maxX - 1) / job->tileWidth + 1;
+	tiles->maxY = u4(bounds.maxY - 1) / job->tileHeight + 1;
+	return true;
+}
+
+internal
+void BinRenderCommands(TiledRenderJob* job) {
+	TIMED_FUNCTION;
+	RenderCommandBuffer* commands = job->commands;
+	u32 tileCount = job->tileCountX * job->tileCountY;
+	for (u32 tileIndex = 0; tileIndex < tileCount; tileIndex++) {
+		job->bins[tileIndex].count = 0;
+	}
+
+	// NOTE: First pass counts commands per tile, so bins can be packed in one buffer
+	u32 totalCount = 0;
+	SortElement* sortElements = ptrcast(SortElement, commands->pushBuffer + commands->sortBufferAt);
+	for (u32 sortIndex = 0; sortIndex < commands->pushBufferCount; sortIndex++) {
+		RenderCallHeader* header = ptrcast(RenderCallHeader, commands->pushBuffer + sortElements[sortIndex].offset);
+		Rect2i tiles;
+		if (!GetRenderCommandTiles(job, header, &tiles)) {
+			continue;
+		}
+		for (i32 tileY = tiles.minY; tileY < tiles.maxY; tileY++) {
+			for (i32 tileX = tiles.minX; tileX < tiles.maxX; tileX++) {
+				job->bins[tileY * job->tileCountX + tileX].count++;
+			}
+		}
+		totalCount += (tiles.maxX - tiles.minX) * (tiles.maxY - tiles.minY);
+	}
+	if (totalCount > commands->tileBinBufferCount) {
+		if (commands->tileBinBuffer) {
+			Platform->MemoryFree(commands->tileBinBuffer);
+		}
+		commands->tileBinBufferCount = totalCount + totalCount / 2;
+		commands->tileBinBuffer = ptrcast(u32, Platform->MemoryAllocate(sizeof(u32) * commands->tileBinBufferCount));
+	}
+	if (job->occlusion) {
+		u32 coverageCount = job->coveragePitch * job->dstBuffer.height;
+		if (coverageCount > commands->coverageBufferCount) {
+			if (commands->coverageBuffer) {
+				Platform->MemoryFree(commands->coverageBuffer);
+			}
+			commands->coverageBufferCount = coverageCount;
+			commands->coverageBuffer = ptrcast(u32, Platform->MemoryAllocate(sizeof(u32) * coverageCount));
+		}
+		job->coverage = commands->coverageBuffer;
+	}
+	u32* binAt = commands->tileBinBuffer;
+	for (u32 tileIndex = 0; tileIndex < tileCount; tileIndex++) {
+		RenderTileBin* bin = job->bins + tileIndex;
+		bin->offsets = binAt;
+		binAt += bin->count;
+		bin->count = 0;
+	}
+
+	for (u32 sortIndex = 0; sortIndex < commands->pushBufferCount; sortIndex++) {
+		u32 offset = sortElements[sortIndex].offset;
+		RenderCallHeader* header = ptrcast(RenderCallHeader, commands->pushBuffer + offset);
+		Rect2i tiles;
+		if (!GetRenderCommandTiles(job, header, &tiles)) {
+			continue;
+		}
+		for (i32 tileY = tiles.minY; tileY < tiles.maxY; tileY++) {
+			for (i32 tileX = tiles.minX; tileX < tiles.maxX; tileX++) {
+				RenderTileBin* bin = job->bins + tileY * job->tileCountX + tileX;
+				bin->offsets[bin->count++] = offset;
+			}
+		}
+	}
+}
+
+inline
+void RenderTileRect(TiledRenderJob* job, RenderCallHeader* header, Rect2i packRect, Rect2i clipRect,
+	SoftwareSamplerRun& run)
+{
+	Rect2i rect = { packRect.minX * 8, packRect.minY, packRect.maxX * 8, packRect.maxY };
+	SoftwareRenderCommand(header, job->dstBuffer, Intersection(rect, clipRect), run);
+}
+
+internal
+void RenderTilePacks(TiledRenderJob* job, RenderCallHeader* header, u32 coverIndex, Rect2i packRect,
+	Rect2i clipRect, bool opaquePass, SoftwareSamplerRun& run, RenderTileStats& stats)
+{
+	// NOTE: packRect is in packs along X and in rows along Y. Opaque pass shades packs nobody in front
+	// of the command covers and claims them, translucent pass shades packs covered by something behind
+	// it. Every run of packs goes to the kernel as a clip rect, rows with the same single run are merged
+	u32 coverLimit = opaquePass ? 1 : coverIndex;
+	u32* coverageRow = job->coverage + packRect.minY * job->coveragePitch;
+	Rect2i pending = {};
+	for (i32 Y = packRect.minY; Y < packRect.maxY; Y++, coverageRow += job->coveragePitch) {
+		u32 runCount = 0;
+		Rect2i firstRun = {};
+		i32 packX = packRect.minX;
+		while (packX < packRect.maxX) {
+			u32 cover = coverageRow[packX];
+			if (cover >= coverLimit) {
+				stats.occludedPacks += cover > coverIndex;
+				packX++;
+				continue;
+			}
+			Rect2i rowRun = { packX, Y, packX, Y + 1 };
+			for (; packX < packRect.maxX && coverageRow[packX] < coverLimit; packX++) {
+				if (opaquePass) {
+					coverageRow[packX] = coverIndex;
+				}
+			}
+			rowRun.maxX = packX;
+			stats.shadedPacks += rowRun.maxX - rowRun.minX;
+			if (runCount == 0) {
+				firstRun = rowRun;
+			}
+			else {
+				if (runCount == 1) {
+					RenderTileRect(job, header, firstRun, clipRect, run);
+				}
+				RenderTileRect(job, header, rowRun, clipRect, run);
+			}
+			runCount++;
+		}
+		if (runCount != 1) {
+			continue;
+		}
+		if (HasArea(pending) && pending.minX == firstRun.minX && pending.maxX == firstRun.maxX && pending.maxY == Y) {
+			pending.maxY++;
+		}
+		else {
+			if (HasArea(pending)) {
+				RenderTileRect(job, header, pending, clipRect, run);
+			}
+			pending = firstRun;
+		}
+	}
+	if (HasArea(pending)) {
+		RenderTileRect(job, header, pending, clipRect, run);
+	}
+}
+
+internal
+void RenderTileBackToFront(TiledRenderJob* job, u32 tileIndex, Rect2i clipRect, SoftwareSamplerRun& run) {
+	RenderTileBin* bin = job->bins + tileIndex;
+	for (u32 index = 0; index < bin->count; index++) {
+		RenderCallHeader* header = ptrcast(RenderCallHeader, job->commands->pushBuffer + bin->offsets[index]);
+		SoftwareRenderCommand(header, job->dstBuffer, clipRect, run);
+	}
+}
+
+internal
+void RenderTileFrontToBack(TiledRenderJob* job, u32 tileIndex, Rect2i clipRect, SoftwareSamplerRun& run) {
+	// NOTE: Pack fully covered by opaque commands only shows the front-most of them and whatever is in
+	// front of it, so the rest of the commands skip it. Result is the same as drawing back to front
+	TIMED_FUNCTION;
+	RenderTileBin* bin = job->bins + tileIndex;
+	RenderTileStats& stats = job->tileStats[tileIndex];
+	stats = {};
+
+	// NOTE: Coordinate systems don't clip to the packs they are given, so whatever is behind them can't
+	// skip anything. Tiles with one are drawn back to front as a whole
+	bool hasCoordinateSystem = false;
+	for (u32 index = 0; index < bin->count; index++) {
+		RenderCallHeader* header = ptrcast(RenderCallHeader, job->commands->pushBuffer + bin->offsets[index]);
+		if (header->type == RenderCallType_RenderCallCoordinateSystem) {
+			hasCoordinateSystem = true;
+			break;
+		}
+	}
+	if (hasCoordinateSystem) {
+		for (u32 index = 0; index < bin->count; index++) {
+			RenderCallHeader* header = ptrcast(RenderCallHeader, job->commands->pushBuffer + bin->offsets[index]);
+			Rect2i bounds = Intersection(GetRenderCommandBounds(header, job->dstBuffer), clipRect);
+			if (HasArea(bounds)) {
+				stats.shadedPacks += u4(((bounds.maxX + 7) / 8 - bounds.minX / 8) * (bounds.maxY - bounds.minY));
+			}
+		}
+		RenderTileBackToFront(job, tileIndex, clipRect, run);
+		return;
+	}
+
+	i32 packMinX = clipRect.minX / 8;
+	i32 packMaxX = (clipRect.maxX + 7) / 8;
+	for (i32 Y = clipRect.minY; Y < clipRect.maxY; Y++) {
+		u32* coverageRow = job->coverage + Y * job->coveragePitch;
+		for (i32 packX = packMinX; packX < packMaxX; packX++) {
+			coverageRow[packX] = 0;
+		}
+	}
+
+	// NOTE: Commands are numbered from 1 in the bin order, 0 means not covered
+	u32 frontCoverIndex = 0;
+	for (u32 index = bin->count; index > 0; index--) {
+		RenderCallHeader* header = ptrcast(RenderCallHeader, job->commands->pushBuffer + bin->offsets[index - 1]);
+		Rect2i opaqueRect;
+		if (!GetRenderCommandOpaqueRect(header, job->dstBuffer, &opaqueRect)) {
+			continue;
+		}
+		opaqueRect = Intersection(opaqueRect, clipRect);
+		if (!HasArea(opaqueRect)) {
+			continue;
+		}
+		Rect2i packRect = { (opaqueRect.minX + 7) / 8, opaqueRect.minY, opaqueRect.maxX / 8, opaqueRect.maxY };
+		if (HasArea(packRect)) {
+			RenderTilePacks(job, header, index, packRect, clipRect, true, run, stats);
+			frontCoverIndex = Maximum(frontCoverIndex, index);
+		}
+	}
+
+	// NOTE: Translucent commands and edges of the opaque ones, back to front
+	for (u32 index = 1; index <= bin->count; index++) {
+		RenderCallHeader* header = ptrcast(RenderCallHeader, job->commands->pushBuffer + bin->offsets[index - 1]);
+		Rect2i bounds = Intersection(GetRenderCommandBounds(header, job->dstBuffer), clipRect);
+		if (!HasArea(bounds)) {
+			continue;
+		}
+		Rect2i packRect = { bounds.minX / 8, bounds.minY, (bounds.maxX + 7) / 8, bounds.maxY };
+		if (index > frontCoverIndex) {
+			// NOTE: In front of every opaque command, nothing to skip
+			stats.shadedPacks += u4((packRect.maxX - packRect.minX) * (packRect.maxY - packRect.minY));
+			SoftwareRenderCommand(header, job->dstBuffer, clipRect, run);
+			continue;
+		}
+		RenderTilePacks(job, header, index, packRect, clipRect, false, run, stats);
+	}
+}
+
+#if INTERNAL_BUILD
+// NOTE: Debug GUIDs have to be static strings, so every row block has its own set. Rows past the
+// table are added up in its last block
+struct TileRowStatsGUIDs {
+	const char* block;
+	const char* overdraw;
+	const char* worstTileOverdraw;
+	const char* shadedPacks;
+	const char* occludedPacks;
 };
+#define TILE_ROW_STATS_GUIDS(row) { DEBUG_NAME("Row " #row), DEBUG_NAME("overdraw"), \
+	DEBUG_NAME("worstTileOverdraw"), DEBUG_NAME("shadedPacks"), DEBUG_NAME("occludedPacks") }
+static TileRowStatsGUIDs globalTileRowStatsGUIDs[] = {
+	TILE_ROW_STATS_GUIDS(0), TILE_ROW_STATS_GUIDS(1), TILE_ROW_STATS_GUIDS(2), TILE_ROW_STATS_GUIDS(3),
+	TILE_ROW_STATS_GUIDS(4), TILE_ROW_STATS_GUIDS(5), TILE_ROW_STATS_GUIDS(6), TILE_ROW_STATS_GUIDS(7),
+	TILE_ROW_STATS_GUIDS(8), TILE_ROW_STATS_GUIDS(9), TILE_ROW_STATS_GUIDS(10), TILE_ROW_STATS_GUIDS(11),
+	TILE_ROW_STATS_GUIDS(12), TILE_ROW_STATS_GUIDS(13), TILE_ROW_STATS_GUIDS(14), TILE_ROW_STATS_GUIDS(15),
+};
+#endif
+
+internal
+void RecordTiledRenderStats(TiledRenderJob* job) {
+#if INTERNAL_BUILD
+	u32 tileCount = job->tileCountX * job->tileCountY;
+	u32 shadedPacks = 0;
+	u32 occludedPacks = 0;
+	u32 totalPacks = 0;
+	u32 worstTile = 0;
+	f32 worstTileOverdraw = 0.f;
+	RenderTileStats rowStats[ArrayCount(globalTileRowStatsGUIDs)] = {};
+	u32 rowPacks[ArrayCount(globalTileRowStatsGUIDs)] = {};
+	f32 rowWorstTileOverdraw[ArrayCount(globalTileRowStatsGUIDs)] = {};
+	for (u32 tileIndex = 0; tileIndex < tileCount; tileIndex++) {
+		Rect2i clipRect = GetTileClipRect(job, tileIndex);
+		RenderTileStats& stats = job->tileStats[tileIndex];
+		u32 tilePacks = u4((clipRect.maxX - clipRect.minX + 7) / 8 * (clipRect.maxY - clipRect.minY));
+		f32 tileOverdraw = f4(stats.shadedPacks) / f4(Maximum(1u, tilePacks));
+		if (tileOverdraw > worstTileOverdraw) {
+			worstTileOverdraw = tileOverdraw;
+			worstTile = tileIndex;
+		}
+		shadedPacks += stats.shadedPacks;
+		occludedPacks += stats.occludedPacks;
+		totalPacks += tilePacks;
+
+		u32 row = Minimum(tileIndex / job->tileCountX, u4(ArrayCount(globalTileRowStatsGUIDs) - 1));
+		rowStats[row].shadedPacks += stats.shadedPacks;
+		rowStats[row].occludedPacks += stats.occludedPacks;
+		rowPacks[row] += tilePacks;
+		rowWorstTileOverdraw[row] = Maximum(rowWorstTileOverdraw[row], tileOverdraw);
+	}
+	f32 overdraw = f4(shadedPacks) / f4(Maximum(1u, totalPacks));
+	DEBUG_DATA_BLOCK("Overdraw");
+	DEBUG_DATA(overdraw);
+	DEBUG_DATA(worstTileOverdraw);
+	DEBUG_DATA(worstTile);
+	DEBUG_DATA(shadedPacks);
+	DEBUG_DATA(occludedPacks);
+
+	u32 rowCount = Minimum(job->tileCountY, u4(ArrayCount(globalTileRowStatsGUIDs)));
+	for (u32 row = 0; row < rowCount; row++) {
+		TileRowStatsGUIDs* GUIDs = globalTileRowStatsGUIDs + row;
+		f32 rowOverdraw = f4(rowStats[row].shadedPacks) / f4(Maximum(1u, rowPacks[row]));
+		DEBUG_BEGIN_DATA_BLOCK(GUIDs->block);
+		DEBUG_DATA_(rowOverdraw, GUIDs->overdraw);
+		DEBUG_DATA_(rowWorstTileOverdraw[row], GUIDs->worstTileOverdraw);
+		DEBUG_DATA_(rowStats[row].shadedPacks, GUIDs->shadedPacks);
+		DEBUG_DATA_(rowStats[row].occludedPacks, GUIDs->occludedPacks);
+		DEBUG_END_DATA_BLOCK;
+	}
+#endif
+}
 
 internal
 void RenderTiled(void* data) {
 	TIMED_FUNCTION;
-	RenderTiledArgs* args = ptrcast(RenderTiledArgs, data);
-	SoftwareRenderCommandsToBuffer(args->commands, *args->dstBuffer, args->clipRect);
+	TiledRenderJob* job = ptrcast(TiledRenderJob, data);
+	u32 tileCount = job->tileCountX * job->tileCountY;
+	SoftwareSamplerRun run = {};
+	while (true) {
+		u32 tileIndex = AtomicAddU32(&job->nextTile, 1);
+		if (tileIndex >= tileCount) {
+			break;
+		}
+		Rect2i clipRect = GetTileClipRect(job, tileIndex);
+		if (!job->binned) {
+			SoftwareRenderCommandsToBuffer(job->commands, job->dstBuffer, clipRect);
+			continue;
+		}
+		if (job->occlusion) {
+			RenderTileFrontToBack(job, tileIndex, clipRect, run);
+			if (AtomicAddU32(&job->tilesDone, 1) + 1 == tileCount) {
+				RecordTiledRenderStats(job);
+			}
+			continue;
+		}
+		RenderTileBackToFront(job, tileIndex, clipRect, run);
+	}
+}
+
+inline
+u32 CountRenderStateSwitches(SortElement* array, u32 count, u64 stateMask) {
+	// NOTE: Binds a batching backend does for sorted commands, every change of the masked key bits is one
+	u32 result = 0;
+	for (u32 sortIndex = 1; sortIndex < count; sortIndex++) {
+		result += ((array[sortIndex - 1].key ^ array[sortIndex].key) & stateMask) != 0;
+	}
+	return result;
+}
+
+internal
+void RecordRenderBatchStats(RenderCommandBuffer* commands) {
+#if INTERNAL_BUILD
+	SortElement* array = ptrcast(SortElement, commands->pushBuffer + commands->sortBufferAt);
+	u32 count = commands->pushBufferCount;
+	u32 textureSwitches = CountRenderStateSwitches(array, count, u64(RENDER_SORT_TEXTURE_MASK) << RENDER_SORT_TEXTURE_SHIFT);
+	u32 stateSwitches = CountRenderStateSwitches(array, count, (u64(1) << RENDER_SORT_DEPTH_SHIFT) - 1);
+	DEBUG_DATA_BLOCK("Batching");
+	DEBUG_DATA(count);
+	DEBUG_DATA(textureSwitches);
+	DEBUG_DATA(stateSwitches);
+#endif
 }
 
 internal
-void TiledRenderGroupToBuffer(RenderCommandBuffer* commands, LoadedBitmap& dstBuffer, PlatformQueue* queue) {
+void SortRenderCommandsTask(void* data) {
+	TiledRenderJob* job = ptrcast(TiledRenderJob, data);
+	SortRenderCommands(job->commands, job->queue);
+	RecordRenderBatchStats(job->commands);
+	if (job->binned) {
+		BinRenderCommands(job);
+	}
+}
+
+internal
+void BeginTiledRenderGroupToBuffer(TiledRenderJob* job, RenderCommandBuffer* commands, LoadedBitmap& dstBuffer,
+	PlatformQueue* queue, u32 flags)
+{
+	// NOTE: Only schedules the work, job->tilesCounter drops to zero when the buffer is ready.
+	// Job, commands and dstBuffer pixels must stay untouched until then
 	TIMED_FUNCTION;
-	constexpr u32 tileCountX = 4;
-	constexpr u32 tileCountY = 4;
-	RenderTiledArgs workArgs[tileCountX * tileCountY] = {};
-	u32 tileWidth = AlignUp8(RoundF32ToU32(f4(dstBuffer.width) / tileCountX));
-	u32 tileHeight = dstBuffer.height / tileCountY;
-
-	// NOTE: Until buffer is overallocated and I can easly write outside the boundaries of the
-	// buffer, there is a need for some assumptions to make multithreaded tile rendering work:
-	// 1. Tile width MUST be divisible by 8 (for AVX2 wide instructions)
-	// 2. Buffer width MUST be divisible by tile width! (if not, last in row, the smallest buffer width
-	// MUST be divisible by 8)
-	// That means no bizzare resolutions and number of tiles in X. If these constrains are not met,
-	// there is no chance to safely render the tiles, because overdrawing beyond the tile boundaries
-	// might cause data race where 2 neighbour threads reads the same pixels, but in one of them they
-	// are masked and in the second they are actually overriden. Even when masking is provided, there is
-	// no guarrantee that between reading these pixels and writing them back, neighbour thread didn't
-	// change these pixels to something else. If so, masked override will actually change the pixels
-	// which shouldn't happened!
+	// NOTE: Wide routines read and write whole 8 pixel packs (masked), so tiles are split on pack
+	// boundaries and nobody else touches pixels of the pack. Rows have to be padded to full packs,
+	// then partial right/bottom tiles are just smaller clip rects.
 	Assert((reinterpret_cast<uptr>(dstBuffer.data) & 31) == 0);
-	Assert((tileWidth & 7) == 0);
-	Assert(((dstBuffer.width % tileWidth) & 7) == 0);
-	// NOTE: These are sanity checks, too many tiles on too small resolutions will cause stupid things like
-	// tasks with zero pixels to draw :)
-	Assert(tileWidth * tileCountX < dstBuffer.width + tileWidth);
-	Assert(tileHeight * tileCountY < dstBuffer.height + tileHeight);
-
-	for (u32 tileY = 0; tileY < tileCountY; tileY++) {
-		for (u32 tileX = 0; tileX < tileCountX; tileX++) {
-			RenderTiledArgs* args = workArgs + tileY * tileCountY + tileX;
-			args->clipRect.minY = tileY * tileHeight;
-			args->clipRect.maxY = args->clipRect.minY + tileHeight;
-			args->clipRect.minX = tileX * tileWidth;
-			args->clipRect.maxX = args->clipRect.minX + tileWidth;
-			args->dstBuffer = &dstBuffer;
-			args->commands = commands;
+	Assert(dstBuffer.pitch >= AlignUp8(dstBuffer.width) * BITMAP_BYTES_PER_PIXEL);
+	Assert((dstBuffer.pitch & 31) == 0);
+	job->commands = commands;
+	job->queue = queue;
+	job->dstBuffer = dstBuffer;
+	job->binned = !(flags & TiledRender_SkipBinning);
+	job->occlusion = job->binned && !(flags & TiledRender_SkipOcclusion);
+	job->coveragePitch = AlignUp8(dstBuffer.width) / 8;
+	job->nextTile = 0;
+	job->tilesDone = 0;
+
+	// NOTE: Roughly square tiles, RENDER_TILES_PER_THREAD of them for every thread of the queue
+	u32 threadCount = Platform->QueueThreadCount(queue);
+	u32 targetTileCount = Minimum(threadCount * RENDER_TILES_PER_THREAD, RENDER_MAX_TILE_COUNT / 4);
+	f32 tileArea = f4(dstBuffer.width) * f4(dstBuffer.height) / f4(Maximum(1u, targetTileCount));
+	u32 tileWidth = AlignUp8(Maximum(RENDER_MIN_TILE_WIDTH, RoundF32ToU32(SquareRoot(tileArea))));
+	u32 tileHeight = Maximum(RENDER_MIN_TILE_HEIGHT, RoundF32ToU32(tileArea / f4(tileWidth)));
+	u32 tileCountX = Maximum(1u, (u4(dstBuffer.width) + tileWidth - 1) / tileWidth);
+	u32 tileCountY = Maximum(1u, (u4(dstBuffer.height) + tileHeight - 1) / tileHeight);
+	while (tileCountX * tileCountY > RENDER_MAX_TILE_COUNT) {
+		tileHeight *= 2;
+		tileCountY = (u4(dstBuffer.height) + tileHeight - 1) / tileHeight;
+	}
+	job->tileWidth = tileWidth;
+	job->tileHeight = tileHeight;
+	job->tileCountX = tileCountX;
+	job->tileCountY = tileCountY;
+	job->taskCount = Minimum(Minimum(threadCount, tileCountX * tileCountY), RENDER_MAX_TILE_TASKS);
+
+	// NOTE: Binning needs sorted commands, so it runs in the same task as sorting
+	PlatformJobCounter* dependency = 0;
+	if (flags & TiledRender_SortCommands) {
+		Platform->QueuePushTask(queue, SortRenderCommandsTask, job, &job->sortCounter);
+		dependency = &job->sortCounter;
+	}
+	else if (job->binned) {
+		BinRenderCommands(job);
+	}
+	for (u32 taskIndex = 0; taskIndex < job->taskCount; taskIndex++) {
 #if 1 // Switch on = multithreaded rendering
-			Platform->QueuePushTask(queue, RenderTiled, args);
+		Platform->QueuePushTaskAfter(queue, dependency, job->taskNodes + taskIndex, RenderTiled, job, &job->tilesCounter);
 #else
-			RenderTiled(args);
-#endif
+		if (dependency) {
+			Platform->QueueWaitForCounter(queue, dependency);
 		}
+		RenderTiled(job);
+#endif
 	}
-	Platform->QueueWaitForCompletion(queue);
+}
+
+internal
+void TiledRenderGroupToBuffer(RenderCommandBuffer* commands, LoadedBitmap& dstBuffer, PlatformQueue* queue, u32 flags = 0) {
+	// NOTE: Commands must be already sorted
+	TIMED_FUNCTION;
+	TiledRenderJob job = {};
+	BeginTiledRenderGroupToBuffer(&job, commands, dstBuffer, queue, flags & ~TiledRender_SortCommands);
+	Platform->QueueWaitForCounter(queue, &job.tilesCounter);
 }
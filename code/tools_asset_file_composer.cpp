@@ -99,19 +99,14 @@ LoadedBitmap LoadBmpFile(const char* filename, V2 bottomUpAlignRatio = V2{ 0.5f,
 	u32* pixels = ptrcast(u32, result.data);
 	for (u32 Y = 0; Y < header->height; Y++) {
 		for (u32 X = 0; X < header->width; X++) {
-			V4 texel = {
-				f4((*pixels >> redShift) & 0xFF),
-				f4((*pixels >> greenShift) & 0xFF),
-				f4((*pixels >> blueShift) & 0xFF),
-				f4((*pixels >> alphaShift) & 0xFF),
-			};
-			texel = SRGB255ToLinear1(texel);
+			// NOTE: Channels are moved to ARGB first so the renderer tables can decode them
+			u32 argb = (((*pixels >> alphaShift) & 0xFF) << 24) |
+				(((*pixels >> redShift) & 0xFF) << 16) |
+				(((*pixels >> greenShift) & 0xFF) << 8) |
+				(((*pixels >> blueShift) & 0xFF) << 0);
+			V4 texel = UnpackSRGB8ToLinear1(argb);
 			texel.RGB *= texel.A;
-			texel = Linear1ToSRGB255(texel);
-			*pixels++ = (u4(texel.A + 0.5f) << 24) +
-				(u4(texel.R + 0.5f) << 16) +
-				(u4(texel.G + 0.5f) << 8) +
-				(u4(texel.B + 0.5f) << 0);
+			*pixels++ = PackLinear1ToSRGB8(texel);
 		}
 	}
 
@@ -249,7 +244,8 @@ SoundId AddSoundAsset(Assets& assets, AssetTypeID id, const char* filename, u32
 	asset->memory->sound = LoadWAV(filename, firstSampleIndex, chunkSampleCount);
 	AssetFileSoundInfo* info = &assets.metadatas[asset->metadataId]._soundInfo;
 	info->chain = { SoundChain::None, 0 };
-	info->nChannels = asset->memory->sound.nChannels;
+	info->nChannels = u16(asset->memory->sound.nChannels);
+	info->payloadFilter = AssetPayloadFilter_None;
 	info->sampleCount = asset->memory->sound.sampleCount;
 	return { asset->metadataId };
 }
@@ -375,16 +371,9 @@ void AddGlyphAsset(Assets& assets, LoadedFont& font, Win32FontInfo& fontInfo, u3
 			srcPixel = ptrcast(u32, srcRow);
 			for (u32 X = minX; X < maxX; X++) {
 				u8 alpha = *(ptrcast(u8, srcPixel));
-				V4 texel = {
-					f4(255), f4(255), f4(255), f4(alpha),
-				};
-				texel = SRGB255ToLinear1(texel);
+				V4 texel = UnpackSRGB8ToLinear1((u32(alpha) << 24) | 0xFFFFFF);
 				texel.RGB *= texel.A;
-				texel = Linear1ToSRGB255(texel);
-				*dstRow++ = (u4(texel.A + 0.5f) << 24) +
-					(u4(texel.R + 0.5f) << 16) +
-					(u4(texel.G + 0.5f) << 8) +
-					(u4(texel.B + 0.5f) << 0);
+				*dstRow++ = PackLinear1ToSRGB8(texel);
 				srcPixel++;
 			}
 			srcRow += srcPitch;
@@ -530,7 +519,32 @@ Assets InitializeAssets() {
 	return assets;
 }
 
-void WriteAssetsToFile(Assets& assets, const char* filename) {
+u32 WriteAssetPayload(FILE* file, u8* payload, u32 size, bool compress, u8* filteredPayload = 0) {
+	// NOTE: Payload is stored raw unless compression is asked for and saves at least an eighth of it,
+	// returns compressed size or 0 for raw payload. Filtered payload is what gets compressed when it is
+	// given, raw payload is always stored unfiltered so it can be used in place
+	if (!compress) {
+		fwrite(payload, size, 1, file);
+		return 0;
+	}
+	local_persist u32 hashTable[LZ_HASH_TABLE_COUNT];
+	u32 capacity = GetLZCompressBound(size);
+	u8* compressed = ptrcast(u8, malloc(capacity));
+	u32 compressedSize = LZCompress(filteredPayload ? filteredPayload : payload, size, compressed, capacity, hashTable);
+	if (compressedSize && compressedSize <= size - size / 8) {
+		fwrite(compressed, compressedSize, 1, file);
+	}
+	else {
+		fwrite(payload, size, 1, file);
+		compressedSize = 0;
+	}
+	free(compressed);
+	return compressedSize;
+}
+
+// NOTE: Compression is opt-in per pack. Decompressing is several times slower than reading a raw
+// payload from the page cache (see linux_main --bench lz), it only pays off on slow media
+void WriteAssetsToFile(Assets& assets, const char* filename, bool compress) {
 	FILE* file;
 	fopen_s(&file, filename, "wb");
 	if (!file) {
@@ -547,45 +561,80 @@ void WriteAssetsToFile(Assets& assets, const char* filename) {
 	fwrite(&header, sizeof(AssetFileHeader), 1, file);
 	fwrite(assets.features, sizeof(AssetFeatures), assets.assetCount, file);
 	fwrite(&assets.groups, sizeof(AssetGroup), Asset_Count, file);
-	fseek(file, u4(header.assetsOffset), SEEK_SET);
+	_fseeki64(file, header.assetsOffset, SEEK_SET);
 	for (u32 assetGroupIndex = 0; assetGroupIndex < ArrayCount(assets.groups); assetGroupIndex++) {
 		AssetGroup* group = assets.groups + assetGroupIndex;
 		for (u32 assetIndex = group->firstAssetIndex; assetIndex < group->onePastLastAssetIndex; assetIndex++) {
 			Asset* asset = GetAsset(assets, assetIndex);
 			AssetMetadata* metadata = GetAssetMetadata(assets, asset->metadataId);
 			if (group->type == AssetGroup_Bitmap) {
-				u32 size = asset->memory->bitmap.pitch * asset->memory->bitmap.height;
-				u32 dataPosition = ftell(file);
-				fwrite(asset->memory->bitmap.data, size, 1, file);
-				metadata->_bitmapInfo.dataOffset = dataPosition;
+				LoadedBitmap* bitmap = &asset->memory->bitmap;
+				u32 size = bitmap->pitch * bitmap->height;
+				// NOTE: Mip levels follow level 0 in order, each one filtered from the previous one
+				u32 mipCount = bitmap->data ? GetBitmapMipCount(bitmap->width, bitmap->height) : 0;
+				u32 payloadSize = size + GetBitmapMipChainSize(bitmap->width, bitmap->height, mipCount);
+				u8* payload = ptrcast(u8, malloc(payloadSize));
+				CopySize(bitmap->data, payload, size);
+				u8* mipData = payload + size;
+				LoadedBitmap prevLevel = *bitmap;
+				for (u32 level = 1; level <= mipCount; level++) {
+					LoadedBitmap mip = {};
+					mip.width = prevLevel.width / 2;
+					mip.height = prevLevel.height / 2;
+					mip.pitch = mip.width * BITMAP_BYTES_PER_PIXEL;
+					mip.data = ptrcast(u32, mipData);
+					DownsampleBitmap(prevLevel, mip);
+					mipData += mip.pitch * mip.height;
+					prevLevel = mip;
+				}
+				metadata->_bitmapInfo.dataOffset = _ftelli64(file);
+				metadata->_bitmapInfo.compressedSize = WriteAssetPayload(file, payload, payloadSize, compress);
+				metadata->_bitmapInfo.mipCount = mipCount;
+				free(payload);
 			}
 			else if (group->type == AssetGroup_Sound) {
-				u32 samplesPosition0 = ftell(file);
+				// NOTE: Channels are stored one after another, loader reads them in one go
 				u32 count = asset->memory->sound.sampleCount + SOUND_CHUNK_SAMPLE_OVERLAP;
-				fwrite(asset->memory->sound.samples[0], sizeof(f32), count, file);
-				u32 samplesPosition1 = ftell(file);
-				fwrite(asset->memory->sound.samples[1], sizeof(f32), count, file);
-				metadata->_soundInfo.samplesOffset[0] = samplesPosition0;
-				metadata->_soundInfo.samplesOffset[1] = samplesPosition1;
+				u32 channelSize = count * sizeof(f32);
+				u32 nChannels = metadata->_soundInfo.nChannels;
+				u8* payload = ptrcast(u8, malloc(channelSize * nChannels));
+				for (u32 channel = 0; channel < nChannels; channel++) {
+					CopySize(asset->memory->sound.samples[channel], payload + channel * channelSize, channelSize);
+				}
+				// NOTE: Samples come from 16 bit wav files, their LZ compressed floats don't save an eighth
+				// without the shuffle
+				u8* shuffled = 0;
+				if (compress) {
+					shuffled = ptrcast(u8, malloc(channelSize * nChannels));
+					ShuffleLZBytes(payload, shuffled, channelSize * nChannels);
+				}
+				u64 samplesPosition = _ftelli64(file);
+				metadata->_soundInfo.compressedSize = WriteAssetPayload(file, payload, channelSize * nChannels, compress, shuffled);
+				metadata->_soundInfo.payloadFilter = u16(metadata->_soundInfo.compressedSize ? AssetPayloadFilter_Shuffle4 : AssetPayloadFilter_None);
+				metadata->_soundInfo.samplesOffset[0] = samplesPosition;
+				metadata->_soundInfo.samplesOffset[1] = samplesPosition + channelSize;
+				free(shuffled);
+				free(payload);
 			}
 			else if (group->type == AssetGroup_Font) {
-				u32 codePointCount = metadata->_fontInfo.onePastMaxCodepoint;
-				u32 dataPosition = ftell(file);
-				fwrite(asset->memory->font.codepointToLogicalIndex, sizeof(u16), codePointCount, file);
-
+				u32 codePointSize = metadata->_fontInfo.onePastMaxCodepoint * sizeof(u16);
 				u32 kerningCount = metadata->_fontInfo.onePastMaxLogicalIndex * metadata->_fontInfo.onePastMaxLogicalIndex;
-				//u32 dataPosition = ftell(file);
-				fwrite(asset->memory->font.kerningTable, sizeof(asset->memory->font.kerningTable[0]), kerningCount, file);
-				metadata->_fontInfo.dataOffset = dataPosition;
+				u32 kerningSize = kerningCount * sizeof(asset->memory->font.kerningTable[0]);
+				u8* payload = ptrcast(u8, malloc(codePointSize + kerningSize));
+				CopySize(asset->memory->font.codepointToLogicalIndex, payload, codePointSize);
+				CopySize(asset->memory->font.kerningTable, payload + codePointSize, kerningSize);
+				metadata->_fontInfo.dataOffset = _ftelli64(file);
+				metadata->_fontInfo.compressedSize = WriteAssetPayload(file, payload, codePointSize + kerningSize, compress);
+				free(payload);
 			}
 		}
 	}
-	fseek(file, u4(header.assetMetadatasOffset), SEEK_SET);
+	_fseeki64(file, header.assetMetadatasOffset, SEEK_SET);
 	fwrite(assets.metadatas, sizeof(AssetMetadata), assets.assetCount, file);
 	fclose(file);
 }
 
-void WriteSounds() {
+void WriteSounds(bool compress) {
 	Assets assets = InitializeAssets();
 	u32 silksongSampleCount = 7762944;
 	u32 chunkSampleCount = 4 * 48000;
@@ -604,10 +653,10 @@ void WriteSounds() {
 		firstSampleIndex += chunkSampleCount;
 	}
 	AddSoundAsset(assets, Asset_Bloop, "sound/bloop2.wav");
-	WriteAssetsToFile(assets, "sounds.assf");
+	WriteAssetsToFile(assets, "sounds.assf", compress);
 }
 
-void WriteBitmaps() {
+void WriteBitmaps(bool compress) {
 	Assets assets = InitializeAssets();
 	AddBmpAsset(assets, Asset_Tree, "test/tree.bmp", V2{ 0.5f, 0.25f });
 	AddFeature(assets, Feature_Height, 1.f);
@@ -630,7 +679,7 @@ void WriteBitmaps() {
 	AddBmpAsset(assets, Asset_Player, "test/hero-down.bmp", playerBitmapsAlignment);
 	AddFeature(assets, Feature_FacingDirection, 0.75f * TAU);
 
-	WriteAssetsToFile(assets, "bitmaps.assf");
+	WriteAssetsToFile(assets, "bitmaps.assf", compress);
 }
 
 struct AddedFontHandle {
@@ -675,7 +724,7 @@ AddedFontHandle BeginFontAddingWithStandardGlyphs(Assets& assets, const char* fo
 	return result;
 }
 
-void WriteFonts() {
+void WriteFonts(bool compress) {
 	// NOTE: All assets within a group must be added next to each other in memory,
 	// so when adding multiple fonts, we need firstly to add all the glyphs for all the fonts we
 	// plan to add and after that, all the font handlers
@@ -687,12 +736,33 @@ void WriteFonts() {
 	EndFontAdding(assets, arial);
 	
 	
-	WriteAssetsToFile(assets, "fonts.assf");
+	WriteAssetsToFile(assets, "fonts.assf", compress);
 }
 
-int main() {
-	WriteSounds();
-	WriteBitmaps();
-	WriteFonts();
+int main(int argc, char** argv) {
+	// NOTE: Packs are written raw, --compress-<pack> LZ compresses one for distribution on slow media
+	bool compressSounds = false;
+	bool compressBitmaps = false;
+	bool compressFonts = false;
+	for (int argIndex = 1; argIndex < argc; argIndex++) {
+		const char* arg = argv[argIndex];
+		if (strcmp(arg, "--compress-sounds") == 0) {
+			compressSounds = true;
+		}
+		else if (strcmp(arg, "--compress-bitmaps") == 0) {
+			compressBitmaps = true;
+		}
+		else if (strcmp(arg, "--compress-fonts") == 0) {
+			compressFonts = true;
+		}
+		else {
+			printf("Unknown option: %s (available: --compress-sounds, --compress-bitmaps, --compress-fonts)\n", arg);
+			return 1;
+		}
+	}
+	InitializeSRGBTables();
+	WriteSounds(compressSounds);
+	WriteBitmaps(compressBitmaps);
+	WriteFonts(compressFonts);
 	return 0;
 }
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include <comdef.h>
 #include <sys/stat.h>
 #include <gl/GL.h>
+#include <stdlib.h>
+#include <string.h>
 
 PlatformAPI* Platform;
 
@@ -99,6 +101,12 @@ struct Win32State {
 	i32 bltOffsetY;
 	u32 displayWidth;
 	u32 displayHeight;
+	u32 assetMemorySize;
+	u32 assetMemoryMaxSize;
+	f32 assetSoftWatermark;
+	f32 assetHardWatermark;
+	AssetReplacementPolicy assetReplacementPolicy;
+	bool assetMapFiles;
 
 	char exeFilePath[MY_MAX_PATH];
 	char exeDirectory[MY_MAX_PATH];
@@ -113,19 +121,21 @@ struct ScreenDimension {
 	int height;
 };
 
-struct PlatformQueueTask {
-	PlatformQueueCallback callback;
-	void* args;
+struct PlatformSemaphore {
+	HANDLE handle;
 };
 
-struct PlatformQueue {
-	volatile u32 writeIndex;
-	volatile u32 readIndex;
-	volatile u32 tasksTarget;
-	volatile u32 tasksDone;
-	PlatformQueueTask tasks[256];
-	HANDLE semaphore;
-};
+inline
+void PlatformSemaphoreSignal(PlatformSemaphore* semaphore) {
+	ReleaseSemaphore(semaphore->handle, 1, 0);
+}
+
+inline
+void PlatformSemaphoreWait(PlatformSemaphore* semaphore) {
+	WaitForSingleObjectEx(semaphore->handle, INFINITE, FALSE);
+}
+
+#include "platform_queue.cpp"
 
 static bool globalRunning;
 static BitmapData globalBitmap;
@@ -311,11 +321,10 @@ bool Win32LoadGameCode(Win32GameCode& gameCode) {
 	return success;
 }
 
-internal void Win32WaitForQueueCompletion(PlatformQueue* queue);
 internal
 void Win32UnloadGameCode(Win32GameCode& gameCode) {
-	Win32WaitForQueueCompletion(&globalHighPriorityQueue);
-	Win32WaitForQueueCompletion(&globalLowPriorityQueue);
+	QueueWaitForCompletion(&globalHighPriorityQueue);
+	QueueWaitForCompletion(&globalLowPriorityQueue);
 	if (gameCode.dll) {
 		Assert(FreeLibrary(gameCode.dll));
 		gameCode.dll = nullptr;
@@ -499,29 +508,9 @@ void Win32InitAudioClient(f32 targetFrameRefreshSeconds) {
 }
 
 
-internal
-bool Win32TryPopAndExecuteTaskFromQueue(PlatformQueue* queue) {
-	bool workDone = false;
-	u32 visibleReadIndex = queue->readIndex;
-	if (visibleReadIndex != queue->writeIndex) {
-		u32 nextReadIndex = (visibleReadIndex + 1) % ArrayCount(queue->tasks);
-		u32 actualReadIndex = InterlockedCompareExchange(
-			ptrcast(volatile LONG, &queue->readIndex),
-			nextReadIndex,
-			visibleReadIndex
-		);
-		if (visibleReadIndex == actualReadIndex) {
-			PlatformQueueTask* task = queue->tasks + visibleReadIndex;
-			task->callback(task->args);
-			InterlockedIncrement(ptrcast(volatile LONG, &queue->tasksDone));
-		}
-		workDone = true;
-	}
-	return workDone;
-}
-
 struct ThreadProcArgs {
 	PlatformQueue* queue;
+	u32 workerIndex;
 	HDC glDc;
 	HGLRC glContext;
 };
@@ -538,12 +527,7 @@ DWORD Win32ThreadProc(LPVOID params) {
 		i32 breakHere = 0;
 		//TODO logs
 	}
-	while (true) {
-		if (!Win32TryPopAndExecuteTaskFromQueue(queue)) {
-			WaitForSingleObjectEx(queue->semaphore, INFINITE, FALSE);
-		}
-
-	}
+	QueueWorkerLoop(queue, args->workerIndex);
 	return 0;
 }
 
@@ -559,45 +543,45 @@ u32 Win32GetCurrentThreadId() {
 
 
 internal
-bool Win32WorkInQueueIsDone(PlatformQueue* queue) {
-	return queue->tasksDone == queue->tasksTarget;
+void InitializeQueue(ThreadProcArgs* threadArgs, DWORD threadCount) {
+	Assert(threadCount);
+	PlatformQueue* queue = threadArgs->queue;
+	QueueInitialize(queue, threadCount);
+	queue->semaphore.handle = CreateSemaphoreExA(0, 0, threadCount, 0, 0, EVENT_ALL_ACCESS);
+	for (u32 threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+		threadArgs[threadIndex].workerIndex = threadIndex;
+		CreateThread(0, 0, Win32ThreadProc, threadArgs + threadIndex, 0, 0);
+	}
 }
 
 internal
-bool Win32PushTask(PlatformQueue* queue, PlatformQueueCallback callback, void* args) {
-	u32 taskIndex = queue->writeIndex;
-	PlatformQueueTask* existingTask = queue->tasks + taskIndex;
-	PlatformQueueTask* newTask = queue->tasks + taskIndex;
-	newTask->callback = callback;
-	newTask->args = args;
-	_WriteBarrier();
-	queue->writeIndex = (taskIndex + 1) % ArrayCount(queue->tasks);
-	queue->tasksTarget = queue->tasksTarget + 1;
-	ReleaseSemaphore(queue->semaphore, 1, 0);
-	return true;
+void* Win32AllocateMemory(u32 bytes) {
+	void* result = VirtualAlloc(0, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	return result;
 }
 
 internal
-void Win32WaitForQueueCompletion(PlatformQueue* queue) {
-	TIMED_FUNCTION;
-	while (!Win32WorkInQueueIsDone(queue)) {
-		Win32TryPopAndExecuteTaskFromQueue(queue);
-	};
+void* Win32ReserveMemory(u64 bytes) {
+	void* result = VirtualAlloc(0, bytes, MEM_RESERVE, PAGE_NOACCESS);
+	return result;
 }
 
 internal
-void InitializeQueue(ThreadProcArgs* threadArgs, DWORD threadCount) {
-	Assert(threadCount);
-	for (u32 threadIndex = 0; threadIndex < threadCount; threadIndex++) {
-		CreateThread(0, 0, Win32ThreadProc, threadArgs + threadIndex, 0, 0);
-	}
-	threadArgs->queue->semaphore = CreateSemaphoreExA(0, 0, threadCount, 0, 0, EVENT_ALL_ACCESS);
+bool Win32CommitMemory(void* memory, u64 bytes) {
+	void* result = VirtualAlloc(memory, bytes, MEM_COMMIT, PAGE_READWRITE);
+	return result != 0;
 }
 
 internal
-void* Win32AllocateMemory(u32 bytes) {
-	void* result = VirtualAlloc(0, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
-	return result;
+void Win32AdviseMemory(void* memory, u64 bytes, PlatformMemoryAdvice advice) {
+	if (advice == PlatformMemoryAdvice_WillNeed) {
+		WIN32_MEMORY_RANGE_ENTRY range = { memory, bytes };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	}
+	else {
+		// NOTE: Unlocking pages which aren't locked drops them from the working set
+		VirtualUnlock(memory, bytes);
+	}
 }
 
 internal
@@ -627,6 +611,10 @@ struct Win32FileHandle {
 	PlatformFileHandle base;
 	HANDLE handle;
 	DWORD errCode;
+	HANDLE mapping;
+	void* mapped;
+	// NOTE: Overlapped handle bound to the completion port, opened on the first async read
+	HANDLE asyncHandle;
 };
 
 internal
@@ -642,7 +630,9 @@ PlatformFileHandle* Win32FileOpen(const char* filename) {
 		file->errCode = GetLastError();
 		return 0;
 	}
-	file->base.size = GetFileSize(file->handle, 0);
+	LARGE_INTEGER fileSize = {};
+	GetFileSizeEx(file->handle, &fileSize);
+	file->base.size = u64(fileSize.QuadPart);
 
 	PlatformFileHandle* result = ptrcast(PlatformFileHandle, file);
 	return result;
@@ -654,6 +644,15 @@ void Win32FileClose(PlatformFileHandle* handle) {
 		return;
 	}
 	Win32FileHandle* file = ptrcast(Win32FileHandle, handle);
+	if (file->mapped) {
+		UnmapViewOfFile(file->mapped);
+	}
+	if (file->mapping) {
+		CloseHandle(file->mapping);
+	}
+	if (file->asyncHandle) {
+		CloseHandle(file->asyncHandle);
+	}
 	if (file->handle) {
 		CloseHandle(file->handle);
 	}
@@ -725,24 +724,142 @@ bool Win32FileErrors(PlatformFileHandle* handle) {
 }
 
 internal
-void Win32FileRead(PlatformFileHandle* handle, u32 offset, u32 size, void* dst) {
+void Win32FileRead(PlatformFileHandle* handle, u64 offset, u64 size, void* dst) {
 	Win32FileHandle* file = ptrcast(Win32FileHandle, handle);
 	if (!file || file->handle == INVALID_HANDLE_VALUE) {
 		return;
 	}
-	// TODO: Change FILE API to support 64bit offsets and sizes
-	Assert(offset < I32_MAX);
-	LONG low = scast(LONG, offset);
+	// NOTE: ReadFile takes 32 bit sizes, bigger reads are split
+	u8* at = ptrcast(u8, dst);
+	while (size) {
+		DWORD chunkSize = scast(DWORD, Minimum(size, u64(U32_MAX)));
+		DWORD readBytes = 0;
+		OVERLAPPED overlap = {};
+		overlap.Offset = scast(DWORD, offset);
+		overlap.OffsetHigh = scast(DWORD, offset >> 32);
+		if (!ReadFile(file->handle, at, chunkSize, &readBytes, &overlap)) {
+			file->errCode = GetLastError();
+			return;
+		}
+		if (!readBytes) {
+			file->errCode = ERROR_HANDLE_EOF;
+			return;
+		}
+		at += readBytes;
+		offset += readBytes;
+		size -= readBytes;
+	}
+}
 
-	DWORD readBytes = 0;
-	OVERLAPPED overlap = {};
-	overlap.Offset = offset;
-	if (!ReadFile(file->handle, dst, scast(DWORD, size), &readBytes, &overlap)) {
-		file->errCode = GetLastError();
-		return;
+internal
+void* Win32FileMap(PlatformFileHandle* handle) {
+	Win32FileHandle* file = ptrcast(Win32FileHandle, handle);
+	if (!file || file->handle == INVALID_HANDLE_VALUE || !file->base.size) {
+		return 0;
+	}
+	if (!file->mapped) {
+		file->mapping = CreateFileMappingA(file->handle, 0, PAGE_READONLY, 0, 0, 0);
+		if (!file->mapping) {
+			file->errCode = GetLastError();
+			return 0;
+		}
+		file->mapped = MapViewOfFile(file->mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!file->mapped) {
+			file->errCode = GetLastError();
+			CloseHandle(file->mapping);
+			file->mapping = 0;
+			return 0;
+		}
+	}
+	return file->mapped;
+}
+
+#define WIN32_ASYNC_READ_ENTRIES 128
+struct Win32AsyncRead {
+	OVERLAPPED overlapped;
+	void* userData;
+	Win32AsyncRead* nextFree;
+};
+struct Win32AsyncReads {
+	HANDLE port;
+	Win32AsyncRead reads[WIN32_ASYNC_READ_ENTRIES];
+	Win32AsyncRead* firstFree;
+	u32 inFlightCount;
+};
+static Win32AsyncReads globalAsyncReads = {};
+
+internal
+void Win32InitAsyncReads(Win32AsyncReads& reads) {
+	reads.port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, 0, 0, 1);
+	reads.firstFree = 0;
+	for (u32 readIndex = 0; readIndex < ArrayCount(reads.reads); readIndex++) {
+		Win32AsyncRead* read = reads.reads + readIndex;
+		read->nextFree = reads.firstFree;
+		reads.firstFree = read;
 	}
 }
 
+internal
+bool Win32FileReadAsync(PlatformFileHandle* handle, u64 offset, u32 size, void* dst, void* userData) {
+	Win32FileHandle* file = ptrcast(Win32FileHandle, handle);
+	Win32AsyncReads& reads = globalAsyncReads;
+	if (!reads.port || !reads.firstFree || !file || file->handle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	if (!file->asyncHandle) {
+		HANDLE asyncHandle = ReOpenFile(file->handle, GENERIC_READ, FILE_SHARE_READ, FILE_FLAG_OVERLAPPED);
+		if (asyncHandle == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		if (!CreateIoCompletionPort(asyncHandle, reads.port, 0, 0)) {
+			CloseHandle(asyncHandle);
+			return false;
+		}
+		file->asyncHandle = asyncHandle;
+	}
+	Win32AsyncRead* read = reads.firstFree;
+	reads.firstFree = read->nextFree;
+	read->overlapped = {};
+	read->overlapped.Offset = scast(DWORD, offset);
+	read->overlapped.OffsetHigh = scast(DWORD, offset >> 32);
+	read->userData = userData;
+	// NOTE: Completion is posted to the port even if the read finishes right away
+	if (!ReadFile(file->asyncHandle, dst, scast(DWORD, size), 0, &read->overlapped) &&
+		GetLastError() != ERROR_IO_PENDING) {
+		read->nextFree = reads.firstFree;
+		reads.firstFree = read;
+		return false;
+	}
+	reads.inFlightCount++;
+	return true;
+}
+
+internal
+u32 Win32FileReadAsyncPoll(PlatformFileReadCompletion* completions, u32 maxCount, bool wait) {
+	Win32AsyncReads& reads = globalAsyncReads;
+	if (!reads.port) {
+		return 0;
+	}
+	OVERLAPPED_ENTRY entries[WIN32_ASYNC_READ_ENTRIES];
+	ULONG entryCount = 0;
+	DWORD timeout = wait && reads.inFlightCount ? INFINITE : 0;
+	if (!GetQueuedCompletionStatusEx(reads.port, entries, scast(ULONG, Minimum(maxCount, ArrayCount(entries))), &entryCount, timeout, FALSE)) {
+		return 0;
+	}
+	for (u32 entryIndex = 0; entryIndex < entryCount; entryIndex++) {
+		OVERLAPPED_ENTRY* entry = entries + entryIndex;
+		Win32AsyncRead* read = CONTAINING_RECORD(entry->lpOverlapped, Win32AsyncRead, overlapped);
+		PlatformFileReadCompletion* completion = completions + entryIndex;
+		completion->userData = read->userData;
+		completion->readBytes = entry->dwNumberOfBytesTransferred;
+		completion->failed = read->overlapped.Internal != 0;
+		read->nextFree = reads.firstFree;
+		reads.firstFree = read;
+	}
+	reads.inFlightCount -= entryCount;
+	return entryCount;
+}
+
 internal
 PlatformCommandHandle Win32SystemExecuteCommand(char* cwd, char* command) {
 	STARTUPINFOA startupInfo = {};
@@ -915,8 +1032,8 @@ void Win32DebugReplayInput(Win32State& state, ProgramMemory& memory, Controller&
 		return;
 	}
 	if (bytesRead != sizeof(data)) {
-		Win32WaitForQueueCompletion(&globalHighPriorityQueue);
-		Win32WaitForQueueCompletion(&globalLowPriorityQueue);
+		QueueWaitForCompletion(&globalHighPriorityQueue);
+		QueueWaitForCompletion(&globalLowPriorityQueue);
 		CopyMemory(memory.memoryBlock, state.dLoopRecord.stateMemoryBlock, memory.memoryBlockSize);
 		SetFilePointer(state.dLoopRecord.inputFileHandle, 0, 0, FILE_BEGIN);
 		return;
@@ -945,16 +1062,17 @@ ScreenDimension GetWindowDimension(HWND window) {
 
 internal
 void Win32ResizeBitmapMemory(BitmapData& bitmap, int newWidth, int newHeight) {
+	// NOTE: Tiled software renderer works on 8 pixels wide lanes, rows are padded to full lanes
 	bitmap.width = newWidth;
 	bitmap.height = newHeight;
-	bitmap.pitch = BITMAP_BYTES_PER_PIXEL * bitmap.width;
+	bitmap.pitch = BITMAP_BYTES_PER_PIXEL * AlignUp8(bitmap.width);
 
 	if (bitmap.data) {
 		VirtualFree(bitmap.data, 0, MEM_RELEASE);
 	}
 
 	globalBitmapInfo.bmiHeader.biSize = sizeof(globalBitmapInfo.bmiHeader);
-	globalBitmapInfo.bmiHeader.biWidth = bitmap.width;
+	globalBitmapInfo.bmiHeader.biWidth = bitmap.pitch / BITMAP_BYTES_PER_PIXEL;
 	globalBitmapInfo.bmiHeader.biHeight = static_cast<int>(bitmap.height);
 	globalBitmapInfo.bmiHeader.biPlanes = 1;
 	globalBitmapInfo.bmiHeader.biBitCount = 32;
@@ -1008,7 +1126,8 @@ void Win32RenderCommands(RenderCommandBuffer* renderCommands, BitmapData& bitmap
 		renderCommands->sortBufferCount = renderCommands->pushBufferCount;
 		renderCommands->sortTempBuffer = ptrcast(SortElement, Win32AllocateMemory(sizeof(SortElement) * renderCommands->sortBufferCount));
 	}
-	SortRenderCommands(renderCommands);
+	SortRenderCommands(renderCommands, queue);
+	RecordRenderBatchStats(renderCommands);
 
 	u32 displayOffsetX = state.bltOffsetX;
 	u32 displayOffsetY = state.bltOffsetY;
@@ -1230,8 +1349,8 @@ void Win32ProcessOSMessages(Win32State& state, ProgramMemory& memory, Controller
 			}
 			else if (vkCode == 'L') {
 				if (!wasDown) {
-					Win32WaitForQueueCompletion(&globalHighPriorityQueue);
-					Win32WaitForQueueCompletion(&globalLowPriorityQueue);
+					QueueWaitForCompletion(&globalHighPriorityQueue);
+					QueueWaitForCompletion(&globalLowPriorityQueue);
 					if (state.dLoopRecord.recording == 0) {
 						if (state.dLoopRecord.replaying) {
 							Win32DebugEndReplayingInput(state);
@@ -1248,8 +1367,8 @@ void Win32ProcessOSMessages(Win32State& state, ProgramMemory& memory, Controller
 			}
 			else if (vkCode == 'P') {
 				controller = {};
-				Win32WaitForQueueCompletion(&globalHighPriorityQueue);
-				Win32WaitForQueueCompletion(&globalLowPriorityQueue);
+				QueueWaitForCompletion(&globalHighPriorityQueue);
+				QueueWaitForCompletion(&globalLowPriorityQueue);
 				if (state.dLoopRecord.replaying) {
 					Win32DebugEndReplayingInput(state);
 				}
@@ -1345,16 +1464,25 @@ ProgramMemory Win32InitProgramMemory(Win32State& state) {
 		MEM_RESERVE | MEM_COMMIT,
 		PAGE_READWRITE
 	);
-	programMemory.platformAPI.QueuePushTask = Win32PushTask;
-	programMemory.platformAPI.QueueWaitForCompletion = Win32WaitForQueueCompletion;
+	programMemory.platformAPI.QueuePushTask = QueuePushTask;
+	programMemory.platformAPI.QueuePushTaskAfter = QueuePushTaskAfter;
+	programMemory.platformAPI.QueueWaitForCompletion = QueueWaitForCompletion;
+	programMemory.platformAPI.QueueWaitForCounter = QueueWaitForCounter;
+	programMemory.platformAPI.QueueThreadCount = QueueThreadCount;
 	programMemory.platformAPI.FileOpen = Win32FileOpen;
 	programMemory.platformAPI.FileClose = Win32FileClose;
 	programMemory.platformAPI.FileOpenAllWithExtension = Win32FileGetAllWithExtension;
 	programMemory.platformAPI.FileCloseAllInGroup = Win32FileCloseAllInGroup;
 	programMemory.platformAPI.FileErrors = Win32FileErrors;
 	programMemory.platformAPI.FileRead = Win32FileRead;
+	programMemory.platformAPI.FileMap = Win32FileMap;
+	programMemory.platformAPI.FileReadAsync = Win32FileReadAsync;
+	programMemory.platformAPI.FileReadAsyncPoll = Win32FileReadAsyncPoll;
 	programMemory.platformAPI.MemoryAllocate = Win32AllocateMemory;
 	programMemory.platformAPI.MemoryFree = Win32FreeMemory;
+	programMemory.platformAPI.MemoryReserve = Win32ReserveMemory;
+	programMemory.platformAPI.MemoryCommit = Win32CommitMemory;
+	programMemory.platformAPI.MemoryAdvise = Win32AdviseMemory;
 	programMemory.platformAPI.SystemExecuteCommand = Win32SystemExecuteCommand;
 	programMemory.platformAPI.SystemGetCommandState = Win32SystemGetCommandState;
 	programMemory.platformAPI.TextureAllocate = Win32AllocateTexture;
@@ -1363,16 +1491,54 @@ ProgramMemory Win32InitProgramMemory(Win32State& state) {
 
 	programMemory.highPriorityQueue = &globalHighPriorityQueue;
 	programMemory.lowPriorityQueue = &globalLowPriorityQueue;
+	programMemory.assetMemoryConfig.initialSize = state.assetMemorySize;
+	programMemory.assetMemoryConfig.maxSize = state.assetMemoryMaxSize;
+	programMemory.assetMemoryConfig.softWatermark = state.assetSoftWatermark;
+	programMemory.assetMemoryConfig.hardWatermark = state.assetHardWatermark;
+	programMemory.assetMemoryConfig.replacementPolicy = state.assetReplacementPolicy;
+	programMemory.assetMemoryConfig.mapFiles = state.assetMapFiles;
 	return programMemory;
 }
 
+internal
+void Win32ParseCommandLine(Win32State& state, i32 argc, char** argv) {
+	// NOTE: Same asset options as the linux platform layer
+	for (i32 argIndex = 1; argIndex < argc; argIndex++) {
+		const char* arg = argv[argIndex];
+		bool hasValue = argIndex + 1 < argc;
+		if (strcmp(arg, "--asset-memory") == 0 && hasValue) {
+			state.assetMemorySize = MB(u4(atoi(argv[++argIndex])));
+		}
+		else if (strcmp(arg, "--asset-memory-max") == 0 && hasValue) {
+			state.assetMemoryMaxSize = MB(u4(atoi(argv[++argIndex])));
+		}
+		else if (strcmp(arg, "--asset-soft-watermark") == 0 && hasValue) {
+			state.assetSoftWatermark = f4(atof(argv[++argIndex]));
+		}
+		else if (strcmp(arg, "--asset-hard-watermark") == 0 && hasValue) {
+			state.assetHardWatermark = f4(atof(argv[++argIndex]));
+		}
+		else if (strcmp(arg, "--asset-policy") == 0 && hasValue) {
+			const char* policy = argv[++argIndex];
+			state.assetReplacementPolicy = strcmp(policy, "clock") == 0 ? AssetReplacement_Clock : AssetReplacement_Adaptive;
+		}
+		else if (strcmp(arg, "--asset-map") == 0) {
+			state.assetMapFiles = true;
+		}
+		else {
+			OutputDebugStringA("Usage: [--asset-memory MB] [--asset-memory-max MB] [--asset-soft-watermark F] "
+				"[--asset-hard-watermark F] [--asset-policy adaptive|clock] [--asset-map]\n");
+		}
+	}
+}
+
 ThreadProcArgs CreateThreadProcArgs(PlatformQueue* queue, HDC dc, HGLRC sharedContext) {
 	if (wglCreateContextAttribsARB) {
 		HGLRC glContext = wglCreateContextAttribsARB(dc, sharedContext, globalOpenGLContextAttribs);
-		return { queue, dc, glContext };
+		return { queue, 0, dc, glContext };
 	}
 	else {
-		return { queue, 0, 0 };
+		return { queue, 0, 0, 0 };
 	}
 }
 
@@ -1422,34 +1588,40 @@ int CALLBACK WinMain(
 		return -1;
 	}
 	HGLRC glContext = Win32InitOpenGL(window);
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	u32 processorCount = u4(systemInfo.dwNumberOfProcessors);
 	{
-		constexpr u32 threadCount = 8;
-		ThreadProcArgs threadArgs[threadCount] = {};
-		for (u32 thread = 0; thread < ArrayCount(threadArgs); thread++) {
+		u32 threadCount = QueueHighPriorityWorkerCount(processorCount);
+		local_persist ThreadProcArgs threadArgs[PLATFORM_QUEUE_MAX_WORKERS] = {};
+		for (u32 thread = 0; thread < threadCount; thread++) {
 			threadArgs[thread] = CreateThreadProcArgs(&globalHighPriorityQueue, 0, 0);
 		}
-		InitializeQueue(threadArgs, ArrayCount(threadArgs));
+		InitializeQueue(threadArgs, threadCount);
 	}
 	{
 		HDC dc = GetDC(window);
-		constexpr u32 threadCount = 2;
-		ThreadProcArgs threadArgs[threadCount] = {};
-		for (u32 thread = 0; thread < ArrayCount(threadArgs); thread++) {
+		u32 threadCount = QueueLowPriorityWorkerCount(processorCount);
+		local_persist ThreadProcArgs threadArgs[PLATFORM_QUEUE_MAX_WORKERS] = {};
+		for (u32 thread = 0; thread < threadCount; thread++) {
 			threadArgs[thread] = CreateThreadProcArgs(&globalLowPriorityQueue, dc, glContext);
 		}
-		InitializeQueue(threadArgs, ArrayCount(threadArgs));
+		InitializeQueue(threadArgs, threadCount);
 	}
 
 	RECT rect;
 	GetClientRect(window, &rect);
 	MoveWindow(window, rect.left, rect.top, 1024, 600, true);
 
+	Win32InitAsyncReads(globalAsyncReads);
+	Win32ParseCommandLine(globalWin32State, __argc, __argv);
 	ProgramMemory programMemory = Win32InitProgramMemory(globalWin32State);
 	if (!programMemory.memoryBlock) {
 		// TODO: Logging
 		return 0;
 	}
 	Platform = &programMemory.platformAPI;
+	InitializeSoftwareRenderer(GetCpuSimdLevel());
 
 	//TODO: Concept of view to be able to dynamically change the resolution like a pro
 	Win32GameCode gameCode = {};